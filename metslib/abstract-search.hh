@@ -46,6 +46,14 @@ namespace mets {
     best_cost() const = 0;
   };
 
+  /// @brief The outcome of abstract_search::run().
+  enum search_status {
+    /// @brief The termination criteria stopped the search
+    SEARCH_TERMINATED,
+    /// @brief No admissible move was left
+    SEARCH_NO_MOVES
+  };
+
   /// @brief An abstract search.
   ///
   /// @see mets::tabu_search, mets::simulated_annealing, mets::local_search
@@ -106,8 +114,17 @@ namespace mets {
     /// An exception mets::no_moves_error can be risen when no move is
     /// possible.
     virtual void
-    search() 
-      throw(no_moves_error) = 0;
+    search() = 0;
+
+    /// @brief Like search() but returns SEARCH_NO_MOVES instead of
+    /// throwing a mets::no_moves_error.
+    ///
+    /// Searches that can run out of moves override this (and
+    /// implement search() on top of it) so that no exception is
+    /// thrown on the normal path.
+    virtual search_status
+    run()
+    { search(); return SEARCH_TERMINATED; }
 
     /// @brief The solution recorder instance.
     const solution_recorder&
@@ -208,6 +225,190 @@ namespace mets {
     evaluable_solution& best_ever_m;
   };
     
+  /// @brief A solution recorder for mets::permutation_problem that
+  /// avoids copying the whole solution at each improvement.
+  ///
+  /// The recorder attaches itself as the mets::swap_journal of the
+  /// working solution and logs the swaps applied since the last
+  /// materialised best solution: an improvement only records its
+  /// position in the log. The best solution is materialised
+  /// (replaying the logged swaps, without evaluating them) only when
+  /// requested with best_seen() or when the log grows longer than the
+  /// given limit.
+  ///
+  /// If the working solution is changed by other means (copy_from(),
+  /// update_cost(), ...) the best solution is materialised at once
+  /// and the next improvement is recorded with a full copy. The same
+  /// happens at the first improvement after a long stagnation.
+  ///
+  /// The problem must be fully described by its permutation (i.e. the
+  /// subclass must not keep other state updated by apply_swap).
+  class lazy_best_solution : public solution_recorder, 
+			     public swap_journal
+  {
+  public:
+    /// @brief Ctor.
+    ///
+    /// @param working The working solution of the search (must be
+    /// the solution passed to accept()).
+    /// @param best The instance used to store the best solution
+    /// (initialized with a copy of working).
+    /// @param max_log Longest log of swaps (0 means the size of the
+    /// problem, when replaying is as expensive as copying).
+    lazy_best_solution(permutation_problem& working, 
+		       permutation_problem& best,
+		       size_t max_log = 0);
+
+    /// @brief Unimplemented copy ctor.
+    lazy_best_solution(const lazy_best_solution&);
+    /// @brief Unimplemented assignment operator.
+    lazy_best_solution& operator=(const lazy_best_solution&);
+
+    /// @brief Detaches from the working solution.
+    ~lazy_best_solution()
+    { working_m.journal(0); }
+
+    bool 
+    accept(const feasible_solution& sol);
+
+    /// @brief Returns the best solution found since the beginning
+    /// (materialising it).
+    const permutation_problem& 
+    best_seen() const
+    { materialise(); return best_m; }
+
+    gol_type 
+    best_cost() const 
+    { return best_cost_m; }
+
+    /// @brief Number of full copies made so far.
+    unsigned int
+    copies() const
+    { return copies_m; }
+
+    void
+    record(int i, int j)
+    { if(tracking_m) log_m.push_back(std::make_pair(i, j)); }
+
+    void
+    invalidate()
+    { materialise(); tracking_m = false; log_m.clear(); }
+
+  protected:
+    permutation_problem& working_m;
+    permutation_problem& best_m;
+    gol_type best_cost_m;
+    size_t max_log_m;
+    /// working is best_m after all the swaps in log_m, the best
+    /// solution after the first mark_m.
+    mutable std::vector<std::pair<int, int> > log_m;
+    mutable size_t mark_m;
+    bool tracking_m;
+    unsigned int copies_m;
+
+    /// @brief Bring best_m up to date.
+    void
+    materialise() const;
+  };
+
+  /// @brief A solution recorder keeping the best distinct
+  /// mets::permutation_problem solutions found, with a measure of
+  /// diversity.
+  ///
+  /// The pool is made of the slots provided with add_slot() (no
+  /// allocation happens during the search). A solution is recorded
+  /// when:
+  ///
+  /// - it is not already in the pool (solutions are compared by
+  ///   fingerprint, and by permutation when the fingerprint matches);
+  /// - the pool is not full, or the solution is better than the worst
+  ///   in the pool;
+  /// - it is not closer than min_distance (Hamming distance) to a
+  ///   better solution in the pool.
+  ///
+  /// When the pool is full the new solution replaces the closest
+  /// worse solution if it is closer than min_distance, the worst one
+  /// otherwise.
+  ///
+  /// If the solutions use a mets::zobrist_table its fingerprint is
+  /// used, otherwise the permutation is hashed.
+  class elite_pool : public solution_recorder
+  {
+  public:
+    /// @brief Ctor.
+    ///
+    /// @param min_distance Solutions closer than this are considered
+    /// too similar.
+    explicit
+    elite_pool(size_t min_distance = 0)
+      : solution_recorder(), slots_m(), costs_m(), fingerprints_m(), 
+	order_m(), size_m(0), min_distance_m(min_distance)
+    { }
+
+    /// @brief Unimplemented copy ctor.
+    elite_pool(const elite_pool&);
+    /// @brief Unimplemented assignment operator.
+    elite_pool& operator=(const elite_pool&);
+
+    /// @brief Adds a slot to the pool.
+    ///
+    /// @param slot An instance of the solution type (will be
+    /// modified, must outlive the pool).
+    void
+    add_slot(permutation_problem& slot);
+
+    /// @brief Record sol if it qualifies for the pool.
+    ///
+    /// @return True if sol is the new best solution.
+    bool 
+    accept(const feasible_solution& sol);
+
+    /// @brief The cost of the best solution in the pool (the maximum
+    /// gol_type if the pool is empty).
+    gol_type 
+    best_cost() const
+    { return size_m ? costs_m[order_m[0]] 
+	: std::numeric_limits<gol_type>::max(); }
+
+    /// @brief The solutions in the pool.
+    size_t
+    size() const
+    { return size_m; }
+
+    /// @brief The number of slots.
+    size_t
+    capacity() const
+    { return slots_m.size(); }
+
+    /// @brief The i-th best solution in the pool.
+    const permutation_problem&
+    operator[](size_t i) const
+    { assert(i < size_m); return *slots_m[order_m[i]]; }
+
+    /// @brief Forget all the solutions.
+    void
+    clear()
+    { size_m = 0; }
+
+    /// @brief A hash of the permutation of sol (its fingerprint if
+    /// any).
+    static size_t
+    hash(const permutation_problem& sol);
+
+  protected:
+    std::vector<permutation_problem*> slots_m;
+    std::vector<gol_type> costs_m;
+    std::vector<size_t> fingerprints_m;
+    /// slots sorted by increasing cost (the first size_m are used)
+    std::vector<size_t> order_m;
+    size_t size_m;
+    size_t min_distance_m;
+
+    /// @brief Copy sol into slot and keep order_m sorted.
+    void
+    store(size_t slot, const permutation_problem& sol, size_t fingerprint);
+  };
+
   /// @brief An object that is called back during the search progress.
   template<typename move_manager_type>
   class search_listener : public observer<abstract_search<move_manager_type> >
@@ -255,7 +456,7 @@ namespace mets {
       if(as->step() == mets::abstract_search<neighborhood_t>::MOVE_MADE)
 	{
 	  os << iteration++ << "\t" 
-	     << dynamic_cast<const mets::evaluable_solution&>(p).cost_function()
+	     << mets::evaluable_cast(p).cost_function()
 	     << "\n";
 	}
     }
@@ -285,8 +486,7 @@ namespace mets {
       if(as->step() == mets::abstract_search<neighborhood_t>::MOVE_MADE)
 	{
 	  iteration_m++;
-	  double val = dynamic_cast<const mets::evaluable_solution&>(p)
-	    .cost_function();
+	  double val = mets::evaluable_cast(p).cost_function();
 	  if(val < best_m - epsilon_m) 
 	    {	     
 	      best_m = val;
@@ -315,7 +515,7 @@ inline mets::solution_recorder::~solution_recorder()
 inline bool
 mets::best_ever_solution::accept(const mets::feasible_solution& sol)
 {
-  const evaluable_solution& s = dynamic_cast<const mets::evaluable_solution&>(sol);
+  const evaluable_solution& s = evaluable_cast(sol);
   if(s.cost_function() < best_ever_m.cost_function())
     {
       best_ever_m.copy_from(s);
@@ -324,4 +524,163 @@ mets::best_ever_solution::accept(const mets::feasible_solution& sol)
   return false;
 }
 
+inline
+mets::lazy_best_solution::lazy_best_solution(permutation_problem& working,
+					     permutation_problem& best,
+					     size_t max_log)
+  : solution_recorder(), swap_journal(), working_m(working), best_m(best),
+    best_cost_m(working.cost_function()), 
+    max_log_m(max_log ? max_log : working.size()), log_m(), mark_m(0), 
+    tracking_m(true), copies_m(0)
+{
+  best_m.copy_from(working_m);
+  log_m.reserve(max_log_m + 1);
+  working_m.journal(this);
+}
+
+inline bool
+mets::lazy_best_solution::accept(const mets::feasible_solution& sol)
+{
+  assert(&sol == &working_m);
+  gol_type cost = working_m.cost_function();
+  bool improved = cost < best_cost_m;
+  if(improved)
+    {
+      best_cost_m = cost;
+      if(tracking_m)
+	mark_m = log_m.size();
+      else
+	{
+	  best_m.copy_from(working_m);
+	  ++copies_m;
+	  log_m.clear();
+	  mark_m = 0;
+	  tracking_m = true;
+	}
+    }
+  if(log_m.size() > max_log_m)
+    {
+      materialise();
+      // still too far from the best: stop logging until the next
+      // improvement
+      if(log_m.size() > max_log_m)
+	{
+	  tracking_m = false;
+	  log_m.clear();
+	}
+    }
+  return improved;
+}
+
+inline void
+mets::lazy_best_solution::materialise() const
+{
+  if(!mark_m)
+    return;
+  std::vector<int>& pi = best_m.pi_m;
+  for(size_t ii = 0; ii != mark_m; ++ii)
+    {
+      const std::pair<int, int>& s = log_m[ii];
+      if(best_m.zobrist_m) 
+	best_m.fingerprint_m ^= best_m.swap_key(s.first, s.second);
+      std::swap(pi[s.first], pi[s.second]);
+    }
+  best_m.cost_m = best_cost_m;
+  log_m.erase(log_m.begin(), log_m.begin() + mark_m);
+  mark_m = 0;
+}
+
+inline void
+mets::elite_pool::add_slot(permutation_problem& slot)
+{
+  order_m.insert(order_m.begin() + size_m, slots_m.size());
+  slots_m.push_back(&slot);
+  costs_m.push_back(std::numeric_limits<gol_type>::max());
+  fingerprints_m.push_back(0);
+}
+
+inline size_t
+mets::elite_pool::hash(const permutation_problem& sol)
+{
+  if(sol.fingerprint())
+    return sol.fingerprint();
+  // FNV-1a
+  size_t h = static_cast<size_t>(2166136261UL);
+  const std::vector<int>& pi = sol.permutation();
+  for(std::vector<int>::const_iterator it = pi.begin(); it != pi.end(); ++it)
+    h = (h ^ static_cast<size_t>(*it)) * 16777619UL;
+  return h;
+}
+
+inline bool
+mets::elite_pool::accept(const mets::feasible_solution& s)
+{
+  const permutation_problem& sol = static_cast<const permutation_problem&>(s);
+  const gol_type cost = sol.cost_function();
+  const bool full = (size_m == slots_m.size());
+
+  // cheap rejection first
+  if(slots_m.empty() || (full && cost >= costs_m[order_m[size_m-1]]))
+    return false;
+
+  const size_t fingerprint = hash(sol);
+  for(size_t ii = 0; ii != size_m; ++ii)
+    {
+      size_t slot = order_m[ii];
+      if(fingerprints_m[slot] == fingerprint 
+	 && slots_m[slot]->permutation() == sol.permutation())
+	return false;
+    }
+
+  // distances from the solutions in the pool: reject if too close
+  // to a better one, otherwise remember the closest worse one
+  size_t closest = size_m;
+  size_t closest_distance = std::numeric_limits<size_t>::max();
+  for(size_t ii = 0; ii != size_m; ++ii)
+    {
+      size_t slot = order_m[ii];
+      size_t d = hamming_distance(sol, *slots_m[slot]);
+      if(costs_m[slot] <= cost)
+	{
+	  if(d < min_distance_m)
+	    return false;
+	}
+      else if(d < closest_distance)
+	{
+	  closest = ii;
+	  closest_distance = d;
+	}
+    }
+
+  const bool best = (size_m == 0 || cost < costs_m[order_m[0]]);
+  if(!full)
+    {
+      store(order_m[size_m], sol, fingerprint);
+      ++size_m;
+    }
+  else if(closest_distance < min_distance_m)
+    store(order_m[closest], sol, fingerprint);
+  else
+    store(order_m[size_m-1], sol, fingerprint);
+  return best;
+}
+
+inline void
+mets::elite_pool::store(size_t slot, const permutation_problem& sol,
+			size_t fingerprint)
+{
+  slots_m[slot]->copy_from(sol);
+  costs_m[slot] = sol.cost_function();
+  fingerprints_m[slot] = fingerprint;
+  // move the slot to its place in the order (the pool is small)
+  size_t pos = std::find(order_m.begin(), order_m.end(), slot)
+    - order_m.begin();
+  order_m.erase(order_m.begin() + pos);
+  size_t used = (pos == size_m) ? size_m : size_m - 1;
+  std::vector<size_t>::iterator it = order_m.begin();
+  while(it != order_m.begin() + used && costs_m[*it] <= costs_m[slot])
+    ++it;
+  order_m.insert(it, slot);
+}
+
 #endif
@@ -0,0 +1,271 @@
+// METSlib source file - anytime.hh                              -*- C++ -*-
+//
+// Copyright (C) 2006-2010 Mirko Maischberger <mirko.maischberger@gmail.com>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//   You should have received a copy of the GNU General Public License
+//   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// This program can be distributed, at your option, under the terms of
+// the CPL 1.0 as published by the Open Source Initiative
+// http://www.opensource.org/licenses/cpl1.0.php
+
+#ifndef METS_ANYTIME_HH_
+#define METS_ANYTIME_HH_
+
+#if defined (METSLIB_HAVE_PTHREAD_H)
+#  include <pthread.h>
+#endif
+
+namespace mets {
+
+  /// @defgroup common Common components
+  /// @{
+
+  /// @brief A solution recorder that publishes each improvement to
+  /// other threads while the search is running.
+  ///
+  /// This decorates another recorder (e.g. a mets::best_ever_solution):
+  /// when the decorated recorder accepts a solution, the solution is
+  /// copied in a back buffer owned by the search thread, then the
+  /// back buffer is swapped with the published one and the version is
+  /// incremented.
+  ///
+  /// The search thread never waits: if a consumer is copying the
+  /// published solution the swap is retried on the next accept()
+  /// (that is called at every iteration).
+  ///
+  /// Consumers get the latest solution with latest() or wait for a
+  /// newer one with wait(). Call close() (from the search thread)
+  /// when the search is over: it publishes the last improvement and
+  /// wakes up the waiting consumers.
+  ///
+  /// Without POSIX threads the recorder works, but it is not thread
+  /// safe.
+  class anytime_solution_recorder : public solution_recorder
+  {
+  public:
+    /// @brief Ctor.
+    ///
+    /// @param recorder The decorated recorder.
+    /// @param front, back Two instances of the solution type used as
+    /// buffers (they will be modified).
+    anytime_solution_recorder(solution_recorder& recorder,
+			      copyable& front, copyable& back);
+
+    /// @brief Unimplemented copy ctor.
+    anytime_solution_recorder(const anytime_solution_recorder&);
+    /// @brief Unimplemented assignment operator.
+    anytime_solution_recorder& operator=(const anytime_solution_recorder&);
+
+    ~anytime_solution_recorder();
+
+    /// @brief Forwards to the decorated recorder and publishes the
+    /// accepted solutions.
+    bool
+    accept(const feasible_solution& sol);
+
+    gol_type
+    best_cost() const
+    { return recorder_m.best_cost(); }
+
+    /// @brief The search is over: publish the last solution and wake
+    /// up the consumers.
+    void
+    close();
+
+    /// @brief Number of solutions published so far.
+    unsigned long
+    version() const;
+
+    /// @brief Copy the last published solution into out.
+    ///
+    /// @return The version of the copied solution (0 if nothing was
+    /// published yet and out is untouched).
+    unsigned long
+    latest(copyable& out) const;
+
+    /// @brief Wait for a solution newer than seen (or for close()) and
+    /// copy the last published solution into out.
+    ///
+    /// @return The version of the copied solution: if it is equal to
+    /// seen the recorder was closed and nothing newer will come.
+    unsigned long
+    wait(unsigned long seen, copyable& out) const;
+
+    /// @brief True after close().
+    bool
+    closed() const;
+
+  protected:
+    solution_recorder& recorder_m;
+    copyable* front_m;
+    copyable* back_m;
+    unsigned long version_m;
+    bool pending_m;
+    bool closed_m;
+#if defined (METSLIB_HAVE_PTHREAD_H)
+    mutable pthread_mutex_t mutex_m;
+    mutable pthread_cond_t cond_m;
+#endif
+
+    /// @brief Swap the buffers if no consumer is reading.
+    void
+    publish(bool block);
+  };
+
+  /// @}
+}
+
+//________________________________________________________________________
+inline
+mets::anytime_solution_recorder::anytime_solution_recorder
+(solution_recorder& recorder, copyable& front, copyable& back)
+  : solution_recorder(), recorder_m(recorder), front_m(&front),
+    back_m(&back), version_m(0), pending_m(false), closed_m(false)
+#if defined (METSLIB_HAVE_PTHREAD_H)
+  , mutex_m(), cond_m()
+#endif
+{
+#if defined (METSLIB_HAVE_PTHREAD_H)
+  pthread_mutex_init(&mutex_m, 0);
+  pthread_cond_init(&cond_m, 0);
+#endif
+}
+
+//________________________________________________________________________
+inline
+mets::anytime_solution_recorder::~anytime_solution_recorder()
+{
+#if defined (METSLIB_HAVE_PTHREAD_H)
+  pthread_cond_destroy(&cond_m);
+  pthread_mutex_destroy(&mutex_m);
+#endif
+}
+
+//________________________________________________________________________
+inline bool
+mets::anytime_solution_recorder::accept(const feasible_solution& sol)
+{
+  bool improved = recorder_m.accept(sol);
+  if(improved)
+    {
+      // the back buffer belongs to this thread
+      back_m->copy_from(evaluable_cast(sol));
+      pending_m = true;
+    }
+  if(pending_m)
+    publish(false);
+  return improved;
+}
+
+//________________________________________________________________________
+inline void
+mets::anytime_solution_recorder::close()
+{
+  if(pending_m)
+    publish(true);
+#if defined (METSLIB_HAVE_PTHREAD_H)
+  pthread_mutex_lock(&mutex_m);
+  closed_m = true;
+  pthread_cond_broadcast(&cond_m);
+  pthread_mutex_unlock(&mutex_m);
+#else
+  closed_m = true;
+#endif
+}
+
+//________________________________________________________________________
+inline void
+mets::anytime_solution_recorder::publish(bool block)
+{
+#if defined (METSLIB_HAVE_PTHREAD_H)
+  if(block)
+    pthread_mutex_lock(&mutex_m);
+  else if(pthread_mutex_trylock(&mutex_m) != 0)
+    return;
+  std::swap(front_m, back_m);
+  ++version_m;
+  pending_m = false;
+  pthread_cond_broadcast(&cond_m);
+  pthread_mutex_unlock(&mutex_m);
+#else
+  std::swap(front_m, back_m);
+  ++version_m;
+  pending_m = false;
+#endif
+}
+
+//________________________________________________________________________
+inline unsigned long
+mets::anytime_solution_recorder::version() const
+{
+#if defined (METSLIB_HAVE_PTHREAD_H)
+  pthread_mutex_lock(&mutex_m);
+  unsigned long v = version_m;
+  pthread_mutex_unlock(&mutex_m);
+  return v;
+#else
+  return version_m;
+#endif
+}
+
+//________________________________________________________________________
+inline bool
+mets::anytime_solution_recorder::closed() const
+{
+#if defined (METSLIB_HAVE_PTHREAD_H)
+  pthread_mutex_lock(&mutex_m);
+  bool c = closed_m;
+  pthread_mutex_unlock(&mutex_m);
+  return c;
+#else
+  return closed_m;
+#endif
+}
+
+//________________________________________________________________________
+inline unsigned long
+mets::anytime_solution_recorder::latest(copyable& out) const
+{
+#if defined (METSLIB_HAVE_PTHREAD_H)
+  pthread_mutex_lock(&mutex_m);
+#endif
+  unsigned long v = version_m;
+  if(v)
+    out.copy_from(*front_m);
+#if defined (METSLIB_HAVE_PTHREAD_H)
+  pthread_mutex_unlock(&mutex_m);
+#endif
+  return v;
+}
+
+//________________________________________________________________________
+inline unsigned long
+mets::anytime_solution_recorder::wait(unsigned long seen,
+				      copyable& out) const
+{
+#if defined (METSLIB_HAVE_PTHREAD_H)
+  pthread_mutex_lock(&mutex_m);
+  while(version_m <= seen && !closed_m)
+    pthread_cond_wait(&cond_m, &mutex_m);
+#endif
+  unsigned long v = version_m;
+  if(v > seen)
+    out.copy_from(*front_m);
+#if defined (METSLIB_HAVE_PTHREAD_H)
+  pthread_mutex_unlock(&mutex_m);
+#endif
+  return v;
+}
+
+#endif
@@ -0,0 +1,402 @@
+// METSlib source file - checkpoint.hh                           -*- C++ -*-
+//
+// Copyright (C) 2006-2010 Mirko Maischberger <mirko.maischberger@gmail.com>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//   You should have received a copy of the GNU General Public License
+//   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// This program can be distributed, at your option, under the terms of
+// the CPL 1.0 as published by the Open Source Initiative
+// http://www.opensource.org/licenses/cpl1.0.php
+
+#ifndef METS_CHECKPOINT_HH_
+#define METS_CHECKPOINT_HH_
+
+#if defined (METSLIB_HAVE_UNISTD_H) && defined (METSLIB_HAVE_SYS_WAIT_H) && defined (METSLIB_HAVE_FCNTL_H)
+#  include <unistd.h>
+#  include <fcntl.h>
+#  include <sys/types.h>
+#  include <sys/wait.h>
+#  include <cerrno>
+#  define METSLIB_FORKED_CHECKPOINT 1
+#endif
+
+namespace mets {
+
+  /// @defgroup checkpoint Checkpoint and resume
+  /// @{
+
+  /// @brief Makes a random number generator serializable.
+  ///
+  /// The engine is saved as raw bytes: this works with any engine
+  /// without pointers (all the standard and TR1 engines). The
+  /// textual stream representation is not used because some TR1
+  /// implementations (e.g. std::tr1::mt19937 of libstdc++) do not
+  /// store the position in the state buffer.
+  template<typename random_generator>
+  class serializable_generator : public serializable
+  {
+  public:
+    /// @brief Wraps r (that must outlive this object).
+    explicit
+    serializable_generator(random_generator& r)
+      : rng_m(r)
+    { }
+
+    /// purposely not implemented (see Effective C++)
+    serializable_generator(const serializable_generator&);
+    /// purposely not implemented (see Effective C++)
+    serializable_generator& operator=(const serializable_generator&);
+
+    void
+    save(std::ostream& os) const
+    { write_binary(os, rng_m); }
+
+    void
+    load(std::istream& is)
+    { read_binary(is, rng_m); }
+
+  protected:
+    random_generator& rng_m;
+  };
+
+  /// @brief A set of objects saved and restored together.
+  ///
+  /// Add everything that makes up the state of the search (the
+  /// working solution, the best solution, the tabu list, the
+  /// aspiration criteria, the termination criteria, the long term
+  /// memory and the random number generators) and save them all at
+  /// once: restoring the checkpoint on freshly constructed objects
+  /// and calling search() again continues the search exactly where
+  /// it was saved.
+  ///
+  /// Objects are restored in the same order they were added.
+  ///
+  /// The format is binary and not portable between architectures:
+  /// it is meant to resume a search on the same machine (or
+  /// cluster).
+  class checkpoint : public serializable
+  {
+  public:
+    /// @brief An empty checkpoint.
+    checkpoint()
+      : items_m(), writer_m(0), ok_m(true)
+    { }
+
+    /// purposely not implemented (see Effective C++)
+    checkpoint(const checkpoint&);
+    /// purposely not implemented (see Effective C++)
+    checkpoint& operator=(const checkpoint&);
+
+    /// @brief Waits for a pending asynchronous write.
+    ~checkpoint()
+    { wait(); }
+
+    /// @brief Add an object to the checkpoint (the object must outlive
+    /// the checkpoint).
+    void
+    add(serializable& item)
+    { items_m.push_back(&item); }
+
+    /// @brief Number of objects in the checkpoint.
+    size_t
+    size() const
+    { return items_m.size(); }
+
+    /// @brief Save all the objects on the stream.
+    void
+    save(std::ostream& os) const;
+
+    /// @brief Restore all the objects from the stream.
+    ///
+    /// A std::runtime_error is raised if the stream does not contain
+    /// a checkpoint of the same objects.
+    void
+    load(std::istream& is);
+
+    /// @brief Save all the objects on the file at path.
+    ///
+    /// The file is written aside and renamed, so that path always
+    /// contains a complete checkpoint.
+    void
+    write(const std::string& path) const;
+
+    /// @brief Save the objects on the file at path without waiting
+    /// for the file to be written.
+    ///
+    /// The objects are serialized in memory and a forked process
+    /// writes, syncs and renames the file. If the previous write is
+    /// still in progress this write is skipped (the next one will
+    /// be more recent anyway).
+    ///
+    /// Where fork() is not available this is the same as write().
+    ///
+    /// @return False if the write was skipped.
+    bool
+    write_async(const std::string& path);
+
+    /// @brief Restore all the objects from the file at path.
+    void
+    read(const std::string& path);
+
+    /// @brief True while an asynchronous write is in progress.
+    bool
+    pending();
+
+    /// @brief Wait for the asynchronous write in progress (if any).
+    ///
+    /// @return False if an asynchronous write failed since the last
+    /// clear_error().
+    bool
+    wait();
+
+    /// @brief True if an asynchronous write failed since the last
+    /// clear_error() (a finished write is reaped first).
+    ///
+    /// A failure is not forgotten when the next write starts.
+    bool
+    failed()
+    { pending(); return !ok_m; }
+
+    /// @brief Forget the failed asynchronous writes.
+    void
+    clear_error()
+    { ok_m = true; }
+
+  protected:
+    std::vector<serializable*> items_m;
+    long writer_m;
+    bool ok_m;
+
+    enum { magic = 0x4d455453, /* "METS" */ version = 1 };
+  };
+
+  /// @brief Writes a checkpoint every given number of iterations.
+  ///
+  /// Attach this listener to a search to save its state
+  /// periodically.
+  ///
+  /// Before each asynchronous write the writer checks the previous
+  /// ones: a failure is raised as a std::runtime_error, like a
+  /// failed synchronous write. Call checkpoint::wait() after the
+  /// search to check the last write.
+  template<typename move_manager_type>
+  class checkpoint_writer : public search_listener<move_manager_type>
+  {
+  public:
+    typedef abstract_search<move_manager_type> search_type;
+
+    /// @brief Writes ckp on path every "every" iterations.
+    ///
+    /// @param ckp The checkpoint to write.
+    /// @param path The destination file.
+    /// @param every Iterations between writes (0 to never write).
+    /// @param async Use checkpoint::write_async.
+    checkpoint_writer(checkpoint& ckp, const std::string& path,
+		      unsigned int every, bool async = true)
+      : search_listener<move_manager_type>(),
+	checkpoint_m(ckp), path_m(path), every_m(every),
+	iterations_m(0), async_m(async)
+    { }
+
+    void
+    update(search_type* algorithm)
+    {
+      if(algorithm->step() != search_type::ITERATION_END)
+	return;
+      ++iterations_m;
+      if(every_m && iterations_m % every_m == 0)
+	{
+	  if(async_m)
+	    {
+	      if(checkpoint_m.failed())
+		{
+		  checkpoint_m.clear_error();
+		  throw std::runtime_error("Unable to write checkpoint " 
+					   + path_m);
+		}
+	      checkpoint_m.write_async(path_m);
+	    }
+	  else
+	    checkpoint_m.write(path_m);
+	}
+    }
+
+  protected:
+    checkpoint& checkpoint_m;
+    std::string path_m;
+    unsigned int every_m;
+    unsigned int iterations_m;
+    bool async_m;
+  };
+
+  /// @}
+}
+
+//________________________________________________________________________
+inline void
+mets::checkpoint::save(std::ostream& os) const
+{
+  write_binary(os, static_cast<unsigned int>(magic));
+  write_binary(os, static_cast<unsigned int>(version));
+  write_binary(os, items_m.size());
+  // each item is length prefixed, so that a mismatch is detected
+  // where it happens
+  for(std::vector<serializable*>::const_iterator it = items_m.begin();
+      it != items_m.end(); ++it)
+    {
+      std::ostringstream item;
+      (*it)->save(item);
+      write_string(os, item.str());
+    }
+}
+
+//________________________________________________________________________
+inline void
+mets::checkpoint::load(std::istream& is)
+{
+  unsigned int m, v;
+  read_binary(is, m);
+  read_binary(is, v);
+  if(m != static_cast<unsigned int>(magic) 
+     || v != static_cast<unsigned int>(version))
+    throw std::runtime_error("Not a METSlib checkpoint.");
+  size_t count;
+  read_binary(is, count);
+  if(count != items_m.size())
+    throw std::runtime_error("The checkpoint contains different objects.");
+  for(std::vector<serializable*>::iterator it = items_m.begin();
+      it != items_m.end(); ++it)
+    {
+      std::istringstream item(read_string(is));
+      (*it)->load(item);
+      if(item.peek() != std::char_traits<char>::eof())
+	throw std::runtime_error("The checkpoint contains different objects.");
+    }
+}
+
+//________________________________________________________________________
+inline void
+mets::checkpoint::write(const std::string& path) const
+{
+  std::string tmp = path + ".tmp";
+  {
+    std::ofstream os(tmp.c_str(), std::ios::out | std::ios::binary);
+    save(os);
+    os.flush();
+    if(!os)
+      throw std::runtime_error("Unable to write checkpoint " + tmp);
+  }
+  if(std::rename(tmp.c_str(), path.c_str()) != 0)
+    throw std::runtime_error("Unable to write checkpoint " + path);
+}
+
+//________________________________________________________________________
+inline bool
+mets::checkpoint::write_async(const std::string& path)
+{
+#ifdef METSLIB_FORKED_CHECKPOINT
+  if(pending())
+    return false;
+
+  // serialize here: the child only does i/o
+  std::ostringstream os;
+  save(os);
+  const std::string data = os.str();
+  const std::string tmp = path + ".tmp";
+
+  pid_t pid = fork();
+  if(pid < 0)
+    {
+      write(path);
+      return true;
+    }
+  if(pid == 0)
+    {
+      int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+      if(fd < 0)
+	_exit(1);
+      const char* p = data.data();
+      size_t left = data.size();
+      while(left)
+	{
+	  ssize_t n = ::write(fd, p, left);
+	  if(n < 0 && errno == EINTR)
+	    continue;
+	  if(n <= 0)
+	    _exit(1);
+	  p += n;
+	  left -= n;
+	}
+      if(::fsync(fd) != 0 || ::close(fd) != 0
+	 || ::rename(tmp.c_str(), path.c_str()) != 0)
+	_exit(1);
+      _exit(0);
+    }
+  writer_m = pid;
+  return true;
+#else
+  write(path);
+  return true;
+#endif
+}
+
+//________________________________________________________________________
+inline void
+mets::checkpoint::read(const std::string& path)
+{
+  std::ifstream is(path.c_str(), std::ios::in | std::ios::binary);
+  if(!is)
+    throw std::runtime_error("Unable to read checkpoint " + path);
+  load(is);
+}
+
+//________________________________________________________________________
+inline bool
+mets::checkpoint::pending()
+{
+#ifdef METSLIB_FORKED_CHECKPOINT
+  if(!writer_m)
+    return false;
+  int status;
+  pid_t r = waitpid(writer_m, &status, WNOHANG);
+  if(r == 0)
+    return true;
+  ok_m = ok_m 
+    && r == writer_m && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+  writer_m = 0;
+#endif
+  return false;
+}
+
+//________________________________________________________________________
+inline bool
+mets::checkpoint::wait()
+{
+#ifdef METSLIB_FORKED_CHECKPOINT
+  if(writer_m)
+    {
+      int status;
+      pid_t r;
+      do {
+	r = waitpid(writer_m, &status, 0);
+      } while(r < 0 && errno == EINTR);
+      ok_m = ok_m 
+	&& r == writer_m && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+      writer_m = 0;
+    }
+#endif
+  return ok_m;
+}
+
+#endif
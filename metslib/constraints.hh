@@ -0,0 +1,530 @@
+// METSlib source file - constraints.hh                          -*- C++ -*-
+//
+// Copyright (C) 2006-2010 Mirko Maischberger <mirko.maischberger@gmail.com>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//   You should have received a copy of the GNU General Public License
+//   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// This program can be distributed, at your option, under the terms of
+// the CPL 1.0 as published by the Open Source Initiative
+// http://www.opensource.org/licenses/cpl1.0.php
+
+#ifndef METS_CONSTRAINTS_HH_
+#define METS_CONSTRAINTS_HH_
+
+namespace mets {
+
+  /// @defgroup constraints Constraints
+  /// @{
+
+  /// @brief Keeps the violation of a set of constraints up to date.
+  ///
+  /// Each constraint c has an amount a(c) (e.g. the load of a bin
+  /// minus its capacity) and is either of the AT_MOST type (violated
+  /// by max(0, a(c))) or of the EQUAL type (violated by |a(c)|).
+  ///
+  /// The penalty is the multiplier times the sum of the weighted
+  /// violations. The sums are updated in O(1) when an amount
+  /// changes, and the change of the penalty due to a change of some
+  /// amounts can be computed without modifying the tracker: a move
+  /// is evaluated in O(affected constraints).
+  class constraint_tracker : public serializable
+  {
+  public:
+    /// @brief The type of a constraint.
+    enum constraint_type {
+      AT_MOST = 0, ///< a(c) <= 0
+      EQUAL        ///< a(c) == 0
+    };
+
+    /// @brief Changes of the amount of some constraints (each
+    /// constraint must appear at most once).
+    typedef std::vector<std::pair<int, gol_type> > delta_list;
+
+    /// @brief Ctor.
+    ///
+    /// @param constraints The number of constraints (all AT_MOST,
+    /// with weight 1 and amount 0).
+    /// @param tolerance Violations up to this are ignored.
+    explicit
+    constraint_tracker(int constraints, gol_type tolerance = 1e-9)
+      : amounts_m(constraints, 0.0), weights_m(constraints, 1.0),
+	types_m(constraints, AT_MOST), tolerance_m(tolerance),
+	multiplier_m(1.0), weighted_m(0.0), violation_m(0.0), violated_m(0)
+    { }
+
+    /// @brief The number of constraints.
+    int
+    size() const
+    { return amounts_m.size(); }
+
+    /// @brief Change the type of constraint c.
+    void
+    type(int c, constraint_type t)
+    { types_m[c] = t; recompute(); }
+
+    /// @brief The type of constraint c.
+    constraint_type
+    type(int c) const
+    { return types_m[c]; }
+
+    /// @brief Change the weight of constraint c.
+    void
+    weight(int c, gol_type w)
+    { weights_m[c] = w; recompute(); }
+
+    /// @brief The weight of constraint c.
+    gol_type
+    weight(int c) const
+    { return weights_m[c]; }
+
+    /// @brief The multiplier of all the weights.
+    gol_type
+    multiplier() const
+    { return multiplier_m; }
+
+    /// @brief Change the multiplier of all the weights (O(1)).
+    void
+    multiplier(gol_type m)
+    { multiplier_m = m; }
+
+    /// @brief Set the amounts of all the constraints (O(size())).
+    void
+    reset(const gol_type* amounts)
+    { std::copy(amounts, amounts + size(), amounts_m.begin()); recompute(); }
+
+    /// @brief The amount of constraint c.
+    gol_type
+    amount(int c) const
+    { return amounts_m[c]; }
+
+    /// @brief The violation of constraint c.
+    gol_type
+    violation(int c) const
+    { return violation_of(c, amounts_m[c]); }
+
+    /// @brief Add delta to the amount of constraint c (O(1)).
+    void
+    change(int c, gol_type delta);
+
+    /// @brief Apply all the changes in deltas.
+    void
+    change(const delta_list& deltas)
+    {
+      for(delta_list::const_iterator it = deltas.begin();
+	  it != deltas.end(); ++it)
+	change(it->first, it->second);
+    }
+
+    /// @brief The change in penalty if delta was added to the amount
+    /// of constraint c (the tracker is not modified).
+    gol_type
+    penalty_delta(int c, gol_type delta) const
+    {
+      return multiplier_m * weights_m[c]
+	* (violation_of(c, amounts_m[c] + delta) - violation(c));
+    }
+
+    /// @brief The change in penalty if all the changes in deltas were
+    /// applied (the tracker is not modified).
+    gol_type
+    penalty_delta(const delta_list& deltas) const
+    {
+      gol_type d = 0.0;
+      for(delta_list::const_iterator it = deltas.begin();
+	  it != deltas.end(); ++it)
+	d += penalty_delta(it->first, it->second);
+      return d;
+    }
+
+    /// @brief The current penalty.
+    gol_type
+    penalty() const
+    { return multiplier_m * weighted_m; }
+
+    /// @brief The sum of the (unweighted) violations.
+    gol_type
+    violation() const
+    { return violation_m; }
+
+    /// @brief The number of violated constraints.
+    int
+    violated() const
+    { return violated_m; }
+
+    /// @brief True if no constraint is violated.
+    bool
+    feasible() const
+    { return violated_m == 0; }
+
+    /// @brief Save the amounts, the weights and the multiplier.
+    void
+    save(std::ostream& os) const
+    {
+      write_binary(os, amounts_m); write_binary(os, weights_m);
+      write_binary(os, types_m); write_binary(os, multiplier_m);
+    }
+
+    void
+    load(std::istream& is)
+    {
+      read_binary_fixed(is, amounts_m); read_binary_fixed(is, weights_m);
+      read_binary_fixed(is, types_m); read_binary(is, multiplier_m);
+      recompute();
+    }
+
+  protected:
+    std::vector<gol_type> amounts_m;
+    std::vector<gol_type> weights_m;
+    std::vector<constraint_type> types_m;
+    gol_type tolerance_m;
+    gol_type multiplier_m;
+    /// the sum of the weighted violations
+    gol_type weighted_m;
+    gol_type violation_m;
+    int violated_m;
+
+    gol_type
+    violation_of(int c, gol_type amount) const
+    {
+      gol_type v = types_m[c] == EQUAL ? std::fabs(amount)
+	: std::max(amount, gol_type(0.0));
+      return v > tolerance_m ? v : 0.0;
+    }
+
+    /// @brief Recompute the sums from scratch.
+    void
+    recompute();
+  };
+
+  /// @brief A solution with constraints tracked by a
+  /// mets::constraint_tracker.
+  ///
+  /// The cost_function() of the solution is objective() plus the
+  /// penalty of the tracker. The recorders reach this interface
+  /// through feasible_solution::constrained(): override it to return
+  /// this (mets::constrained_assignment_problem does).
+  class constrained_solution
+  {
+  public:
+    virtual
+    ~constrained_solution()
+    { }
+
+    /// @brief The constraints of this solution.
+    virtual const constraint_tracker&
+    constraints() const = 0;
+
+    /// @brief The cost without the penalty.
+    virtual gol_type
+    objective() const = 0;
+
+    /// @brief Change the multiplier of the penalty (and the cost).
+    virtual void
+    penalty_multiplier(gol_type m) = 0;
+  };
+
+  /// @brief An assignment problem with constraints.
+  ///
+  /// Implement compute_objective() and evaluate_objective() as you
+  /// would implement assignment_problem::compute_cost and
+  /// assignment_problem::evaluate_assign for the unconstrained
+  /// problem, compute_amounts() to compute the amounts of all the
+  /// constraints and amount_deltas() to tell which constraints change
+  /// when an item is assigned a new value.
+  ///
+  /// The cost of the solution and of the moves includes the penalty
+  /// of the violated constraints, the tracker is updated after each
+  /// assignment.
+  class constrained_assignment_problem : public assignment_problem,
+					 public constrained_solution
+  {
+  public:
+    /// @brief Ctor.
+    ///
+    /// @param n The number of items.
+    /// @param k The number of values.
+    /// @param constraints The number of constraints (their type and
+    /// weight can be changed with constraints()).
+    constrained_assignment_problem(int n, int k, int constraints)
+      : assignment_problem(n, k), constrained_solution(),
+	tracker_m(constraints), deltas_m(), amounts_m(constraints)
+    { }
+
+    const constrained_solution*
+    constrained() const
+    { return this; }
+
+    /// @brief: The objective of the whole solution.
+    virtual gol_type
+    compute_objective() const = 0;
+
+    /// @brief: The change of the objective if v was assigned to i.
+    virtual gol_type
+    evaluate_objective(int i, int v) const = 0;
+
+    /// @brief: Compute the amounts of all the constraints.
+    virtual void
+    compute_amounts(gol_type* amounts) const = 0;
+
+    /// @brief: Append to deltas the constraints whose amount would
+    /// change if v was assigned to i and the change of their amount.
+    virtual void
+    amount_deltas(int i, int v, constraint_tracker::delta_list& deltas)
+      const = 0;
+
+    /// @brief The objective plus the penalty (computed from scratch).
+    gol_type
+    compute_cost() const;
+
+    /// @brief The change of the objective plus the change of the
+    /// penalty.
+    gol_type
+    evaluate_assign(int i, int v) const
+    {
+      deltas_m.clear();
+      amount_deltas(i, v, deltas_m);
+      return evaluate_objective(i, v) + tracker_m.penalty_delta(deltas_m);
+    }
+
+    /// @brief Rebuild the tracker and update the cost.
+    void
+    update_cost()
+    {
+      if(tracker_m.size())
+	{
+	  compute_amounts(&amounts_m[0]);
+	  tracker_m.reset(&amounts_m[0]);
+	}
+      assignment_problem::update_cost();
+    }
+
+    void
+    copy_from(const copyable& other)
+    {
+      assignment_problem::copy_from(other);
+      tracker_m = static_cast<const constrained_assignment_problem&>
+	(other).tracker_m;
+    }
+
+    void
+    save(std::ostream& os) const
+    { assignment_problem::save(os); tracker_m.save(os); }
+
+    void
+    load(std::istream& is)
+    { assignment_problem::load(is); tracker_m.load(is); }
+
+    const constraint_tracker&
+    constraints() const
+    { return tracker_m; }
+
+    /// @brief The constraints, to change their types and weights
+    /// (call update_cost() after the changes).
+    constraint_tracker&
+    constraints()
+    { return tracker_m; }
+
+    gol_type
+    objective() const
+    { return cost_m - tracker_m.penalty(); }
+
+    void
+    penalty_multiplier(gol_type m)
+    {
+      gol_type objective = this->objective();
+      tracker_m.multiplier(m);
+      cost_m = objective + tracker_m.penalty();
+    }
+
+  protected:
+    constraint_tracker tracker_m;
+    mutable constraint_tracker::delta_list deltas_m;
+    mutable std::vector<gol_type> amounts_m;
+
+    void
+    assigning(int i, int v)
+    {
+      deltas_m.clear();
+      amount_deltas(i, v, deltas_m);
+      tracker_m.change(deltas_m);
+    }
+  };
+
+  /// @brief Strategic oscillation of the penalty multiplier of a
+  /// mets::constrained_solution.
+  ///
+  /// Attach this to a search (see abstract_search::attach) working
+  /// on the solution: after period consecutive moves to feasible
+  /// solutions the multiplier is divided by factor (to explore the
+  /// infeasible region), after period consecutive moves to infeasible
+  /// solutions it is multiplied by factor (to go back to the feasible
+  /// region).
+  template<typename neighborhood_t>
+  class strategic_oscillation : public search_listener<neighborhood_t>
+  {
+  public:
+    /// @brief Ctor.
+    ///
+    /// @param working The working solution of the search.
+    /// @param period Consecutive (in)feasible moves before a change.
+    /// @param factor The change of the multiplier (> 1).
+    /// @param min_multiplier, max_multiplier The multiplier bounds.
+    strategic_oscillation(constrained_solution& working, int period,
+			  gol_type factor = 2.0,
+			  gol_type min_multiplier = 1e-3,
+			  gol_type max_multiplier = 1e3)
+      : search_listener<neighborhood_t>(), working_m(working),
+	period_m(period), factor_m(factor), min_m(min_multiplier),
+	max_m(max_multiplier), feasible_m(0), infeasible_m(0),
+	adjustments_m(0)
+    { }
+
+    void
+    update(abstract_search<neighborhood_t>* as)
+    {
+      if(as->step() != abstract_search<neighborhood_t>::MOVE_MADE)
+	return;
+      if(working_m.constraints().feasible())
+	{ ++feasible_m; infeasible_m = 0; }
+      else
+	{ ++infeasible_m; feasible_m = 0; }
+
+      gol_type m = working_m.constraints().multiplier();
+      if(feasible_m >= period_m && m > min_m)
+	{
+	  working_m.penalty_multiplier(std::max(m / factor_m, min_m));
+	  feasible_m = 0;
+	  ++adjustments_m;
+	}
+      else if(infeasible_m >= period_m && m < max_m)
+	{
+	  working_m.penalty_multiplier(std::min(m * factor_m, max_m));
+	  infeasible_m = 0;
+	  ++adjustments_m;
+	}
+    }
+
+    /// @brief The number of changes of the multiplier.
+    unsigned int
+    adjustments() const
+    { return adjustments_m; }
+
+  protected:
+    constrained_solution& working_m;
+    int period_m;
+    gol_type factor_m;
+    gol_type min_m;
+    gol_type max_m;
+    int feasible_m;
+    int infeasible_m;
+    unsigned int adjustments_m;
+  };
+
+  /// @brief Records the feasible solution with the best objective.
+  ///
+  /// The accepted solutions must be mets::constrained_solution
+  /// instances. Unlike mets::best_ever_solution this is not fooled by
+  /// infeasible solutions with a low penalty, nor by the changes of
+  /// the penalty multiplier.
+  class best_feasible_solution : public solution_recorder
+  {
+  public:
+    /// @brief Ctor.
+    ///
+    /// @param best Where the best solution is copied.
+    explicit
+    best_feasible_solution(evaluable_solution& best)
+      : solution_recorder(), best_m(best),
+	objective_m(std::numeric_limits<gol_type>::max())
+    { }
+
+    bool
+    accept(const feasible_solution& sol)
+    {
+      const constrained_solution* c = sol.constrained();
+      if(!c)
+	throw std::bad_cast();
+      if(!c->constraints().feasible() || c->objective() >= objective_m)
+	return false;
+      best_m.copy_from(evaluable_cast(sol));
+      objective_m = c->objective();
+      return true;
+    }
+
+    /// @brief The best objective of a feasible solution (max if none
+    /// was found).
+    gol_type
+    best_cost() const
+    { return objective_m; }
+
+    /// @brief True if a feasible solution was found.
+    bool
+    found() const
+    { return objective_m != std::numeric_limits<gol_type>::max(); }
+
+    /// @brief The best feasible solution.
+    const evaluable_solution&
+    best_seen() const
+    { return best_m; }
+
+  protected:
+    evaluable_solution& best_m;
+    gol_type objective_m;
+  };
+
+  /// @}
+}
+
+//________________________________________________________________________
+inline void
+mets::constraint_tracker::change(int c, gol_type delta)
+{
+  gol_type before = violation(c);
+  amounts_m[c] += delta;
+  gol_type after = violation(c);
+  weighted_m += weights_m[c] * (after - before);
+  violation_m += after - before;
+  violated_m += (after > 0.0) - (before > 0.0);
+}
+
+//________________________________________________________________________
+inline void
+mets::constraint_tracker::recompute()
+{
+  weighted_m = violation_m = 0.0;
+  violated_m = 0;
+  for(int c = 0; c != size(); ++c)
+    {
+      gol_type v = violation(c);
+      weighted_m += weights_m[c] * v;
+      violation_m += v;
+      violated_m += v > 0.0;
+    }
+}
+
+//________________________________________________________________________
+inline mets::gol_type
+mets::constrained_assignment_problem::compute_cost() const
+{
+  // a tracker from scratch, without touching ours
+  constraint_tracker scratch(tracker_m);
+  if(scratch.size())
+    {
+      compute_amounts(&amounts_m[0]);
+      scratch.reset(&amounts_m[0]);
+    }
+  return compute_objective() + scratch.penalty();
+}
+
+#endif
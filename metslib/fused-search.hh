@@ -0,0 +1,423 @@
+// METSlib source file - fused-search.hh                         -*- C++ -*-
+//
+// Copyright (C) 2006-2010 Mirko Maischberger <mirko.maischberger@gmail.com>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//   You should have received a copy of the GNU General Public License
+//   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// This program can be distributed, at your option, under the terms of
+// the CPL 1.0 as published by the Open Source Initiative
+// http://www.opensource.org/licenses/cpl1.0.php
+
+#ifndef METS_FUSED_SEARCH_HH_
+#define METS_FUSED_SEARCH_HH_
+
+// The vector kernels need double costs, an x86 target and a compiler
+// supporting the target attribute (define METSLIB_NO_SIMD to only
+// build the scalar kernel).
+#if !defined (METSLIB_COST_TYPE) && !defined (METSLIB_NO_SIMD)	\
+  && (defined (__x86_64__) || defined (__i386__))			\
+  && (defined (__clang__) || (defined (__GNUC__) && __GNUC__ >= 5))
+#  define METSLIB_SIMD_DISPATCH 1
+#  include <immintrin.h>
+#endif
+
+namespace mets {
+
+  /// @defgroup fused_search Fused tabu search
+  /// @{
+
+  /// @brief The instruction sets best_admissible() can use.
+  enum simd_level {
+    SIMD_SCALAR = 0,
+    SIMD_AVX2,
+    SIMD_AVX512
+  };
+
+  /// @brief The best instruction set available on this machine.
+  inline simd_level
+  simd_available();
+
+  /// @brief The index of the best admissible move.
+  ///
+  /// Move k is admissible if it is not tabu (expiry[k] <= iteration)
+  /// or if its delta meets the aspiration criteria (deltas[k] <
+  /// threshold). Among the admissible moves the one with the
+  /// smallest delta is chosen, the first one on ties (the same move
+  /// a mets::tabu_search would choose). As in mets::tabu_search a
+  /// move is chosen only if its delta is below
+  /// numeric_limits<gol_type>::max().
+  ///
+  /// @param deltas The delta of each move.
+  /// @param expiry The expiry iteration of each move.
+  /// @param iteration The current iteration.
+  /// @param threshold Tabu moves with a smaller delta are admissible.
+  /// @param count The number of moves.
+  /// @param level The kernel to use (must be available).
+  ///
+  /// @return The index of the move or count if no move is admissible.
+  inline size_t
+  best_admissible(const gol_type* deltas, const unsigned int* expiry,
+		  unsigned int iteration, gol_type threshold, size_t count,
+		  simd_level level = simd_available());
+
+  /// @brief A tabu search on the full swap neighborhood of a
+  /// permutation problem evaluating all the swaps in bulk.
+  ///
+  /// Each iteration computes the deltas of all the swaps with
+  /// swap_soa_neighborhood::evaluate_all() and chooses the move with
+  /// best_admissible() on the deltas and on the expiry vector of the
+  /// mets::swap_tabu_list, instead of calling the evaluate() and
+  /// is_tabu() virtual methods for each move.
+  ///
+  /// The search makes the same moves of a mets::tabu_search using
+  /// the same mets::swap_tabu_list and a mets::best_ever_criteria
+  /// with the same tolerance, as long as the costs are exact (the
+  /// deltas are compared here, the costs after the move there) and
+  /// no move is tabu before the first one (the aspiration criteria
+  /// are not checked until a best cost is known). The lists chained
+  /// to the swap_tabu_list are updated but not consulted and no long
+  /// term memory is supported.
+  class fused_swap_search
+    : public abstract_search<swap_soa_neighborhood>
+  {
+  public:
+    typedef fused_swap_search search_type;
+
+    /// @brief Creates a fused tabu search.
+    ///
+    /// @param working The working solution.
+    /// @param recorder Where the best solution is recorded.
+    /// @param moveman The neighborhood.
+    /// @param tabus The tabu list (its size must be the problem size).
+    /// @param termination The termination criteria.
+    /// @param tolerance Minimum improvement over the best cost for a
+    /// tabu move to be admissible (see mets::best_ever_criteria).
+    fused_swap_search(permutation_problem& working,
+		      solution_recorder& recorder,
+		      swap_soa_neighborhood& moveman,
+		      swap_tabu_list& tabus,
+		      termination_criteria_chain& termination,
+		      gol_type tolerance = 1e-6);
+
+    /// purposely not implemented (see Effective C++)
+    fused_swap_search(const search_type&);
+    /// purposely not implemented (see Effective C++)
+    search_type& operator=(const search_type&);
+
+    /// @brief Starts the search, mets::no_moves_error is risen when
+    /// all the moves are tabu (see run()).
+    void
+    search();
+
+    /// @brief Starts the search, returns SEARCH_NO_MOVES when all the
+    /// moves are tabu and fallback_to_tabu_moves() was not set.
+    search_status
+    run();
+
+    /// @brief When all the moves are tabu make the best tabu move
+    /// (see tabu_search::fallback_to_tabu_moves()).
+    void
+    fallback_to_tabu_moves(bool fallback)
+    { fallback_m = fallback; }
+
+    /// @brief Use a specific kernel (capped to simd_available()).
+    void
+    simd(simd_level level)
+    { level_m = std::min(level, simd_available()); }
+
+    /// @brief The kernel in use.
+    simd_level
+    simd() const
+    { return level_m; }
+
+    /// @brief The best cost found so far.
+    gol_type
+    best_cost() const
+    { return best_m; }
+
+    enum {
+      ASPIRATION_CRITERIA_MET = abstract_search<swap_soa_neighborhood>::LAST,
+      /// @brief All the moves were tabu, the best one will be made
+      TABU_MOVE_FORCED,
+      LAST
+    };
+
+  protected:
+    permutation_problem& problem_m;
+    swap_tabu_list& tabu_list_m;
+    termination_criteria_chain& termination_criteria_m;
+    gol_type tolerance_m;
+    gol_type best_m;
+    simd_level level_m;
+    bool fallback_m;
+  };
+
+  /// @}
+
+  namespace detail {
+
+    inline size_t
+    best_admissible_scalar(const gol_type* d, const unsigned int* e,
+			   unsigned int iteration, gol_type threshold,
+			   size_t begin, size_t count,
+			   gol_type& best, size_t& index)
+    {
+      for(size_t k = begin; k < count; ++k)
+	{
+	  if(e[k] > iteration && !(d[k] < threshold))
+	    continue;
+	  if(d[k] < best)
+	    {
+	      best = d[k];
+	      index = k;
+	    }
+	}
+      return index;
+    }
+
+#if defined (METSLIB_SIMD_DISPATCH)
+
+    // reduces the lanes keeping the first index on ties (lanes
+    // still at max() never found an admissible move)
+    inline void
+    reduce_lanes(const double* value, const double* index, int lanes,
+		 gol_type& best, size_t& where)
+    {
+      for(int l = 0; l != lanes; ++l)
+	{
+	  size_t i = static_cast<size_t>(index[l]);
+	  if(value[l] < best 
+	     || (value[l] == best && i < where 
+		 && value[l] < std::numeric_limits<double>::max()))
+	    {
+	      best = value[l];
+	      where = i;
+	    }
+	}
+    }
+
+    __attribute__((target("avx2"))) inline size_t
+    best_admissible_avx2(const gol_type* d, const unsigned int* e,
+			 unsigned int iteration, gol_type threshold,
+			 size_t count)
+    {
+      const double none = std::numeric_limits<double>::max();
+      const __m128i sign = _mm_set1_epi32(0x80000000);
+      const __m128i iter = _mm_xor_si128
+	(_mm_set1_epi32(static_cast<int>(iteration)), sign);
+      const __m256d thr = _mm256_set1_pd(threshold);
+      const __m256d vnone = _mm256_set1_pd(none);
+      const __m256d four = _mm256_set1_pd(4.0);
+      __m256d best = vnone;
+      __m256d where = _mm256_setzero_pd();
+      __m256d idx = _mm256_set_pd(3.0, 2.0, 1.0, 0.0);
+      size_t k = 0;
+      for(; k + 4 <= count; k += 4)
+	{
+	  // unsigned compare of the expiries through the sign bit
+	  __m128i ex = _mm_xor_si128
+	    (_mm_loadu_si128(reinterpret_cast<const __m128i*>(e + k)), sign);
+	  __m256d tabu = _mm256_castsi256_pd
+	    (_mm256_cvtepi32_epi64(_mm_cmpgt_epi32(ex, iter)));
+	  __m256d v = _mm256_loadu_pd(d + k);
+	  __m256d asp = _mm256_cmp_pd(v, thr, _CMP_LT_OQ);
+	  v = _mm256_blendv_pd(v, vnone, _mm256_andnot_pd(asp, tabu));
+	  __m256d lt = _mm256_cmp_pd(v, best, _CMP_LT_OQ);
+	  best = _mm256_blendv_pd(best, v, lt);
+	  where = _mm256_blendv_pd(where, idx, lt);
+	  idx = _mm256_add_pd(idx, four);
+	}
+      double value[4], index[4];
+      _mm256_storeu_pd(value, best);
+      _mm256_storeu_pd(index, where);
+      gol_type b = none;
+      size_t w = count;
+      reduce_lanes(value, index, 4, b, w);
+      return best_admissible_scalar(d, e, iteration, threshold,
+				    k, count, b, w);
+    }
+
+    __attribute__((target("avx512f"))) inline size_t
+    best_admissible_avx512(const gol_type* d, const unsigned int* e,
+			   unsigned int iteration, gol_type threshold,
+			   size_t count)
+    {
+      const double none = std::numeric_limits<double>::max();
+      const __m512i iter = _mm512_set1_epi64(iteration);
+      const __m512d thr = _mm512_set1_pd(threshold);
+      const __m512d eight = _mm512_set1_pd(8.0);
+      __m512d best = _mm512_set1_pd(none);
+      __m512d where = _mm512_setzero_pd();
+      __m512d idx = _mm512_set_pd(7.0, 6.0, 5.0, 4.0, 3.0, 2.0, 1.0, 0.0);
+      size_t k = 0;
+      for(; k + 8 <= count; k += 8)
+	{
+	  __m512i ex = _mm512_maskz_cvtepu32_epi64
+	    (0xff, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(e + k)));
+	  __mmask8 tabu = _mm512_cmpgt_epu64_mask(ex, iter);
+	  __m512d v = _mm512_loadu_pd(d + k);
+	  __mmask8 asp = _mm512_cmp_pd_mask(v, thr, _CMP_LT_OQ);
+	  __mmask8 ok = static_cast<__mmask8>(~tabu | asp);
+	  __mmask8 lt = _mm512_mask_cmp_pd_mask(ok, v, best, _CMP_LT_OQ);
+	  best = _mm512_mask_mov_pd(best, lt, v);
+	  where = _mm512_mask_mov_pd(where, lt, idx);
+	  idx = _mm512_add_pd(idx, eight);
+	}
+      double value[8], index[8];
+      _mm512_storeu_pd(value, best);
+      _mm512_storeu_pd(index, where);
+      gol_type b = none;
+      size_t w = count;
+      reduce_lanes(value, index, 8, b, w);
+      return best_admissible_scalar(d, e, iteration, threshold,
+				    k, count, b, w);
+    }
+
+#endif
+
+  }
+
+}
+
+inline mets::simd_level
+mets::simd_available()
+{
+#if defined (METSLIB_SIMD_DISPATCH)
+  __builtin_cpu_init();
+  if(__builtin_cpu_supports("avx512f"))
+    return SIMD_AVX512;
+  if(__builtin_cpu_supports("avx2"))
+    return SIMD_AVX2;
+#endif
+  return SIMD_SCALAR;
+}
+
+inline size_t
+mets::best_admissible(const gol_type* deltas, const unsigned int* expiry,
+		      unsigned int iteration, gol_type threshold,
+		      size_t count, simd_level level)
+{
+#if defined (METSLIB_SIMD_DISPATCH)
+  if(level == SIMD_AVX512)
+    return detail::best_admissible_avx512(deltas, expiry, iteration,
+					  threshold, count);
+  if(level == SIMD_AVX2)
+    return detail::best_admissible_avx2(deltas, expiry, iteration,
+					threshold, count);
+#else
+  (void)level; // only the scalar kernel is available
+#endif
+  gol_type best = std::numeric_limits<gol_type>::max();
+  size_t index = count;
+  return detail::best_admissible_scalar(deltas, expiry, iteration,
+					threshold, 0, count, best, index);
+}
+
+inline
+mets::fused_swap_search::fused_swap_search(permutation_problem& working,
+					   solution_recorder& recorder,
+					   swap_soa_neighborhood& moveman,
+					   swap_tabu_list& tabus,
+					   termination_criteria_chain& termination,
+					   gol_type tolerance)
+  : abstract_search<swap_soa_neighborhood>(working, recorder, moveman),
+    problem_m(working),
+    tabu_list_m(tabus),
+    termination_criteria_m(termination),
+    tolerance_m(tolerance),
+    best_m(std::numeric_limits<gol_type>::max()),
+    level_m(simd_available()),
+    fallback_m(false)
+{ }
+
+inline void
+mets::fused_swap_search::search()
+{
+  if(run() == SEARCH_NO_MOVES)
+    throw no_moves_error();
+}
+
+inline mets::search_status
+mets::fused_swap_search::run()
+{
+  typedef abstract_search<swap_soa_neighborhood> base_t;
+  const size_t count = moves_m.size();
+  while(!termination_criteria_m(working_solution_m))
+    {
+      // call listeners
+      step_m = base_t::ITERATION_BEGIN;
+      this->notify();
+
+      moves_m.evaluate_all(problem_m);
+      if(count == 0)
+	return SEARCH_NO_MOVES;
+
+      const gol_type* deltas = &moves_m.deltas()[0];
+      const unsigned int* expiry = tabu_list_m.expiry();
+      const unsigned int iteration = tabu_list_m.iteration();
+      // a tabu move is admissible if it improves the best cost (no
+      // aspiration before the first move, best_m - cost could
+      // overflow an integer gol_type)
+      gol_type threshold = -std::numeric_limits<gol_type>::max();
+      if(best_m != std::numeric_limits<gol_type>::max())
+	threshold = best_m - tolerance_m - problem_m.cost_function();
+      size_t k = best_admissible(deltas, expiry, iteration, threshold,
+				 count, level_m);
+      if(k == count)
+	{
+	  if(!fallback_m)
+	    return SEARCH_NO_MOVES;
+	  // nothing is tabu after the last possible iteration
+	  k = best_admissible(deltas, expiry,
+			      std::numeric_limits<unsigned int>::max(),
+			      threshold, count, level_m);
+	  if(k == count)
+	    return SEARCH_NO_MOVES;
+	  current_move_m = moves_m.begin() + k;
+	  step_m = TABU_MOVE_FORCED;
+	  this->notify();
+	}
+      else
+	{
+	  current_move_m = moves_m.begin() + k;
+	  if(expiry[k] > iteration)
+	    {
+	      step_m = ASPIRATION_CRITERIA_MET;
+	      this->notify();
+	    }
+	}
+
+      // make move tabu
+      tabu_list_m.tabu(working_solution_m, **current_move_m);
+      (*current_move_m)->apply(working_solution_m);
+
+      // call listeners
+      step_m = base_t::MOVE_MADE;
+      this->notify();
+
+      best_m = std::min(problem_m.cost_function(), best_m);
+      if(solution_recorder_m.accept(working_solution_m))
+	{
+	  step_m = base_t::IMPROVEMENT_MADE;
+	  this->notify();
+	}
+
+      // call listeners
+      step_m = base_t::ITERATION_END;
+      this->notify();
+    }
+  return SEARCH_TERMINATED;
+}
+
+#endif
@@ -67,14 +67,246 @@ namespace mets {
     /// moves.
     ///
     virtual void
-    search()
-      throw(no_moves_error);
+    search();
 
   protected:
     bool short_circuit_m;
     gol_type epsilon_m;
   };
 
+  /// @brief Variable Neighborhood Descent algorithm.
+  ///
+  /// A local search over an ordered list of neighborhoods: the best
+  /// improving move of the current neighborhood is made and the
+  /// search goes back to the first neighborhood; when the current
+  /// neighborhood has no improving move the next one is explored. The
+  /// search ends when no neighborhood has an improving move.
+  ///
+  /// Put the cheap neighborhoods first: the expensive ones will be
+  /// explored only in the local optima of the cheap ones. Sampled
+  /// neighborhoods (e.g. a mets::swap_neighborhood) can be added to
+  /// explore large neighborhoods stochastically.
+  ///
+  /// All neighborhoods must be of the same move_manager_type, the
+  /// default allows to mix any mets::move_manager subclass (e.g.
+  /// mets::swap_full_neighborhood and mets::invert_full_neighborhood).
+  template<typename move_manager_type = mets::move_manager>
+  class variable_neighborhood_descent 
+    : public mets::abstract_search<move_manager_type>
+  {
+  public:
+    typedef variable_neighborhood_descent<move_manager_type> search_type;
+
+    /// @brief Creates a variable neighborhood descent instance
+    ///
+    /// @param working The working solution (this will be modified
+    /// during search) 
+    ///
+    /// @param recorder A solution recorder used to record the best
+    /// solution found
+    ///
+    /// @param first The first (and cheapest) neighborhood, more can
+    /// be appended with add().
+    ///
+    /// @param epsilon The minimum improvement.
+    ///
+    /// @param short_circuit Wether each neighborhood exploration
+    /// should stop on the first improving move or not.
+    variable_neighborhood_descent(evaluable_solution& working,
+				  solution_recorder& recorder,
+				  move_manager_type& first,
+				  gol_type epsilon = 1e-7,
+				  bool short_circuit = false);
+
+    /// purposely not implemented (see Effective C++)
+    variable_neighborhood_descent(const variable_neighborhood_descent&);
+    variable_neighborhood_descent& 
+    operator=(const variable_neighborhood_descent&);
+
+    /// @brief Append a neighborhood to the list.
+    void
+    add(move_manager_type& neighborhood)
+    { neighborhoods_m.push_back(&neighborhood); }
+
+    /// @brief This method starts the descent.
+    virtual void
+    search();
+
+    /// @brief The number of neighborhoods.
+    unsigned int
+    neighborhoods() const
+    { return neighborhoods_m.size(); }
+
+    /// @brief The index of the neighborhood being explored (to be
+    /// used by the observers).
+    unsigned int
+    current_neighborhood() const
+    { return current_m; }
+
+  protected:
+    std::vector<move_manager_type*> neighborhoods_m;
+    unsigned int current_m;
+    bool short_circuit_m;
+    gol_type epsilon_m;
+  };
+
+  /// @brief A perturbation used by the mets::iterated_local_search to
+  /// escape from a local optimum.
+  class abstract_perturbation
+  {
+  public:
+    /// @brief Constructor
+    abstract_perturbation()
+    { }
+
+    /// @brief Virtual destructor
+    virtual
+    ~abstract_perturbation()
+    { }
+
+    /// @brief Perturbate the solution.
+    ///
+    /// @param fs The working solution to perturbate.
+    /// @param strength How much the solution should be perturbated
+    /// (the meaning depends on the implementation).
+    virtual void
+    operator()(feasible_solution& fs, unsigned int strength) = 0;
+  };
+
+  /// @brief Perturbates a mets::permutation_problem with strength
+  /// random swaps.
+  ///
+  /// @see mets::perturbate
+  template<typename random_generator>
+  class swap_perturbation : public abstract_perturbation
+  {
+  public:
+    /// @brief Ctor.
+    ///
+    /// @param rng a random number generator (e.g. an instance of
+    /// std::tr1::minstd_rand0 or std::tr1::mt19936)
+    explicit
+    swap_perturbation(random_generator& rng)
+      : abstract_perturbation(), rng_m(rng)
+    { }
+
+    void
+    operator()(feasible_solution& fs, unsigned int strength)
+    { mets::perturbate(static_cast<permutation_problem&>(fs), strength, rng_m); }
+
+  protected:
+    random_generator& rng_m;
+  };
+
+  /// @brief Iterated Local Search algorithm.
+  ///
+  /// Repeats a mets::local_search from perturbations of the current
+  /// local optimum (the incumbent). After each descent the new local
+  /// optimum is accepted as incumbent or discarded (see accept()).
+  ///
+  /// The strength of the perturbation is adaptive: it is reset to
+  /// the minimum each time the incumbent improves and it is increased
+  /// by one (up to the maximum) otherwise.
+  ///
+  /// The local search, the move manager and the solution instances
+  /// are created once and reused at each round, so that no memory is
+  /// allocated by the restarts. Improvements are notified to the
+  /// observers as IMPROVEMENT_MADE, rounds as ITERATION_BEGIN and
+  /// ITERATION_END.
+  template<typename move_manager_type>
+  class iterated_local_search 
+    : public mets::abstract_search<move_manager_type>
+  {
+  public:
+    typedef iterated_local_search<move_manager_type> search_type;
+
+    /// @brief Creates an iterated local search instance
+    ///
+    /// @param working The working solution (this will be modified
+    /// during search) 
+    ///
+    /// @param incumbent A different solution instance used to store
+    /// the accepted local optimum
+    ///
+    /// @param recorder A solution recorder used to record the best
+    /// solution found
+    ///
+    /// @param moveman A problem specific implementation of the
+    /// move_manager_type concept used to generate the neighborhood.
+    ///
+    /// @param perturbation The perturbation applied to the incumbent
+    /// at the start of each round.
+    ///
+    /// @param termination The termination criteria, checked before
+    /// each round (e.g. a mets::noimprove_termination_criteria stops
+    /// after a number of rounds without improvement).
+    ///
+    /// @param min_strength The minimum perturbation strength.
+    ///
+    /// @param max_strength The maximum perturbation strength.
+    ///
+    /// @param epsilon The minimum improvement.
+    ///
+    /// @param short_circuit Wether the local search should stop on
+    /// the first improving move or not.
+    iterated_local_search(evaluable_solution& working,
+			  evaluable_solution& incumbent,
+			  solution_recorder& recorder,
+			  move_manager_type& moveman,
+			  abstract_perturbation& perturbation,
+			  termination_criteria_chain& termination,
+			  unsigned int min_strength = 1,
+			  unsigned int max_strength = 10,
+			  gol_type epsilon = 1e-7,
+			  bool short_circuit = false);
+
+    /// purposely not implemented (see Effective C++)
+    iterated_local_search(const iterated_local_search&);
+    iterated_local_search& operator=(const iterated_local_search&);
+
+    /// @brief This method starts the iterated local search process.
+    virtual void
+    search();
+
+    /// @brief The acceptance criterion: decides if the local optimum
+    /// just found replaces the incumbent.
+    ///
+    /// The default accepts improvements and sideway moves (within
+    /// epsilon), override to implement a different criterion.
+    ///
+    /// @param candidate The cost of the new local optimum.
+    /// @param incumbent The cost of the incumbent.
+    virtual bool
+    accept(gol_type candidate, gol_type incumbent)
+    { return candidate < incumbent + epsilon_m; }
+
+    /// @brief The current perturbation strength.
+    unsigned int
+    strength() const
+    { return strength_m; }
+
+    /// @brief The number of rounds made.
+    unsigned int
+    rounds() const
+    { return rounds_m; }
+
+    /// @brief The accepted local optimum.
+    const evaluable_solution&
+    incumbent() const
+    { return incumbent_m; }
+
+  protected:
+    evaluable_solution& incumbent_m;
+    abstract_perturbation& perturbation_m;
+    termination_criteria_chain& termination_criteria_m;
+    local_search<move_manager_type> local_search_m;
+    unsigned int min_strength_m;
+    unsigned int max_strength_m;
+    unsigned int strength_m;
+    unsigned int rounds_m;
+    gol_type epsilon_m;
+  };
+
   /// @}
   
 }
@@ -95,7 +327,6 @@ mets::local_search<move_manager_t>::local_search(evaluable_solution& working,
 template<typename move_manager_t>
 void
 mets::local_search<move_manager_t>::search()
-  throw(no_moves_error)
 {
   typedef abstract_search<move_manager_t> base_t;
   typename move_manager_t::iterator best_movit;
@@ -133,4 +364,141 @@ mets::local_search<move_manager_t>::search()
       
     } while(best_movit != base_t::moves_m.end());
 }
+
+template<typename move_manager_t>
+mets::variable_neighborhood_descent<move_manager_t>::
+variable_neighborhood_descent(evaluable_solution& working,
+			      solution_recorder& recorder,
+			      move_manager_t& first,
+			      gol_type epsilon,
+			      bool short_circuit)
+  : abstract_search<move_manager_t>(working, recorder, first),
+    neighborhoods_m(1, &first), current_m(0),
+    short_circuit_m(short_circuit), epsilon_m(epsilon)
+{ }
+
+template<typename move_manager_t>
+void
+mets::variable_neighborhood_descent<move_manager_t>::search()
+{
+  typedef abstract_search<move_manager_t> base_t;
+  evaluable_solution& working = 
+    static_cast<evaluable_solution&>(base_t::working_solution_m);
+
+  base_t::solution_recorder_m.accept(working);
+
+  current_m = 0;
+  while(current_m != neighborhoods_m.size())
+    {
+      move_manager_t& moves = *neighborhoods_m[current_m];
+      moves.refresh(working);
+
+      gol_type best_cost = working.cost_function() - epsilon_m;
+      typename move_manager_t::iterator best_movit = moves.end();
+      for(typename move_manager_t::iterator movit = moves.begin();
+	  movit != moves.end(); ++movit)
+	{
+	  gol_type cost = (*movit)->evaluate(working);
+	  if(cost < best_cost)
+	    {
+	      best_cost = cost;
+	      best_movit = movit;
+	      if(short_circuit_m) break;
+	    }
+	}
+
+      if(best_movit == moves.end())
+	{
+	  // local optimum for this neighborhood: try the next one
+	  ++current_m;
+	  continue;
+	}
+
+      (*best_movit)->apply(working);
+      base_t::current_move_m = best_movit;
+      base_t::step_m = base_t::MOVE_MADE;
+      this->notify();
+      if(base_t::solution_recorder_m.accept(working))
+	{
+	  base_t::step_m = base_t::IMPROVEMENT_MADE;
+	  this->notify();
+	}
+
+      // improvement: back to the first neighborhood
+      current_m = 0;
+    }
+}
+
+template<typename move_manager_t>
+mets::iterated_local_search<move_manager_t>::
+iterated_local_search(evaluable_solution& working,
+		      evaluable_solution& incumbent,
+		      solution_recorder& recorder,
+		      move_manager_t& moveman,
+		      abstract_perturbation& perturbation,
+		      termination_criteria_chain& termination,
+		      unsigned int min_strength,
+		      unsigned int max_strength,
+		      gol_type epsilon,
+		      bool short_circuit)
+  : abstract_search<move_manager_t>(working, recorder, moveman),
+    incumbent_m(incumbent),
+    perturbation_m(perturbation),
+    termination_criteria_m(termination),
+    local_search_m(working, recorder, moveman, epsilon, short_circuit),
+    min_strength_m(min_strength),
+    max_strength_m(std::max(min_strength, max_strength)),
+    strength_m(min_strength),
+    rounds_m(0),
+    epsilon_m(epsilon)
+{ }
+
+template<typename move_manager_t>
+void
+mets::iterated_local_search<move_manager_t>::search()
+{
+  typedef abstract_search<move_manager_t> base_t;
+  evaluable_solution& working = 
+    static_cast<evaluable_solution&>(base_t::working_solution_m);
+
+  // the first local optimum is the incumbent
+  local_search_m.search();
+  incumbent_m.copy_from(working);
+  gol_type best_cost = base_t::solution_recorder_m.best_cost();
+  strength_m = min_strength_m;
+  rounds_m = 0;
+
+  while(!termination_criteria_m(working))
+    {
+      base_t::step_m = base_t::ITERATION_BEGIN;
+      this->notify();
+
+      perturbation_m(working, strength_m);
+      local_search_m.search();
+      ++rounds_m;
+
+      if(base_t::solution_recorder_m.best_cost() < best_cost)
+	{
+	  best_cost = base_t::solution_recorder_m.best_cost();
+	  base_t::step_m = base_t::IMPROVEMENT_MADE;
+	  this->notify();
+	}
+
+      gol_type candidate = working.cost_function();
+      gol_type incumbent = incumbent_m.cost_function();
+      bool improved = candidate < incumbent - epsilon_m;
+      if(accept(candidate, incumbent))
+	incumbent_m.copy_from(working);
+      else
+	working.copy_from(incumbent_m);
+
+      if(improved)
+	strength_m = min_strength_m;
+      else if(strength_m < max_strength_m)
+	++strength_m;
+
+      base_t::step_m = base_t::ITERATION_END;
+      this->notify();
+    }
+}
 #endif
@@ -0,0 +1,795 @@
+// METSlib source file - memetic.hh                              -*- C++ -*-
+//
+// Copyright (C) 2006-2010 Mirko Maischberger <mirko.maischberger@gmail.com>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//   You should have received a copy of the GNU General Public License
+//   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// This program can be distributed, at your option, under the terms of
+// the CPL 1.0 as published by the Open Source Initiative
+// http://www.opensource.org/licenses/cpl1.0.php
+
+#ifndef METS_MEMETIC_HH_
+#define METS_MEMETIC_HH_
+
+#if defined (METSLIB_HAVE_PTHREAD_H)
+#  include <pthread.h>
+#endif
+
+namespace mets {
+
+  /// @defgroup memetic Memetic Algorithm
+  /// @{
+
+  /// @brief Order crossover (OX) of two permutations of [0, n).
+  ///
+  /// The child gets the elements of a between two random cut points
+  /// (in the same positions) and the other elements in the order
+  /// they appear in b, starting after the second cut point.
+  ///
+  /// @param work Scratch memory (resized as needed).
+  template<typename random_generator>
+  void order_crossover(const int* a, const int* b, int* child, int n,
+		       random_generator& rng, std::vector<int>& work);
+
+  /// @brief Partially mapped crossover (PMX) of two permutations of
+  /// [0, n).
+  ///
+  /// The child gets the elements of a between two random cut points
+  /// and the other elements from the same position of b, when
+  /// possible, or following the mapping defined by the segment.
+  ///
+  /// @param work Scratch memory (resized as needed).
+  template<typename random_generator>
+  void pmx_crossover(const int* a, const int* b, int* child, int n,
+		     random_generator& rng, std::vector<int>& work);
+
+  /// @brief Cycle crossover (CX) of two permutations of [0, n).
+  ///
+  /// Each element keeps the position it has in one of the parents:
+  /// the cycles of the two permutations are taken alternatively from
+  /// a and b (the first one, containing position 0, from a).
+  ///
+  /// @param work Scratch memory (resized as needed).
+  void cycle_crossover(const int* a, const int* b, int* child, int n,
+		       std::vector<int>& work);
+
+  /// @brief Improves the children of a mets::memetic_algorithm.
+  ///
+  /// Each worker of the algorithm has its own improver: an
+  /// implementation can keep state (e.g. a move manager) without
+  /// locking.
+  class child_improver
+  {
+  public:
+    child_improver()
+    { }
+
+    /// purposely not implemented (see Effective C++)
+    child_improver(const child_improver&);
+    /// purposely not implemented (see Effective C++)
+    child_improver& operator=(const child_improver&);
+
+    virtual
+    ~child_improver()
+    { }
+
+    /// @brief Improve child (in place).
+    virtual void
+    operator()(permutation_problem& child) = 0;
+  };
+
+  /// @brief Improves the children with a mets::local_search.
+  template<typename move_manager_type>
+  class local_search_improver : public child_improver
+  {
+  public:
+    /// @brief Ctor.
+    ///
+    /// @param moveman The neighborhood used by the local search
+    /// (owned by this improver only).
+    /// @param epsilon The minimum improvement.
+    /// @param short_circuit Stop on the first improving move.
+    local_search_improver(move_manager_type& moveman,
+			  gol_type epsilon = 1e-7,
+			  bool short_circuit = false)
+      : child_improver(), moves_m(moveman), recorder_m(),
+	epsilon_m(epsilon), short_circuit_m(short_circuit)
+    { }
+
+    void
+    operator()(permutation_problem& child)
+    {
+      // a local search leaves child on its best solution
+      local_search<move_manager_type>
+	ls(child, recorder_m, moves_m, epsilon_m, short_circuit_m);
+      ls.search();
+    }
+
+  protected:
+    /// A recorder that does not record anything.
+    struct null_recorder : public solution_recorder
+    {
+      bool accept(const feasible_solution&) { return false; }
+      gol_type best_cost() const
+      { return std::numeric_limits<gol_type>::max(); }
+    };
+
+    move_manager_type& moves_m;
+    null_recorder recorder_m;
+    gol_type epsilon_m;
+    bool short_circuit_m;
+  };
+
+  /// @brief Improves the children with a short mets::tabu_search.
+  ///
+  /// The aspiration and termination criteria are reset before each
+  /// child, the tabu list keeps its content.
+  template<typename move_manager_type>
+  class tabu_search_improver : public child_improver
+  {
+  public:
+    /// @brief Ctor.
+    ///
+    /// @param best An instance of the solution type used to record
+    /// the best solution of each tabu search.
+    /// @param moveman, tabus, aspiration, termination The components
+    /// of the tabu search (owned by this improver only).
+    tabu_search_improver(permutation_problem& best,
+			 move_manager_type& moveman,
+			 tabu_list_chain& tabus,
+			 aspiration_criteria_chain& aspiration,
+			 termination_criteria_chain& termination)
+      : child_improver(), best_m(best), moves_m(moveman), tabus_m(tabus),
+	aspiration_m(aspiration), termination_m(termination)
+    { }
+
+    void
+    operator()(permutation_problem& child)
+    {
+      aspiration_m.reset();
+      termination_m.reset();
+      best_m.copy_from(child);
+      best_ever_solution recorder(best_m);
+      tabu_search<move_manager_type>
+	ts(child, recorder, moves_m, tabus_m, aspiration_m, termination_m);
+      ts.search();
+      child.copy_from(best_m);
+    }
+
+  protected:
+    permutation_problem& best_m;
+    move_manager_type& moves_m;
+    tabu_list_chain& tabus_m;
+    aspiration_criteria_chain& aspiration_m;
+    termination_criteria_chain& termination_m;
+  };
+
+  /// @brief A memetic algorithm (a genetic algorithm whose children
+  /// are improved by a local search) for mets::permutation_problem.
+  ///
+  /// At each generation "offspring" children are created by
+  /// crossover of parents chosen by binary tournament, improved by a
+  /// mets::child_improver and evaluated. The best distinct solutions
+  /// among parents and children form the next population.
+  ///
+  /// The population is stored as a single contiguous matrix of
+  /// permutations (one row per individual) and a vector of costs.
+  ///
+  /// Children are created and improved in parallel by the workers
+  /// registered with add_worker(), each with its own solution
+  /// instance and improver, on a pool of threads that lives as long
+  /// as the search. Child k is always handled by worker k modulo the
+  /// number of workers, with a random generator seeded from the seed,
+  /// the generation and k: the search is reproducible for a given
+  /// set of workers.
+  ///
+  /// After each generation the best individual is copied in the
+  /// solution of the first worker, that is passed to the solution
+  /// recorder and to the termination criteria.
+  ///
+  /// Without POSIX threads all the workers run in the calling thread.
+#if defined (METSLIB_HAVE_UNORDERED_MAP) && !defined (METSLIB_TR1_MIXED_NAMESPACE)
+  template<typename random_generator = std::minstd_rand0>
+#else
+  template<typename random_generator = std::tr1::minstd_rand0>
+#endif
+  class memetic_algorithm
+  {
+  public:
+    /// @brief The available crossovers.
+    enum crossover_type {
+      ORDER_CROSSOVER = 0,
+      PARTIALLY_MAPPED_CROSSOVER,
+      CYCLE_CROSSOVER
+    };
+
+    /// @brief Ctor.
+    ///
+    /// @param recorder Records the best solutions.
+    /// @param termination Checked after each generation.
+    /// @param population The number of individuals.
+    /// @param offspring The number of children per generation.
+    /// @param crossover The crossover operator.
+    /// @param seed The seed of the random generators.
+    memetic_algorithm(solution_recorder& recorder,
+		      termination_criteria_chain& termination,
+		      unsigned int population,
+		      unsigned int offspring,
+		      crossover_type crossover = ORDER_CROSSOVER,
+		      unsigned long seed = 1);
+
+    /// purposely not implemented (see Effective C++)
+    memetic_algorithm(const memetic_algorithm&);
+    /// purposely not implemented (see Effective C++)
+    memetic_algorithm& operator=(const memetic_algorithm&);
+
+    ~memetic_algorithm();
+
+    /// @brief Add a worker.
+    ///
+    /// @param scratch An instance of the solution type, used to
+    /// build the children (will be modified).
+    /// @param improver The improver of the children.
+    void
+    add_worker(permutation_problem& scratch, child_improver& improver);
+
+    /// @brief Creates a random population and evolves it until the
+    /// termination criteria is met.
+    void
+    search();
+
+    /// @brief The number of generations made.
+    unsigned int
+    generation() const
+    { return generation_m; }
+
+    /// @brief The number of individuals.
+    unsigned int
+    population_size() const
+    { return population_m; }
+
+    /// @brief The permutation of the i-th best individual.
+    const int*
+    individual(unsigned int i) const
+    { return &genes_m[order_m[i] * n_m]; }
+
+    /// @brief The cost of the i-th best individual.
+    gol_type
+    cost(unsigned int i) const
+    { return costs_m[order_m[i]]; }
+
+  protected:
+    struct worker
+    {
+      worker(memetic_algorithm* o, permutation_problem* s,
+	     child_improver* i, unsigned int n)
+	: owner(o), scratch(s), improver(i), index(n), work()
+#if defined (METSLIB_HAVE_PTHREAD_H)
+	, thread()
+#endif
+      { }
+
+      /// purposely not implemented (see Effective C++)
+      worker(const worker&);
+      /// purposely not implemented (see Effective C++)
+      worker& operator=(const worker&);
+
+      memetic_algorithm* owner;
+      permutation_problem* scratch;
+      child_improver* improver;
+      unsigned int index;
+      std::vector<int> work;
+#if defined (METSLIB_HAVE_PTHREAD_H)
+      pthread_t thread;
+#endif
+    };
+
+    solution_recorder& recorder_m;
+    termination_criteria_chain& termination_m;
+    unsigned int population_m;
+    unsigned int offspring_m;
+    crossover_type crossover_m;
+    unsigned long seed_m;
+    int n_m;
+    unsigned int generation_m;
+    std::vector<worker*> workers_m;
+    /// parents in the first population_m rows, then children
+    std::vector<int> genes_m;
+    std::vector<gol_type> costs_m;
+    /// parents sorted by cost
+    std::vector<unsigned int> order_m;
+    std::vector<int> next_genes_m;
+    std::vector<gol_type> next_costs_m;
+    std::vector<unsigned int> candidates_m;
+    std::string error_m;
+#if defined (METSLIB_HAVE_PTHREAD_H)
+    pthread_mutex_t mutex_m;
+    pthread_cond_t start_m;
+    pthread_cond_t done_m;
+    unsigned long round_m;
+    unsigned int finished_m;
+    bool quit_m;
+    bool running_m;
+#endif
+    bool initializing_m;
+
+    /// @brief Build, improve and evaluate the children (or the first
+    /// individuals) assigned to w.
+    void
+    work(worker& w);
+
+    /// @brief Run work() on all the workers.
+    void
+    run_workers();
+
+    /// @brief Keep the best distinct individuals among the first
+    /// total rows.
+    void
+    select(unsigned int total);
+
+    /// @brief Copy the best individual in the first worker solution.
+    permutation_problem&
+    best();
+
+    /// @brief The seed of the generator of child k.
+    unsigned long
+    child_seed(unsigned int k) const;
+
+    void start_threads();
+    void stop_threads();
+#if defined (METSLIB_HAVE_PTHREAD_H)
+    static void* thread_main(void* arg);
+#endif
+
+    struct cost_less
+    {
+      cost_less(const std::vector<gol_type>& c) : costs(c) {}
+      bool operator()(unsigned int a, unsigned int b) const
+      { return costs[a] < costs[b] || (costs[a] == costs[b] && a < b); }
+      const std::vector<gol_type>& costs;
+    };
+  };
+
+  /// @}
+}
+
+//________________________________________________________________________
+template<typename random_generator>
+void mets::order_crossover(const int* a, const int* b, int* child, int n,
+			   random_generator& rng, std::vector<int>& work)
+{
+#if defined (METSLIB_HAVE_UNORDERED_MAP) && !defined (METSLIB_TR1_MIXED_NAMESPACE)
+  mets::uniform_int<> int_range;
+#else
+  std::tr1::uniform_int<> int_range;
+#endif
+  int l = int_range(rng, n);
+  int r = int_range(rng, n);
+  if(l > r) std::swap(l, r);
+  work.assign(n, 0);
+  for(int ii = l; ii <= r; ++ii)
+    {
+      child[ii] = a[ii];
+      work[a[ii]] = 1;
+    }
+  int pos = (r + 1) % n;
+  for(int ii = 0; ii != n; ++ii)
+    {
+      int e = b[(r + 1 + ii) % n];
+      if(work[e])
+	continue;
+      child[pos] = e;
+      pos = (pos + 1) % n;
+    }
+}
+
+//________________________________________________________________________
+template<typename random_generator>
+void mets::pmx_crossover(const int* a, const int* b, int* child, int n,
+			 random_generator& rng, std::vector<int>& work)
+{
+#if defined (METSLIB_HAVE_UNORDERED_MAP) && !defined (METSLIB_TR1_MIXED_NAMESPACE)
+  mets::uniform_int<> int_range;
+#else
+  std::tr1::uniform_int<> int_range;
+#endif
+  int l = int_range(rng, n);
+  int r = int_range(rng, n);
+  if(l > r) std::swap(l, r);
+  // work[0..n) position of each element in a, work[n..2n) 1 if the
+  // element is in the segment
+  work.assign(2 * n, 0);
+  int* where = &work[0];
+  int* taken = &work[n];
+  for(int ii = 0; ii != n; ++ii)
+    where[a[ii]] = ii;
+  for(int ii = l; ii <= r; ++ii)
+    {
+      child[ii] = a[ii];
+      taken[a[ii]] = 1;
+    }
+  for(int ii = 0; ii != n; ++ii)
+    {
+      if(ii >= l && ii <= r)
+	continue;
+      // follow the mapping until we leave the segment
+      int e = b[ii];
+      while(taken[e])
+	e = b[where[e]];
+      child[ii] = e;
+    }
+}
+
+//________________________________________________________________________
+inline void
+mets::cycle_crossover(const int* a, const int* b, int* child, int n,
+		      std::vector<int>& work)
+{
+  // work[0..n) position of each element in a
+  work.resize(n);
+  int* where = &work[0];
+  for(int ii = 0; ii != n; ++ii)
+    {
+      where[a[ii]] = ii;
+      child[ii] = -1;
+    }
+  bool from_a = true;
+  for(int start = 0; start != n; ++start)
+    {
+      if(child[start] >= 0)
+	continue;
+      int pos = start;
+      do {
+	child[pos] = from_a ? a[pos] : b[pos];
+	pos = where[b[pos]];
+      } while(pos != start);
+      from_a = !from_a;
+    }
+}
+
+//________________________________________________________________________
+template<typename random_generator>
+mets::memetic_algorithm<random_generator>::
+memetic_algorithm(solution_recorder& recorder,
+		  termination_criteria_chain& termination,
+		  unsigned int population,
+		  unsigned int offspring,
+		  crossover_type crossover,
+		  unsigned long seed)
+  : recorder_m(recorder), termination_m(termination),
+    population_m(std::max(population, 2u)), offspring_m(offspring),
+    crossover_m(crossover), seed_m(seed), n_m(0), generation_m(0),
+    workers_m(), genes_m(), costs_m(), order_m(), next_genes_m(),
+    next_costs_m(), candidates_m(), error_m(),
+#if defined (METSLIB_HAVE_PTHREAD_H)
+    mutex_m(), start_m(), done_m(), round_m(0), finished_m(0),
+    quit_m(false), running_m(false),
+#endif
+    initializing_m(false)
+{
+#if defined (METSLIB_HAVE_PTHREAD_H)
+  pthread_mutex_init(&mutex_m, 0);
+  pthread_cond_init(&start_m, 0);
+  pthread_cond_init(&done_m, 0);
+#endif
+}
+
+//________________________________________________________________________
+template<typename random_generator>
+mets::memetic_algorithm<random_generator>::~memetic_algorithm()
+{
+  stop_threads();
+  for(typename std::vector<worker*>::iterator w = workers_m.begin();
+      w != workers_m.end(); ++w)
+    delete *w;
+#if defined (METSLIB_HAVE_PTHREAD_H)
+  pthread_cond_destroy(&done_m);
+  pthread_cond_destroy(&start_m);
+  pthread_mutex_destroy(&mutex_m);
+#endif
+}
+
+//________________________________________________________________________
+template<typename random_generator>
+void
+mets::memetic_algorithm<random_generator>::
+add_worker(permutation_problem& scratch, child_improver& improver)
+{
+  assert(workers_m.empty()
+	 || static_cast<int>(scratch.size()) == n_m);
+  workers_m.push_back(new worker(this, &scratch, &improver,
+				 workers_m.size()));
+  n_m = scratch.size();
+}
+
+//________________________________________________________________________
+template<typename random_generator>
+unsigned long
+mets::memetic_algorithm<random_generator>::child_seed(unsigned int k) const
+{
+  // mix seed, generation and child (splitmix style) into a valid
+  // seed for any engine (non zero, 31 bits)
+  unsigned long long z = seed_m
+    + 0x9E3779B97F4A7C15ULL * (1 + generation_m *
+			       (unsigned long long)(population_m + offspring_m)
+			       + k);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  z ^= z >> 31;
+  return static_cast<unsigned long>(z % 2147483646ULL) + 1;
+}
+
+//________________________________________________________________________
+template<typename random_generator>
+void
+mets::memetic_algorithm<random_generator>::work(worker& w)
+{
+  permutation_problem& p = *w.scratch;
+  const unsigned int workers = workers_m.size();
+  const unsigned int count = initializing_m ? population_m : offspring_m;
+#if defined (METSLIB_HAVE_UNORDERED_MAP) && !defined (METSLIB_TR1_MIXED_NAMESPACE)
+  mets::uniform_int<> int_range;
+#else
+  std::tr1::uniform_int<> int_range;
+#endif
+  for(unsigned int k = w.index; k < count; k += workers)
+    {
+      random_generator rng(child_seed(k));
+      unsigned int row = initializing_m ? k : population_m + k;
+      if(initializing_m)
+	{
+	  // shuffle the identity: the result does not depend on what
+	  // the worker did before
+	  for(int ii = 0; ii != n_m; ++ii)
+	    p.pi_m[ii] = ii;
+	  random_shuffle(p, rng);
+	}
+      else
+	{
+	  // binary tournaments
+	  unsigned int a = int_range(rng, population_m);
+	  unsigned int b = int_range(rng, population_m);
+	  if(costs_m[b] < costs_m[a]) a = b;
+	  unsigned int c = int_range(rng, population_m);
+	  unsigned int d = int_range(rng, population_m);
+	  if(costs_m[d] < costs_m[c]) c = d;
+	  const int* pa = &genes_m[a * n_m];
+	  const int* pb = &genes_m[c * n_m];
+	  int* child = &p.pi_m[0];
+	  switch(crossover_m)
+	    {
+	    case PARTIALLY_MAPPED_CROSSOVER:
+	      pmx_crossover(pa, pb, child, n_m, rng, w.work);
+	      break;
+	    case CYCLE_CROSSOVER:
+	      cycle_crossover(pa, pb, child, n_m, w.work);
+	      break;
+	    default:
+	      order_crossover(pa, pb, child, n_m, rng, w.work);
+	    }
+	  p.update_cost();
+	}
+      (*w.improver)(p);
+      std::copy(p.pi_m.begin(), p.pi_m.end(), genes_m.begin() + row * n_m);
+      costs_m[row] = p.cost_function();
+    }
+}
+
+//________________________________________________________________________
+#if defined (METSLIB_HAVE_PTHREAD_H)
+template<typename random_generator>
+void*
+mets::memetic_algorithm<random_generator>::thread_main(void* arg)
+{
+  worker& w = *static_cast<worker*>(arg);
+  memetic_algorithm& self = *w.owner;
+  unsigned long seen = 0;
+  for(;;)
+    {
+      pthread_mutex_lock(&self.mutex_m);
+      while(self.round_m == seen && !self.quit_m)
+	pthread_cond_wait(&self.start_m, &self.mutex_m);
+      seen = self.round_m;
+      bool quit = self.quit_m;
+      pthread_mutex_unlock(&self.mutex_m);
+      if(quit)
+	return 0;
+
+      std::string error;
+      try {
+	self.work(w);
+      } catch(std::exception& e) {
+	error = e.what();
+      } catch(...) {
+	error = "Unknown error in a memetic algorithm worker.";
+      }
+
+      pthread_mutex_lock(&self.mutex_m);
+      if(!error.empty())
+	self.error_m = error;
+      if(++self.finished_m == self.workers_m.size())
+	pthread_cond_signal(&self.done_m);
+      pthread_mutex_unlock(&self.mutex_m);
+    }
+}
+#endif
+
+//________________________________________________________________________
+template<typename random_generator>
+void
+mets::memetic_algorithm<random_generator>::start_threads()
+{
+#if defined (METSLIB_HAVE_PTHREAD_H)
+  if(running_m || workers_m.size() < 2)
+    return;
+  quit_m = false;
+  for(unsigned int ii = 0; ii != workers_m.size(); ++ii)
+    if(pthread_create(&workers_m[ii]->thread, 0, thread_main,
+		      workers_m[ii]) != 0)
+      {
+	// join the threads started so far, then give up
+	pthread_mutex_lock(&mutex_m);
+	quit_m = true;
+	pthread_cond_broadcast(&start_m);
+	pthread_mutex_unlock(&mutex_m);
+	for(unsigned int jj = 0; jj != ii; ++jj)
+	  pthread_join(workers_m[jj]->thread, 0);
+	throw std::runtime_error("Unable to start the worker threads.");
+      }
+  running_m = true;
+#endif
+}
+
+//________________________________________________________________________
+template<typename random_generator>
+void
+mets::memetic_algorithm<random_generator>::stop_threads()
+{
+#if defined (METSLIB_HAVE_PTHREAD_H)
+  if(!running_m)
+    return;
+  pthread_mutex_lock(&mutex_m);
+  quit_m = true;
+  pthread_cond_broadcast(&start_m);
+  pthread_mutex_unlock(&mutex_m);
+  for(typename std::vector<worker*>::iterator w = workers_m.begin();
+      w != workers_m.end(); ++w)
+    pthread_join((*w)->thread, 0);
+  running_m = false;
+#endif
+}
+
+//________________________________________________________________________
+template<typename random_generator>
+void
+mets::memetic_algorithm<random_generator>::run_workers()
+{
+#if defined (METSLIB_HAVE_PTHREAD_H)
+  if(running_m)
+    {
+      pthread_mutex_lock(&mutex_m);
+      finished_m = 0;
+      ++round_m;
+      pthread_cond_broadcast(&start_m);
+      while(finished_m != workers_m.size())
+	pthread_cond_wait(&done_m, &mutex_m);
+      std::string error;
+      std::swap(error, error_m);
+      pthread_mutex_unlock(&mutex_m);
+      if(!error.empty())
+	throw std::runtime_error(error);
+      return;
+    }
+#endif
+  for(typename std::vector<worker*>::iterator w = workers_m.begin();
+      w != workers_m.end(); ++w)
+    work(**w);
+}
+
+//________________________________________________________________________
+template<typename random_generator>
+void
+mets::memetic_algorithm<random_generator>::select(unsigned int total)
+{
+  // sort parents and children, keep the best distinct ones
+  candidates_m.resize(total);
+  for(unsigned int ii = 0; ii != total; ++ii)
+    candidates_m[ii] = ii;
+  std::sort(candidates_m.begin(), candidates_m.end(), cost_less(costs_m));
+
+  unsigned int kept = 0;
+  for(unsigned int ii = 0; ii != total && kept != population_m; ++ii)
+    {
+      const int* row = &genes_m[candidates_m[ii] * n_m];
+      bool duplicate = false;
+      for(unsigned int jj = 0; jj != kept && !duplicate; ++jj)
+	duplicate = next_costs_m[jj] == costs_m[candidates_m[ii]]
+	  && std::equal(row, row + n_m, &next_genes_m[jj * n_m]);
+      if(duplicate)
+	continue;
+      std::copy(row, row + n_m, next_genes_m.begin() + kept * n_m);
+      next_costs_m[kept++] = costs_m[candidates_m[ii]];
+    }
+  // not enough distinct individuals: fill with the best ones
+  for(unsigned int ii = 0; kept != population_m; ++ii)
+    {
+      const int* row = &genes_m[candidates_m[ii] * n_m];
+      std::copy(row, row + n_m, next_genes_m.begin() + kept * n_m);
+      next_costs_m[kept++] = costs_m[candidates_m[ii]];
+    }
+
+  // the new parents are sorted: order_m is the identity
+  std::copy(next_genes_m.begin(), next_genes_m.begin() + population_m * n_m,
+	    genes_m.begin());
+  std::copy(next_costs_m.begin(), next_costs_m.begin() + population_m,
+	    costs_m.begin());
+  for(unsigned int ii = 0; ii != population_m; ++ii)
+    order_m[ii] = ii;
+}
+
+//________________________________________________________________________
+template<typename random_generator>
+mets::permutation_problem&
+mets::memetic_algorithm<random_generator>::best()
+{
+  permutation_problem& p = *workers_m[0]->scratch;
+  const int* row = individual(0);
+  std::copy(row, row + n_m, p.pi_m.begin());
+  p.cost_m = cost(0);
+  p.update_fingerprint();
+  if(p.journal_m)
+    p.journal_m->invalidate();
+  return p;
+}
+
+//________________________________________________________________________
+template<typename random_generator>
+void
+mets::memetic_algorithm<random_generator>::search()
+{
+  if(workers_m.empty())
+    throw std::runtime_error("A memetic algorithm needs at least a worker.");
+
+  const unsigned int total = population_m + offspring_m;
+  genes_m.resize(total * n_m);
+  costs_m.resize(total);
+  next_genes_m.resize(total * n_m);
+  next_costs_m.resize(total);
+  order_m.resize(population_m);
+  generation_m = 0;
+
+  start_threads();
+  try {
+    initializing_m = true;
+    run_workers();
+    initializing_m = false;
+    select(population_m);
+    recorder_m.accept(best());
+
+    while(!termination_m(best()))
+      {
+	++generation_m;
+	run_workers();
+	select(total);
+	recorder_m.accept(best());
+      }
+  } catch(...) {
+    initializing_m = false;
+    stop_threads();
+    throw;
+  }
+  stop_threads();
+}
+
+#endif
@@ -57,55 +57,133 @@
 /// - mets::feasible_solution
 ///   - mets::evaluable_solution (use this if you also use mets::best_ever_solution)
 ///   - mets::permutation_problem
+///     - mets::exact_permutation_problem (integer costs)
+///   - mets::assignment_problem
+///     - mets::constrained_assignment_problem (with a mets::constraint_tracker)
+///   - mets::bitvector_problem
+///   - mets::real_vector_problem
 /// - mets::move
 ///   - mets::mana_move (use this if you also use by mets::simple_tabu_list)
-///   - mets::swap_elements
+///     - mets::permutation_move (use this if you also use mets::solution_tabu_list)
+///       - mets::swap_elements
+///       - mets::invert_subsequence
+///     - mets::change_value
+///     - mets::flip_bit
+///     - mets::step_coordinate
 ///
 /// The toolkit of implemented algorithms is made of:
 ///
 /// - mets::move_manager (or a class implementing the same concept)
 ///   - mets::swap_neighborhood
+///   - mets::swap_full_neighborhood
+///     - mets::swap_soa_neighborhood
+///   - mets::swap_lazy_neighborhood (moves generated while iterating)
+///   - mets::invert_full_neighborhood
+///   - mets::change_value_neighborhood
+///   - mets::change_value_full_neighborhood
+///   - mets::flip_full_neighborhood
+///   - mets::coordinate_step_neighborhood
+///   - mets::gaussian_step_neighborhood
+///   - mets::union_neighborhood
 /// - mets::local_search
+/// - mets::variable_neighborhood_descent
+/// - mets::iterated_local_search
+///   - mets::abstract_perturbation
+///     - mets::swap_perturbation
+///   - mets::termination_criteria_chain
 /// - mets::simulated_annealing
 ///   - mets::abstract_cooling_schedule
 ///   - mets::solution_recorder
 ///     - mets::best_ever_solution
+///     - mets::lazy_best_solution
+///     - mets::elite_pool
 ///   - mets::termination_criteria_chain
 ///     - mets::iteration_termination_criteria
 ///     - mets::noimprove_termination_criteria
 ///     - mets::threshold_termination_criteria
+///     - mets::wallclock_termination_criteria
+///     - mets::cputime_termination_criteria
+///     - mets::cancellation_termination_criteria
+/// - mets::path_relinking
+/// - mets::memetic_algorithm
+///   - mets::child_improver
+///     - mets::local_search_improver
+///     - mets::tabu_search_improver
+///   - mets::solution_recorder
+///   - mets::termination_criteria_chain
 /// - mets::tabu_search
 ///   - mets::tabu_list_chain
 ///     - mets::simple_tabu_list
+///     - mets::solution_tabu_list
+///     - mets::assignment_tabu_list
+///     - mets::flip_tabu_list
+///     - mets::swap_tabu_list
 ///   - mets::aspiration_criteria_chain
 ///     - mets::best_ever_criteria
+///   - mets::long_term_memory_chain (optional)
+///     - mets::frequency_memory
+///     - mets::path_relinking_restart
 ///   - mets::solution_recorder
 ///     - mets::best_ever_solution
+///     - mets::lazy_best_solution
+///     - mets::elite_pool
+///     - mets::anytime_solution_recorder
+///     - mets::best_feasible_solution
+///     - mets::pareto_archive (with mets::weighted_sum or mets::chebyshev)
 ///   - mets::termination_criteria_chain
 ///     - mets::iteration_termination_criteria
 ///     - mets::noimprove_termination_criteria
 ///     - mets::threshold_termination_criteria
+///     - mets::wallclock_termination_criteria
+///     - mets::cputime_termination_criteria
+///     - mets::cancellation_termination_criteria
+/// - mets::fused_swap_search (tabu search on permutation problems)
+///   - mets::swap_soa_neighborhood
+///   - mets::swap_tabu_list
+///
+/// The state of a search can be saved and restored with a
+/// mets::checkpoint of mets::serializable objects (see also
+/// mets::serializable_generator and mets::checkpoint_writer).
+///
+/// Multi-objective problems (mets::multi_objective_solution) can be
+/// explored running a search for each of the mets::simplex_weights,
+/// each one recording in its own mets::pareto_archive, and merging
+/// the archives at the end.
 ///
 /// To use the mets::simple_tabu_list you need to derive your moves
 /// from the mets::mana_move base class and implement the pure virtual
 /// methods.
 ///
+/// The library does not need RTTI (it can be compiled with
+/// -fno-rtti): the optional interfaces of the solutions are reached
+/// through mets::feasible_solution accessors and the moves of the
+/// library compare their mets::mana_move::tag() in operator==().
+///
 #ifndef METS_METS_HH_
 #define METS_METS_HH_
 
 #include "metslib_config.hh"
 
 #include <list>
+#include <map>
 #include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
 #include <deque>
 #include <limits>
+#include <new>
 #include <string>
 #include <vector>
 #include <cassert>
 #include <typeinfo>
+#include <fstream>
+#include <sstream>
 #include <iostream>
 #include <stdexcept>
 #include <algorithm>
+#include <iterator>
+#include <numeric>
 #if defined (METSLIB_HAVE_UNORDERED_MAP)
 #  include <unordered_map>
 #  include <random>
@@ -132,6 +210,13 @@
 #include "local-search.hh"
 #include "tabu-search.hh"
 #include "simulated-annealing.hh"
+#include "path-relinking.hh"
+#include "memetic.hh"
+#include "constraints.hh"
+#include "multi-objective.hh"
+#include "fused-search.hh"
+#include "checkpoint.hh"
+#include "anytime.hh"
 
 
 //________________________________________________________________________
@@ -15,5 +15,20 @@
 #  else
 #    define METSLIB_HAVE_TR1_UNORDERED_MAP 1
 #  endif
+#  if defined (__unix__) || defined (__APPLE__)
+#    define METSLIB_HAVE_UNISTD_H 1
+#    define METSLIB_HAVE_SYS_WAIT_H 1
+#    define METSLIB_HAVE_FCNTL_H 1
+#    define METSLIB_HAVE_SYS_TIME_H 1
+#    define METSLIB_HAVE_PTHREAD_H 1
+#  endif
+#  if defined (__linux__)
+#    define METSLIB_HAVE_CLOCK_GETTIME 1
+#  endif
+#endif
+#if __cplusplus >= 201103L
+#  define METSLIB_NOEXCEPT noexcept
+#else
+#  define METSLIB_NOEXCEPT
 #endif
 #endif
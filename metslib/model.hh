@@ -27,9 +27,67 @@ namespace mets {
   /// @brief Type of the objective/cost function.
   ///
   /// You should be able to change this to "int" for your uses
-  /// to improve performance if it suffice, no guarantee.
+  /// to improve performance if it suffice, no guarantee. Define
+  /// METSLIB_COST_TYPE before including mets.hh to change it without
+  /// editing this header: the definition must be the same in every
+  /// translation unit of the program (and of the libraries linked to
+  /// it), otherwise every class using gol_type breaks the one
+  /// definition rule.
   ///
+  /// METSLIB_COST_TYPE cannot be used to mix problems with integer
+  /// and floating point costs in the same program: leave gol_type
+  /// alone and derive the integer ones from
+  /// mets::exact_permutation_problem<cost_type> instead (only
+  /// permutation problems have an exact variant).
+  ///
+#ifdef METSLIB_COST_TYPE
+  typedef METSLIB_COST_TYPE gol_type;
+#else
   typedef double gol_type;
+#endif
+
+#if defined (METSLIB_HAVE_UNORDERED_MAP) && !defined (METSLIB_TR1_MIXED_NAMESPACE)
+  /// @brief std::uniform_int_distribution with the interface of the
+  /// TR1 uniform_int used by the library: (rng, n) draws from [0, n).
+  template<typename int_type = int>
+  class uniform_int : public std::uniform_int_distribution<int_type>
+  {
+  public:
+    typedef std::uniform_int_distribution<int_type> base_type;
+
+    explicit
+    uniform_int(int_type min = 0, int_type max = 9)
+      : base_type(min, max)
+    { }
+
+    template<typename random_generator>
+    int_type
+    operator()(random_generator& rng, int_type n)
+    { return base_type::operator()
+	(rng, typename base_type::param_type(0, n - 1)); }
+  };
+
+  /// @brief The TR1 variate_generator (removed from C++11): binds a
+  /// random engine (or a reference to it) to a distribution.
+  template<typename engine_type, typename distribution_type>
+  class variate_generator
+  {
+  public:
+    typedef typename distribution_type::result_type result_type;
+
+    variate_generator(engine_type e, distribution_type d)
+      : engine_m(e), distribution_m(d)
+    { }
+
+    result_type
+    operator()()
+    { return distribution_m(engine_m); }
+
+  private:
+    engine_type engine_m;
+    distribution_type distribution_m;
+  };
+#endif
 
   /// @brief Exception risen when some algorithm has no more moves to
   /// make.
@@ -89,6 +147,130 @@ namespace mets {
     copy_from(const copyable&) = 0;
   };
 
+  /// @brief An interface for objects whose state can be saved to and
+  /// restored from a binary stream (see mets::checkpoint).
+  ///
+  /// load() must read exactly what save() wrote.
+  class serializable {
+  public:
+    virtual
+    ~serializable() {};
+    virtual void
+    save(std::ostream& os) const = 0;
+    virtual void
+    load(std::istream& is) = 0;
+  };
+
+  /// @brief Write the raw bytes of a value (helper for
+  /// mets::serializable implementations).
+  template<typename Tp>
+  void write_binary(std::ostream& os, const Tp& value)
+  { os.write(reinterpret_cast<const char*>(&value), sizeof(Tp)); }
+
+  /// @brief Write the size and the raw bytes of a vector (helper for
+  /// mets::serializable implementations).
+  template<typename Tp, typename Alloc>
+  void write_binary(std::ostream& os, const std::vector<Tp, Alloc>& values)
+  { 
+    write_binary(os, values.size());
+    if(!values.empty())
+      os.write(reinterpret_cast<const char*>(&values[0]), 
+	       values.size() * sizeof(Tp));
+  }
+
+  /// @brief Read a value written by mets::write_binary.
+  template<typename Tp>
+  void read_binary(std::istream& is, Tp& value)
+  { 
+    is.read(reinterpret_cast<char*>(&value), sizeof(Tp)); 
+    if(!is)
+      throw std::runtime_error("Unexpected end of serialized data.");
+  }
+
+  /// @brief Check that count items of width bytes each can still be
+  /// read from is, before anything is allocated for them.
+  ///
+  /// The remaining length is only known when the stream is seekable
+  /// (the items of a mets::checkpoint always are).
+  inline void check_serialized_length(std::istream& is, size_t count,
+				      size_t width)
+  {
+    if(width && count > std::numeric_limits<size_t>::max() / width)
+      throw std::runtime_error("Corrupted serialized data.");
+    const std::streamoff bytes = static_cast<std::streamoff>(count * width);
+    if(bytes < 0)
+      throw std::runtime_error("Corrupted serialized data.");
+    const std::istream::pos_type here = is.tellg();
+    if(here == std::istream::pos_type(-1))
+      return;
+    is.seekg(0, std::ios::end);
+    const std::istream::pos_type end = is.tellg();
+    is.seekg(here);
+    if(!is || end == std::istream::pos_type(-1))
+      throw std::runtime_error("Unexpected end of serialized data.");
+    if(end - here < bytes)
+      throw std::runtime_error("Unexpected end of serialized data.");
+  }
+
+  /// @brief Read a vector written by mets::write_binary.
+  template<typename Tp, typename Alloc>
+  void read_binary(std::istream& is, std::vector<Tp, Alloc>& values)
+  { 
+    typename std::vector<Tp, Alloc>::size_type size;
+    read_binary(is, size);
+    if(size > values.max_size())
+      throw std::runtime_error("Corrupted serialized data.");
+    check_serialized_length(is, size, sizeof(Tp));
+    values.resize(size);
+    if(size)
+      is.read(reinterpret_cast<char*>(&values[0]), size * sizeof(Tp));
+    if(!is)
+      throw std::runtime_error("Unexpected end of serialized data.");
+  }
+
+  /// @brief Read a vector written by mets::write_binary in place of
+  /// values, that must have been saved with the same size.
+  ///
+  /// Used to restore objects whose size is fixed at construction: a
+  /// std::runtime_error is raised (and values left untouched) if the
+  /// data was saved from an object of a different size.
+  template<typename Tp, typename Alloc>
+  void read_binary_fixed(std::istream& is, std::vector<Tp, Alloc>& values)
+  { 
+    typename std::vector<Tp, Alloc>::size_type size;
+    read_binary(is, size);
+    if(size != values.size())
+      throw std::runtime_error("The serialized data has a different size.");
+    if(size)
+      is.read(reinterpret_cast<char*>(&values[0]), size * sizeof(Tp));
+    if(!is)
+      throw std::runtime_error("Unexpected end of serialized data.");
+  }
+
+  /// @brief Write a length prefixed string (helper for
+  /// mets::serializable implementations).
+  inline void write_string(std::ostream& os, const std::string& value)
+  {
+    write_binary(os, value.size());
+    os.write(value.data(), value.size());
+  }
+
+  /// @brief Read a string written by mets::write_string.
+  inline std::string read_string(std::istream& is)
+  {
+    std::string::size_type size;
+    read_binary(is, size);
+    if(size > std::string().max_size())
+      throw std::runtime_error("Corrupted serialized data.");
+    check_serialized_length(is, size, 1);
+    std::string value(size, '\0');
+    if(size)
+      is.read(&value[0], size);
+    if(!is)
+      throw std::runtime_error("Unexpected end of serialized data.");
+    return value;
+  }
+
   /// @brief An interface for printable objects.
   class printable {
   public:
@@ -118,6 +300,15 @@ namespace mets {
   /// evaluable_solution or from a permutation_problem class,
   /// depending on your problem type.
   ///
+  /// The recorders and the criteria reach the optional interfaces of
+  /// a solution (evaluable_solution, multi_objective_solution,
+  /// constrained_solution) through the accessors of this class, so
+  /// that the library works without RTTI.
+  ///
+  class evaluable_solution;
+  class multi_objective_solution;
+  class constrained_solution;
+
   class feasible_solution
   {
   public:
@@ -126,6 +317,23 @@ namespace mets {
     ~feasible_solution() 
     { }
 
+    /// @brief This solution as an evaluable_solution (0 if it is
+    /// not).
+    virtual const evaluable_solution*
+    evaluable() const
+    { return 0; }
+
+    /// @brief This solution as a multi_objective_solution (0 if it
+    /// is not, override this to use a mets::pareto_archive).
+    virtual const multi_objective_solution*
+    multi_objective() const
+    { return 0; }
+
+    /// @brief This solution as a constrained_solution (0 if it is
+    /// not).
+    virtual const constrained_solution*
+    constrained() const
+    { return 0; }
   };
 
 
@@ -152,6 +360,83 @@ namespace mets {
     ///
     virtual gol_type 
     cost_function() const = 0;
+
+    const evaluable_solution*
+    evaluable() const
+    { return this; }
+  };
+
+  /// @brief The evaluable_solution interface of sol.
+  ///
+  /// Throws std::bad_cast if sol is not an evaluable_solution.
+  inline const evaluable_solution&
+  evaluable_cast(const feasible_solution& sol)
+  {
+    const evaluable_solution* e = sol.evaluable();
+    if(!e)
+      throw std::bad_cast();
+    return *e;
+  }
+
+  /// @brief A table of random keys used to fingerprint permutations.
+  ///
+  /// The Zobrist fingerprint of a permutation is the xor of the keys
+  /// of all its (element, position) assignments, so that the
+  /// fingerprint of a solution can be updated in O(1) after each
+  /// swap.
+  ///
+  /// A single table can be shared by all the solutions of the same
+  /// size.
+  ///
+  /// @see mets::permutation_problem::use_fingerprint
+  class zobrist_table
+  {
+  public:
+    /// @brief Fills the n x n table of keys using rng.
+    ///
+    /// @param n the size of the permutations to fingerprint
+    /// @param rng a random number generator (e.g. an instance of
+    /// std::tr1::mt19937)
+    template<typename random_generator>
+    zobrist_table(int n, random_generator& rng) 
+      : n_m(n), keys_m(n*n, 0)
+    {
+      for(std::vector<size_t>::iterator it = keys_m.begin(); 
+	  it != keys_m.end(); ++it)
+	for(unsigned int ii = 0; ii != sizeof(size_t); ++ii)
+	  *it = (*it << 8) ^ static_cast<size_t>(rng());
+    }
+
+    /// @brief The key of element placed at position.
+    size_t 
+    key(int element, int position) const METSLIB_NOEXCEPT
+    { return keys_m[element*n_m + position]; }
+
+    /// @brief The size of the permutations this table can fingerprint.
+    int 
+    size() const
+    { return n_m; }
+
+  protected:
+    int n_m;
+    std::vector<size_t> keys_m;
+  };
+
+  /// @brief Receives the swaps applied to a
+  /// mets::permutation_problem (see
+  /// mets::permutation_problem::journal).
+  class swap_journal {
+  public:
+    virtual
+    ~swap_journal() {};
+    /// @brief Elements i and j have been swapped by apply_swap().
+    virtual void
+    record(int i, int j) = 0;
+    /// @brief The permutation was changed by other means (copy,
+    /// direct modification followed by update_cost(), load): the
+    /// recorded swaps no longer describe it.
+    virtual void
+    invalidate() = 0;
   };
 
   /// @brief An abstract permutation problem.
@@ -166,7 +451,8 @@ namespace mets {
   /// two items in the list.
   ///
   /// @see mets::swap_elements
-  class permutation_problem: public evaluable_solution 
+  class permutation_problem: public evaluable_solution, 
+			     public serializable
   {
   public:
     
@@ -174,9 +460,29 @@ namespace mets {
     permutation_problem(); 
 
     /// @brief Inizialize pi_m = {0, 1, 2, ..., n-1}.
-    permutation_problem(int n) : pi_m(n), cost_m(0.0)
+    permutation_problem(int n) 
+      : pi_m(n), cost_m(0.0), zobrist_m(0), fingerprint_m(0), journal_m(0)
     { std::generate(pi_m.begin(), pi_m.end(), sequence(0)); }
 
+    /// @brief Copy ctor (the fingerprint table, if any, is shared,
+    /// the journal is not).
+    permutation_problem(const permutation_problem& other)
+      : evaluable_solution(other), pi_m(other.pi_m), cost_m(other.cost_m),
+	zobrist_m(other.zobrist_m), fingerprint_m(other.fingerprint_m),
+	journal_m(0)
+    { }
+
+    /// @brief Assignment operator (the fingerprint table, if any, is
+    /// shared, the journal is not).
+    permutation_problem&
+    operator=(const permutation_problem& other)
+    { 
+      pi_m = other.pi_m; cost_m = other.cost_m;
+      zobrist_m = other.zobrist_m; fingerprint_m = other.fingerprint_m;
+      if(journal_m) journal_m->invalidate();
+      return *this;
+    }
+
     /// @brief Copy from another permutation problem, if you introduce
     /// new member variables remember to override this and to call
     /// permutation_problem::copy_from in the overriding code.
@@ -184,6 +490,23 @@ namespace mets {
     /// @param other the problem to copy from
     void copy_from(const copyable& other);
 
+    /// @brief Save the permutation and its cost, if you introduce
+    /// new member variables that change during the search remember to
+    /// override this (and load) and to call permutation_problem::save
+    /// in the overriding code.
+    void save(std::ostream& os) const
+    { write_binary(os, pi_m); write_binary(os, cost_m); }
+
+    /// @brief Restore the permutation and its cost.
+    ///
+    /// A std::runtime_error is raised if they were saved from a
+    /// problem of a different size.
+    void load(std::istream& is)
+    { 
+      read_binary_fixed(is, pi_m); read_binary(is, cost_m); update_fingerprint(); 
+      if(journal_m) journal_m->invalidate();
+    }
+
     /// @brief: Compute cost of the whole solution.
     ///
     /// You will need to override this one.
@@ -204,12 +527,32 @@ namespace mets {
     virtual gol_type
     evaluate_swap(int i, int j) const = 0;
 
+    /// @brief: Evaluate many swaps at once.
+    ///
+    /// Stores in deltas[k] the value of evaluate_swap(i[k], j[k]) for
+    /// k in [0, count). Override this when the swaps can be evaluated
+    /// more efficiently together (e.g. sharing memory accesses or
+    /// vectorizing), the default implementation simply calls
+    /// evaluate_swap.
+    virtual void
+    evaluate_swaps(const int* i, const int* j, gol_type* deltas, 
+		   size_t count) const
+    {
+      for(size_t k = 0; k != count; ++k)
+	deltas[k] = evaluate_swap(i[k], j[k]);
+    }
+
     /// @brief The size of the problem.
     /// Do not override unless you know what you are doing.
     size_t 
-    size() const
+    size() const METSLIB_NOEXCEPT
     { return pi_m.size(); }
 
+    /// @brief The current permutation.
+    const std::vector<int>&
+    permutation() const METSLIB_NOEXCEPT
+    { return pi_m; }
+
     /// @brief Returns the cost of the current solution. The default
     /// implementation provided returns the protected
     /// mets::permutation_problem::cost_m member variable. Do not
@@ -217,27 +560,205 @@ namespace mets {
     gol_type cost_function() const 
     { return cost_m; }
 
-    /// @brief Updates the cost with the one computed by the subclass.
+    /// @brief Updates the cost with the one computed by the subclass
+    /// (and the fingerprint, if any).
+    ///
+    /// Call this after modifying pi_m directly.
     /// Do not override unless you know what you are doing.
     void
     update_cost() 
-    { cost_m = compute_cost(); }
+    { 
+      cost_m = compute_cost(); update_fingerprint(); 
+      if(journal_m) journal_m->invalidate();
+    }
     
     /// @brief: Apply a swap and update the cost.
     /// Do not override unless you know what you are doing.
     void
     apply_swap(int i, int j)
-    { cost_m += evaluate_swap(i,j); std::swap(pi_m[i], pi_m[j]); }
-    
+    { 
+      cost_m += evaluate_swap(i,j); 
+      if(zobrist_m) fingerprint_m ^= swap_key(i,j);
+      if(journal_m) journal_m->record(i,j);
+      std::swap(pi_m[i], pi_m[j]); 
+    }
+
+    /// @brief Report each apply_swap() (and each other change) to
+    /// journal (0 to stop).
+    ///
+    /// Only one journal can be attached at a time and it must
+    /// outlive this solution or be detached.
+    void
+    journal(swap_journal* j)
+    { journal_m = j; }
+
+    /// @brief Maintain a Zobrist fingerprint of pi_m using the keys
+    /// in table.
+    ///
+    /// The fingerprint is then updated in O(1) by each apply_swap().
+    /// The table must outlive this solution and must have the same
+    /// size.
+    void
+    use_fingerprint(const zobrist_table& table)
+    { assert(table.size() == static_cast<int>(size()));
+      zobrist_m = &table; update_fingerprint(); }
+
+    /// @brief The fingerprint of the current solution (0 if no
+    /// zobrist_table is in use).
+    size_t
+    fingerprint() const METSLIB_NOEXCEPT
+    { return fingerprint_m; }
+
+    /// @brief The fingerprint the solution would have after swapping
+    /// i and j (without actually modifying the solution).
+    size_t
+    fingerprint_after_swap(int i, int j) const
+    { assert(zobrist_m); return fingerprint_m ^ swap_key(i,j); }
 
   protected:
     std::vector<int> pi_m;
     gol_type cost_m;
+    const zobrist_table* zobrist_m;
+    size_t fingerprint_m;
+    swap_journal* journal_m;
+
+    /// @brief Recompute the fingerprint from scratch.
+    void
+    update_fingerprint()
+    { 
+      fingerprint_m = 0;
+      if(zobrist_m)
+	for(unsigned int ii = 0; ii != pi_m.size(); ++ii)
+	  fingerprint_m ^= zobrist_m->key(pi_m[ii], ii);
+    }
+
+    /// @brief The fingerprint change due to a swap of i and j.
+    size_t
+    swap_key(int i, int j) const METSLIB_NOEXCEPT
+    { 
+      return zobrist_m->key(pi_m[i], i) ^ zobrist_m->key(pi_m[j], j)
+	^ zobrist_m->key(pi_m[i], j) ^ zobrist_m->key(pi_m[j], i); 
+    }
+
     template<typename random_generator> 
     friend void random_shuffle(permutation_problem& p, random_generator& rng);
+    friend class frequency_memory;
+    friend class lazy_best_solution;
+    template<typename random_generator>
+    friend class memetic_algorithm;
   };
 
 
+  /// @brief A permutation problem with costs of type cost_type
+  /// (e.g. int or long long).
+  ///
+  /// The cost and the swaps are evaluated in cost_type and converted
+  /// to gol_type for the searches. The integer values within the
+  /// mantissa of gol_type (2^53 with double) are represented
+  /// exactly, so the incremental cost and all the comparisons made
+  /// by the searches and recorders are exact and do not drift. A
+  /// cost or a delta outside the mantissa (and a current cost that
+  /// has grown outside it, see exact_cost()) raises a
+  /// std::runtime_error instead of being silently rounded.
+  ///
+  /// Only the costs are exact: the searches, recorders and criteria
+  /// still compare (and e.g. simulated annealing still computes with)
+  /// gol_type values. The assignment, bit vector and real vector
+  /// skeletons have no exact variant.
+  ///
+  /// Implement compute_exact_cost() and evaluate_exact_swap() (and
+  /// optionally evaluate_exact_swaps() with a kernel working on
+  /// cost_type) instead of compute_cost() and evaluate_swap().
+  template<typename cost_type>
+  class exact_permutation_problem : public permutation_problem
+  {
+  public:
+    /// @brief A new identity permutation of n elements.
+    exact_permutation_problem(int n)
+      : permutation_problem(n)
+    { }
+
+    /// @brief: Compute cost of the whole solution.
+    virtual cost_type
+    compute_exact_cost() const = 0;
+
+    /// @brief: The change in cost after swapping i and j (see
+    /// permutation_problem::evaluate_swap).
+    virtual cost_type
+    evaluate_exact_swap(int i, int j) const = 0;
+
+    /// @brief: Evaluate many swaps at once (see
+    /// permutation_problem::evaluate_swaps).
+    virtual void
+    evaluate_exact_swaps(const int* i, const int* j, cost_type* deltas, 
+			 size_t count) const
+    {
+      for(size_t k = 0; k != count; ++k)
+	deltas[k] = evaluate_exact_swap(i[k], j[k]);
+    }
+
+    /// @brief The current cost as a cost_type.
+    cost_type
+    exact_cost() const
+    { 
+      if(!std::numeric_limits<gol_type>::is_integer
+	 && (cost_m > gol_type(max_exact()) || cost_m < -gol_type(max_exact())))
+	throw std::runtime_error("The cost is too large to be exact.");
+      return static_cast<cost_type>(cost_m); 
+    }
+
+    gol_type
+    compute_cost() const
+    { return to_gol(compute_exact_cost()); }
+
+    gol_type
+    evaluate_swap(int i, int j) const
+    { return to_gol(evaluate_exact_swap(i, j)); }
+
+    /// The exact deltas are evaluated in chunks on the stack: no
+    /// memory is allocated and concurrent calls on the same solution
+    /// are safe.
+    void
+    evaluate_swaps(const int* i, const int* j, gol_type* deltas, 
+		   size_t count) const
+    {
+      cost_type exact[chunk];
+      for(size_t first = 0; first < count; first += chunk)
+	{
+	  size_t n = std::min(count - first, size_t(chunk));
+	  evaluate_exact_swaps(i + first, j + first, exact, n);
+	  for(size_t k = 0; k != n; ++k)
+	    deltas[first + k] = to_gol(exact[k]);
+	}
+    }
+
+  protected:
+    enum { chunk = 256 };
+
+    /// @brief The largest cost represented exactly both as a
+    /// cost_type and as a gol_type.
+    static cost_type
+    max_exact()
+    {
+      const int digits = std::min(std::numeric_limits<gol_type>::digits,
+				  std::numeric_limits<cost_type>::digits);
+      return static_cast<cost_type>((1ULL << digits) - 1);
+    }
+
+    /// @brief Convert a cost, checking that it is represented
+    /// exactly.
+    static gol_type
+    to_gol(cost_type c)
+    {
+      if(std::numeric_limits<cost_type>::is_integer
+	 && (c > max_exact() 
+	     || (std::numeric_limits<cost_type>::is_signed 
+		 && c < -max_exact())))
+	throw std::runtime_error("The cost is too large to be exact.");
+      return static_cast<gol_type>(c);
+    }
+  };
+
   /// @brief Shuffle a permutation problem (generates a random starting point).
   ///
   /// @see mets::permutation_problem
@@ -245,15 +766,13 @@ namespace mets {
   void random_shuffle(permutation_problem& p, random_generator& rng)
   {
 #if defined (METSLIB_HAVE_UNORDERED_MAP) && !defined (METSLIB_TR1_MIXED_NAMESPACE)
-    std::uniform_int<size_t> unigen;
-    std::variate_generator<random_generator&, 
-      std::uniform_int<size_t> >gen(rng, unigen);
+    std::shuffle(p.pi_m.begin(), p.pi_m.end(), rng);
 #else
     std::tr1::uniform_int<size_t> unigen;
     std::tr1::variate_generator<random_generator&, 
       std::tr1::uniform_int<size_t> >gen(rng, unigen);
-#endif
     std::random_shuffle(p.pi_m.begin(), p.pi_m.end(), gen);
+#endif
     p.update_cost();
   }
   
@@ -264,7 +783,7 @@ namespace mets {
   void perturbate(permutation_problem& p, unsigned int n, random_generator& rng)
   {
 #if defined (METSLIB_HAVE_UNORDERED_MAP) && !defined (METSLIB_TR1_MIXED_NAMESPACE)
-    std::uniform_int<> int_range;
+    mets::uniform_int<> int_range;
 #else
     std::tr1::uniform_int<> int_range;
 #endif
@@ -278,68 +797,661 @@ namespace mets {
       }
   }
     
-  /// @brief Move to be operated on a feasible solution.
+  /// @brief Number of positions where two permutations differ.
   ///
-  /// You must implement this (one or more types are allowed) for your
-  /// problem.
+  /// The loop is branch free so that the compiler can vectorize it.
   ///
-  /// You must provide an apply as well as an evaluate method.
+  /// @see mets::permutation_problem
+  inline size_t
+  hamming_distance(const permutation_problem& a, const permutation_problem& b)
+    METSLIB_NOEXCEPT
+  {
+    assert(a.size() == b.size());
+    const int* pa = &a.permutation()[0];
+    const int* pb = &b.permutation()[0];
+    const int n = a.size();
+    int d = 0;
+    for(int ii = 0; ii < n; ++ii)
+      d += (pa[ii] != pb[ii]);
+    return d;
+  }
+
+  /// @brief An abstract assignment problem.
   ///
-  /// NOTE: this interface changed from 0.4.x to 0.5.x. The change was
-  /// needed to provide a more general interface.
-  class move
+  /// The assignment problem provides a skeleton for problems where
+  /// each of n items is assigned a value in [0..k-1] (scheduling,
+  /// bin assignment, graph coloring and so on). The skeleton holds a
+  /// values_m variable with the value of each item.
+  ///
+  /// As for the mets::permutation_problem the cost is updated
+  /// incrementally: the subclass computes the change in cost of
+  /// assigning a new value to an item and the skeleton keeps track of
+  /// the current cost.
+  ///
+  /// @see mets::change_value
+  class assignment_problem: public evaluable_solution, 
+			    public serializable
   {
   public:
+    
+    /// @brief Unimplemented.
+    assignment_problem(); 
 
-    virtual 
-    ~move() 
-    { }; 
+    /// @brief Inizialize values_m = {0, 0, ..., 0}.
+    ///
+    /// @param n The number of items.
+    /// @param k The number of values.
+    assignment_problem(int n, int k) 
+      : values_m(n, 0), domain_m(k), cost_m(0.0)
+    { }
 
+    /// @brief Copy from another assignment problem, if you introduce
+    /// new member variables remember to override this and to call
+    /// assignment_problem::copy_from in the overriding code.
     ///
-    /// @brief Evaluate the cost after the move.
+    /// @param other the problem to copy from
+    void copy_from(const copyable& other);
+
+    /// @brief Save the values and the cost (see
+    /// permutation_problem::save).
+    void save(std::ostream& os) const
+    { write_binary(os, values_m); write_binary(os, cost_m); }
+
+    /// @brief Restore the values and the cost (a std::runtime_error
+    /// is raised if they were saved from a problem of a different
+    /// size).
+    void load(std::istream& is)
+    { read_binary_fixed(is, values_m); read_binary(is, cost_m); }
+
+    /// @brief: Compute cost of the whole solution.
     ///
-    /// What if we make this move? Local searches can be speed up by a
-    /// substantial amount if we are able to efficiently evaluate the
-    /// cost of the neighboring solutions without actually changing
-    /// the solution.
+    /// You will need to override this one.
     virtual gol_type
-    evaluate(const feasible_solution& sol) const = 0;
+    compute_cost() const = 0;
 
+    /// @brief: Evaluate the assignment of value v to item i.
     ///
-    /// @brief Operates this move on sol.
+    /// Implement this method to return the difference in cost
+    /// between the current solution and the solution with
+    /// values_m[i] = v (without actually modifying the solution).
     ///
-    /// This should actually change the solution.
+    /// As for permutation_problem::evaluate_swap, only compute the
+    /// cost update whenever possible.
+    virtual gol_type
+    evaluate_assign(int i, int v) const = 0;
+
+    /// @brief: Evaluate many assignments at once.
+    ///
+    /// Stores in deltas[k] the value of evaluate_assign(i[k], v[k])
+    /// for k in [0, count). Override this when the assignments can be
+    /// evaluated more efficiently together, the default
+    /// implementation simply calls evaluate_assign.
     virtual void
-    apply(feasible_solution& sol) const = 0;
+    evaluate_assigns(const int* i, const int* v, gol_type* deltas, 
+		     size_t count) const
+    {
+      for(size_t k = 0; k != count; ++k)
+	deltas[k] = evaluate_assign(i[k], v[k]);
+    }
+
+    /// @brief The number of items.
+    size_t 
+    size() const
+    { return values_m.size(); }
+
+    /// @brief The number of values (each item has a value in
+    /// [0..domain()-1]).
+    int
+    domain() const
+    { return domain_m; }
+
+    /// @brief The current values.
+    const std::vector<int>&
+    values() const
+    { return values_m; }
+
+    /// @brief Returns the cost of the current solution (the
+    /// protected cost_m member variable).
+    gol_type cost_function() const 
+    { return cost_m; }
+
+    /// @brief Updates the cost with the one computed by the subclass.
+    ///
+    /// Call this after modifying values_m directly. Override this
+    /// (calling assignment_problem::update_cost) to rebuild data
+    /// derived from the values.
+    virtual void
+    update_cost() 
+    { cost_m = compute_cost(); }
+    
+    /// @brief: Assign value v to item i and update the cost.
+    void
+    apply_assign(int i, int v)
+    { 
+      cost_m += evaluate_assign(i, v); 
+      assigning(i, v);
+      values_m[i] = v; 
+    }
+
+  protected:
+    std::vector<int> values_m;
+    int domain_m;
+    gol_type cost_m;
 
+    /// @brief Called by apply_assign() with the item and the value
+    /// it is about to take: override this to update data derived from
+    /// the values (e.g. a mets::constraint_tracker) incrementally.
+    virtual void
+    assigning(int, int)
+    { }
 
+    template<typename random_generator> 
+    friend void random_assign(assignment_problem& p, random_generator& rng);
   };
 
-  /// @brief A Mana Move is a move that can be automatically made tabu
-  /// by the mets::simple_tabu_list.
+  /// @brief Assign a random value to each item (generates a random
+  /// starting point).
   ///
-  /// If you implement this class you can use the
-  /// mets::simple_tabu_list as a ready to use tabu list.
-  /// 
-  /// You must implement a clone() method, provide an hash funciton
-  /// and provide a operator==() method that is responsible to find if
-  /// a move is equal to another.
+  /// @see mets::assignment_problem
+  template<typename random_generator>
+  void random_assign(assignment_problem& p, random_generator& rng)
+  {
+#if defined (METSLIB_HAVE_UNORDERED_MAP) && !defined (METSLIB_TR1_MIXED_NAMESPACE)
+    mets::uniform_int<> int_range;
+#else
+    std::tr1::uniform_int<> int_range;
+#endif
+    for(unsigned int ii = 0; ii != p.values_m.size(); ++ii)
+      p.values_m[ii] = int_range(rng, p.domain_m);
+    p.update_cost();
+  }
+
+  /// @brief An abstract binary problem.
   ///
-  /// NOTE: If the desired behaviour is to declare tabu the *opposite*
-  /// of the last made move you can achieve that behavioud override
-  /// the opposite_of() method as well.
+  /// The bit vector problem provides a skeleton for problems whose
+  /// solutions are n binary variables (knapsack, MaxSAT, QUBO and so
+  /// on). The bits are packed in 64 bit words (bit i is bit i%64 of
+  /// words_m[i/64], the unused bits of the last word are always 0)
+  /// so that counting and comparing solutions is done a word at a
+  /// time.
   ///
-  class mana_move : 
-    public move, 
-    public clonable, 
-    public hashable
+  /// The cost is updated incrementally: the subclass computes the
+  /// change in cost of flipping a bit. A one-flip search evaluates
+  /// the flip of every bit at each iteration: to make this cheap the
+  /// problem can keep the deltas of all the flips in a vector (see
+  /// cache_deltas()) and update it after each flip (see
+  /// update_deltas()).
+  ///
+  /// @see mets::flip_bit
+  class bitvector_problem: public evaluable_solution, 
+			   public serializable
   {
   public:
-    
-    /// @brief Create and return a new move that is the reverse of
-    /// this one
+    /// @brief The type of the words the bits are packed into.
+    typedef unsigned long long word_type;
+
+    /// @brief Unimplemented.
+    bitvector_problem(); 
+
+    /// @brief Inizialize all the n bits to 0.
+    bitvector_problem(int n) 
+      : words_m((n + 63) / 64, 0), n_m(n), cost_m(0.0), cached_m(false),
+	deltas_m(), all_m()
+    { }
+
+    /// @brief Copy from another bit vector problem, if you introduce
+    /// new member variables remember to override this and to call
+    /// bitvector_problem::copy_from in the overriding code.
     ///
-    /// By default this just calls "clone". If this method is not
+    /// @param other the problem to copy from
+    void copy_from(const copyable& other);
+
+    /// @brief Save the bits and the cost (see
+    /// permutation_problem::save).
+    void save(std::ostream& os) const
+    { write_binary(os, words_m); write_binary(os, cost_m); }
+
+    /// @brief Restore the bits and the cost (a std::runtime_error is
+    /// raised if they were saved from a problem of a different size).
+    void load(std::istream& is)
+    { 
+      std::vector<word_type> words(words_m.size());
+      read_binary_fixed(is, words);
+      if(n_m % 64 && words.back() >> (n_m % 64))
+	throw std::runtime_error("The serialized data has a different size.");
+      read_binary(is, cost_m); 
+      words_m.swap(words);
+      if(cached_m) refresh_deltas();
+    }
+
+    /// @brief: Compute cost of the whole solution.
+    ///
+    /// You will need to override this one.
+    virtual gol_type
+    compute_cost() const = 0;
+
+    /// @brief: Evaluate the flip of bit i.
+    ///
+    /// Implement this method to return the difference in cost
+    /// between the current solution and the solution with bit i
+    /// flipped (without actually modifying the solution).
+    virtual gol_type
+    evaluate_flip(int i) const = 0;
+
+    /// @brief: Evaluate many flips at once.
+    ///
+    /// Stores in deltas[k] the value of evaluate_flip(i[k]) for k in
+    /// [0, count). Override this when the flips can be evaluated more
+    /// efficiently together, the default implementation simply calls
+    /// evaluate_flip.
+    virtual void
+    evaluate_flips(const int* i, gol_type* deltas, size_t count) const
+    {
+      for(size_t k = 0; k != count; ++k)
+	deltas[k] = evaluate_flip(i[k]);
+    }
+
+    /// @brief The number of bits.
+    size_t 
+    size() const
+    { return n_m; }
+
+    /// @brief The value of bit i.
+    bool
+    bit(int i) const METSLIB_NOEXCEPT
+    { return (words_m[i >> 6] >> (i & 63)) & 1; }
+
+    /// @brief The packed bits.
+    const std::vector<word_type>&
+    words() const
+    { return words_m; }
+
+    /// @brief The number of bits set.
+    size_t
+    count() const METSLIB_NOEXCEPT
+    { 
+      size_t c = 0;
+      for(size_t ii = 0; ii != words_m.size(); ++ii)
+	c += popcount(words_m[ii]);
+      return c;
+    }
+
+    /// @brief The number of bits set in w.
+    static int
+    popcount(word_type w) METSLIB_NOEXCEPT
+    {
+#if defined (__GNUC__)
+      return __builtin_popcountll(w);
+#else
+      int c = 0;
+      for(; w; w &= w - 1) ++c;
+      return c;
+#endif
+    }
+
+    /// @brief Returns the cost of the current solution (the
+    /// protected cost_m member variable).
+    gol_type cost_function() const 
+    { return cost_m; }
+
+    /// @brief Updates the cost with the one computed by the subclass
+    /// (and the cached deltas, if any).
+    ///
+    /// Call this after modifying words_m directly.
+    void
+    update_cost() 
+    { cost_m = compute_cost(); if(cached_m) refresh_deltas(); }
+
+    /// @brief Keep the deltas of all the flips up to date (or stop
+    /// doing it).
+    ///
+    /// While the cache is active flip_delta() is a lookup.
+    void
+    cache_deltas(bool active)
+    { cached_m = active; if(cached_m) refresh_deltas(); }
+
+    /// @brief The change in cost of flipping bit i (from the cache,
+    /// if active).
+    gol_type
+    flip_delta(int i) const
+    { return cached_m ? deltas_m[i] : evaluate_flip(i); }
+
+    /// @brief: Flip bit i and update the cost (and the cached
+    /// deltas, if any).
+    void
+    apply_flip(int i)
+    { 
+      cost_m += flip_delta(i);
+      words_m[i >> 6] ^= word_type(1) << (i & 63);
+      if(cached_m) update_deltas(i);
+    }
+
+  protected:
+    std::vector<word_type> words_m;
+    int n_m;
+    gol_type cost_m;
+    bool cached_m;
+    /// the deltas of all the flips (when cached_m)
+    std::vector<gol_type> deltas_m;
+    std::vector<int> all_m;
+
+    /// @brief Update deltas_m after the given bit was flipped.
+    ///
+    /// The default implementation recomputes all the deltas with
+    /// evaluate_flips(). Override this to only update the deltas of
+    /// the variables interacting with the flipped bit: this is what
+    /// makes the cache pay.
+    virtual void
+    update_deltas(int)
+    { refresh_deltas(); }
+
+    /// @brief Recompute all the deltas.
+    void
+    refresh_deltas()
+    {
+      if(all_m.size() != static_cast<size_t>(n_m))
+	{
+	  all_m.resize(n_m);
+	  std::generate(all_m.begin(), all_m.end(), sequence(0));
+	}
+      deltas_m.resize(n_m);
+      if(n_m)
+	evaluate_flips(&all_m[0], &deltas_m[0], n_m);
+    }
+
+    template<typename random_generator> 
+    friend void random_bits(bitvector_problem& p, random_generator& rng);
+  };
+
+  /// @brief Set each bit at random (generates a random starting
+  /// point).
+  ///
+  /// @see mets::bitvector_problem
+  template<typename random_generator>
+  void random_bits(bitvector_problem& p, random_generator& rng)
+  {
+#if defined (METSLIB_HAVE_UNORDERED_MAP) && !defined (METSLIB_TR1_MIXED_NAMESPACE)
+    mets::uniform_int<> int_range;
+#else
+    std::tr1::uniform_int<> int_range;
+#endif
+    std::fill(p.words_m.begin(), p.words_m.end(), 0);
+    for(int ii = 0; ii != p.n_m; ++ii)
+      if(int_range(rng, 2))
+	p.words_m[ii >> 6] |= bitvector_problem::word_type(1) << (ii & 63);
+    p.update_cost();
+  }
+
+  /// @brief Number of bits where two solutions differ.
+  ///
+  /// @see mets::bitvector_problem
+  inline size_t
+  hamming_distance(const bitvector_problem& a, const bitvector_problem& b)
+    METSLIB_NOEXCEPT
+  {
+    assert(a.size() == b.size());
+    const std::vector<bitvector_problem::word_type>& wa = a.words();
+    const std::vector<bitvector_problem::word_type>& wb = b.words();
+    size_t d = 0;
+    for(size_t ii = 0; ii != wa.size(); ++ii)
+      d += bitvector_problem::popcount(wa[ii] ^ wb[ii]);
+    return d;
+  }
+
+  /// @brief An allocator returning memory aligned to Alignment
+  /// bytes (a power of two, e.g. a cache line), so that the
+  /// vectorized loops on the data can use aligned loads.
+  template<typename Tp, size_t Alignment = 64>
+  class aligned_allocator
+  {
+  public:
+    typedef Tp value_type;
+    typedef Tp* pointer;
+    typedef const Tp* const_pointer;
+    typedef Tp& reference;
+    typedef const Tp& const_reference;
+    typedef size_t size_type;
+    typedef std::ptrdiff_t difference_type;
+
+    template<typename Up>
+    struct rebind 
+    { typedef aligned_allocator<Up, Alignment> other; };
+
+    aligned_allocator() 
+    { }
+
+    template<typename Up>
+    aligned_allocator(const aligned_allocator<Up, Alignment>&) 
+    { }
+
+    pointer address(reference x) const 
+    { return &x; }
+
+    const_pointer address(const_reference x) const 
+    { return &x; }
+
+    /// @brief Allocate n objects (the address of the raw block is
+    /// stored just before the aligned one).
+    pointer allocate(size_type n, const void* = 0)
+    {
+      if(n > max_size())
+	throw std::bad_alloc();
+      char* raw = static_cast<char*>
+	(::operator new(n * sizeof(Tp) + Alignment + sizeof(void*)));
+      size_t aligned = (reinterpret_cast<size_t>(raw) + sizeof(void*) 
+			+ Alignment - 1) & ~(Alignment - 1);
+      reinterpret_cast<void**>(aligned)[-1] = raw;
+      return reinterpret_cast<pointer>(aligned);
+    }
+
+    void deallocate(pointer p, size_type)
+    { if(p) ::operator delete(reinterpret_cast<void**>(p)[-1]); }
+
+    size_type max_size() const 
+    { return (size_t(-1) - Alignment - sizeof(void*)) / sizeof(Tp); }
+
+    void construct(pointer p, const Tp& value) 
+    { new(p) Tp(value); }
+
+    void destroy(pointer p) 
+    { p->~Tp(); }
+
+    bool operator==(const aligned_allocator&) const 
+    { return true; }
+
+    bool operator!=(const aligned_allocator&) const 
+    { return false; }
+  };
+
+  /// @brief An abstract continuous problem.
+  ///
+  /// The real vector problem provides a skeleton for problems whose
+  /// solutions are points in R^n (e.g. the calibration of the
+  /// parameters of a model). The point is stored in a contiguous,
+  /// cache line aligned, vector of doubles.
+  ///
+  /// The moves change one coordinate at a time (see
+  /// mets::step_coordinate): the subclass computes the change in
+  /// cost of a step along a coordinate. The neighborhoods evaluate
+  /// all their steps with a single call to evaluate_steps(), that
+  /// can be overridden to evaluate them together (the coordinates
+  /// and the steps are passed as two separate arrays).
+  ///
+  /// The revision() is incremented at each change of the point so
+  /// that moves can tell if a delta computed earlier is still valid.
+  class real_vector_problem: public evaluable_solution, 
+			     public serializable
+  {
+  public:
+    /// @brief The type of the point.
+    typedef std::vector<double, aligned_allocator<double> > vector_type;
+
+    /// @brief Unimplemented.
+    real_vector_problem(); 
+
+    /// @brief Inizialize the point to the origin of R^n.
+    real_vector_problem(int n) 
+      : x_m(n, 0.0), cost_m(0.0), revision_m(0)
+    { }
+
+    /// @brief Copy from another real vector problem, if you introduce
+    /// new member variables remember to override this and to call
+    /// real_vector_problem::copy_from in the overriding code.
+    ///
+    /// @param other the problem to copy from
+    void copy_from(const copyable& other);
+
+    /// @brief Save the point and the cost (see
+    /// permutation_problem::save).
+    void save(std::ostream& os) const
+    { write_binary(os, x_m); write_binary(os, cost_m); }
+
+    /// @brief Restore the point and the cost (a std::runtime_error is
+    /// raised if they were saved from a problem of a different size).
+    void load(std::istream& is)
+    { read_binary_fixed(is, x_m); read_binary(is, cost_m); ++revision_m; }
+
+    /// @brief: Compute cost of the whole solution.
+    ///
+    /// You will need to override this one.
+    virtual gol_type
+    compute_cost() const = 0;
+
+    /// @brief: Evaluate a step along a coordinate.
+    ///
+    /// Implement this method to return the difference in cost
+    /// between the current point and the point with x_m[i] + step
+    /// in place of x_m[i] (without actually modifying the solution).
+    virtual gol_type
+    evaluate_step(int i, double step) const = 0;
+
+    /// @brief: Evaluate many steps at once.
+    ///
+    /// Stores in deltas[k] the value of evaluate_step(i[k],
+    /// steps[k]) for k in [0, count). Override this when the steps
+    /// can be evaluated more efficiently together, the default
+    /// implementation simply calls evaluate_step.
+    virtual void
+    evaluate_steps(const int* i, const double* steps, gol_type* deltas, 
+		   size_t count) const
+    {
+      for(size_t k = 0; k != count; ++k)
+	deltas[k] = evaluate_step(i[k], steps[k]);
+    }
+
+    /// @brief The dimension of the problem.
+    size_t 
+    size() const
+    { return x_m.size(); }
+
+    /// @brief The current point.
+    const vector_type&
+    point() const
+    { return x_m; }
+
+    /// @brief Returns the cost of the current solution (the
+    /// protected cost_m member variable).
+    gol_type cost_function() const 
+    { return cost_m; }
+
+    /// @brief Incremented at each change of the point.
+    unsigned long
+    revision() const
+    { return revision_m; }
+
+    /// @brief Updates the cost with the one computed by the subclass.
+    ///
+    /// Call this after modifying x_m directly.
+    void
+    update_cost() 
+    { cost_m = compute_cost(); ++revision_m; }
+    
+    /// @brief: Make a step along coordinate i and update the cost.
+    void
+    apply_step(int i, double step)
+    { apply_step(i, step, evaluate_step(i, step)); }
+
+    /// @brief: Make a step along coordinate i whose delta is already
+    /// known (as returned by evaluate_step(i, step)).
+    void
+    apply_step(int i, double step, gol_type delta)
+    { cost_m += delta; x_m[i] += step; ++revision_m; }
+
+  protected:
+    vector_type x_m;
+    gol_type cost_m;
+    unsigned long revision_m;
+  };
+
+  /// @brief Move to be operated on a feasible solution.
+  ///
+  /// You must implement this (one or more types are allowed) for your
+  /// problem.
+  ///
+  /// You must provide an apply as well as an evaluate method.
+  ///
+  /// NOTE: this interface changed from 0.4.x to 0.5.x. The change was
+  /// needed to provide a more general interface.
+  class mana_move;
+
+  class move
+  {
+  public:
+
+    virtual 
+    ~move() 
+    { }; 
+
+    /// @brief This move as a mana_move (0 if it is not).
+    virtual const mana_move*
+    mana() const
+    { return 0; }
+
+    ///
+    /// @brief Evaluate the cost after the move.
+    ///
+    /// What if we make this move? Local searches can be speed up by a
+    /// substantial amount if we are able to efficiently evaluate the
+    /// cost of the neighboring solutions without actually changing
+    /// the solution.
+    virtual gol_type
+    evaluate(const feasible_solution& sol) const = 0;
+
+    ///
+    /// @brief Operates this move on sol.
+    ///
+    /// This should actually change the solution.
+    virtual void
+    apply(feasible_solution& sol) const = 0;
+
+
+  };
+
+  /// @brief A Mana Move is a move that can be automatically made tabu
+  /// by the mets::simple_tabu_list.
+  ///
+  /// If you implement this class you can use the
+  /// mets::simple_tabu_list as a ready to use tabu list.
+  /// 
+  /// You must implement a clone() method, provide an hash funciton
+  /// and provide a operator==() method that is responsible to find if
+  /// a move is equal to another.
+  ///
+  /// NOTE: If the desired behaviour is to declare tabu the *opposite*
+  /// of the last made move you can achieve that behavioud override
+  /// the opposite_of() method as well.
+  ///
+  class mana_move : 
+    public move, 
+    public clonable, 
+    public hashable
+  {
+  public:
+    
+    /// @brief Create and return a new move that is the reverse of
+    /// this one
+    ///
+    /// By default this just calls "clone". If this method is not
     /// overridden the mets::simple_tabu_list declares tabu the last
     /// made move. Reimplementing this method it is possibile to
     /// actually declare as tabu the opposite of the last made move
@@ -347,24 +1459,102 @@ namespace mets {
     virtual mana_move*
     opposite_of() const 
     { return static_cast<mana_move*>(clone()); }
+
+    const mana_move*
+    mana() const
+    { return this; }
+
+    /// @brief An address identifying the type of this move (see
+    /// mets::move_tag), so that operator==() can tell moves of
+    /// different types apart without RTTI.
+    ///
+    /// The default (0) is fine if your operator==() does not need
+    /// it.
+    virtual const void*
+    tag() const
+    { return 0; }
+
+    /// @brief Store the opposite of this move in the given target
+    /// without allocating (used by a mets::move_pool, only when one
+    /// is given to the mets::simple_tabu_list).
+    ///
+    /// The target is a released move with the same tag() as this
+    /// one. Return false (the default) if this is not supported:
+    /// opposite_of() is then used. If you derive from a move of the
+    /// library and override opposite_of() override this as well
+    /// before using a pool.
+    virtual bool
+    opposite_into(mana_move&) const
+    { return false; }
     
     /// @brief Tell if this move equals another w.r.t. the tabu list
     /// management (for mets::simple_tabu_list)
     virtual bool 
     operator==(const mana_move& other) const = 0;
     
+    /// @brief Save this move (needed only to checkpoint a
+    /// mets::simple_tabu_list).
+    virtual void
+    save(std::ostream&) const
+    { throw std::runtime_error("This move cannot be saved."); }
+
+    /// @brief Restore this move (needed only to checkpoint a
+    /// mets::simple_tabu_list).
+    virtual void
+    load(std::istream&)
+    { throw std::runtime_error("This move cannot be loaded."); }
+
+  };
+
+  /// @brief The mets::mana_move::tag() of move_type: the address of
+  /// id is unique to each type.
+  template<typename move_type>
+  struct move_tag
+  {
+    static const char id;
+  };
+
+  template<typename move_type>
+  const char move_tag<move_type>::id = 0;
+
+  /// @brief The mana_move interface of mov.
+  ///
+  /// Throws std::bad_cast if mov is not a mana_move.
+  inline const mana_move&
+  mana_cast(const move& mov)
+  {
+    const mana_move* m = mov.mana();
+    if(!m)
+      throw std::bad_cast();
+    return *m;
+  }
+
+  /// @brief A mets::mana_move operating on a
+  /// mets::permutation_problem.
+  ///
+  /// Besides being a mana move, a permutation move can tell the
+  /// fingerprint of the solution it leads to without applying it
+  /// (this is needed by the mets::solution_tabu_list).
+  ///
+  /// @see mets::permutation_problem::use_fingerprint
+  class permutation_move : public mets::mana_move
+  {
+  public:
+    /// @brief The fingerprint of sol after this move.
+    virtual size_t
+    fingerprint(const permutation_problem& sol) const = 0;
   };
 
   template<typename rndgen> class swap_neighborhood; // fw decl
 
-  /// @brief A mets::mana_move that swaps two elements in a
+  /// @brief A mets::permutation_move that swaps two elements in a
   /// mets::permutation_problem.
   ///
   /// Each instance swaps two specific objects.
   ///
   /// @see mets::permutation_problem, mets::mana_move
   ///
-  class swap_elements : public mets::mana_move 
+  class swap_elements : public mets::permutation_move 
   {
   public:  
 
@@ -401,11 +1591,40 @@ namespace mets {
     /// a move in the simple tabu list move set.
     bool 
     operator==(const mets::mana_move& o) const;
+
+    const void*
+    tag() const
+    { return &move_tag<swap_elements>::id; }
+
+    bool
+    opposite_into(mana_move& target) const
+    { static_cast<swap_elements&>(target).change(p1, p2); return true; }
+
+    /// @brief The fingerprint of sol after the swap.
+    size_t
+    fingerprint(const permutation_problem& sol) const
+    { return sol.fingerprint_after_swap(p1, p2); }
+
+    void
+    save(std::ostream& os) const
+    { write_binary(os, p1); write_binary(os, p2); }
+
+    void
+    load(std::istream& is)
+    { read_binary(is, p1); read_binary(is, p2); }
     
     /// @brief Modify this swap move.
     void change(int from, int to)
     { p1 = std::min(from,to); p2 = std::max(from,to); }
 
+    /// @brief The first (lower) position to swap.
+    int first() const
+    { return p1; }
+
+    /// @brief The second (higher) position to swap.
+    int second() const
+    { return p2; }
+
   protected:
     int p1; ///< the first element to swap
     int p2; ///< the second element to swap
@@ -414,12 +1633,12 @@ namespace mets {
     friend class swap_neighborhood;
   };
 
-  /// @brief A mets::mana_move that swaps a subsequence of elements in
-  /// a mets::permutation_problem.
+  /// @brief A mets::permutation_move that swaps a subsequence of
+  /// elements in a mets::permutation_problem.
   ///
   /// @see mets::permutation_problem, mets::mana_move
   ///
-  class invert_subsequence : public mets::mana_move 
+  class invert_subsequence : public mets::permutation_move 
   {
   public:  
 
@@ -450,6 +1669,26 @@ namespace mets {
     /// a move in the tabu list.
     bool 
     operator==(const mets::mana_move& o) const;
+
+    const void*
+    tag() const
+    { return &move_tag<invert_subsequence>::id; }
+
+    bool
+    opposite_into(mana_move& target) const
+    { static_cast<invert_subsequence&>(target).change(p1, p2); return true; }
+
+    /// @brief The fingerprint of sol after the inversion.
+    size_t
+    fingerprint(const permutation_problem& sol) const;
+
+    void
+    save(std::ostream& os) const
+    { write_binary(os, p1); write_binary(os, p2); }
+
+    void
+    load(std::istream& is)
+    { read_binary(is, p1); read_binary(is, p2); }
     
     void change(int from, int to)
     { p1 = from; p2 = to; }
@@ -462,21 +1701,275 @@ namespace mets {
     // friend class invert_full_neighborhood;
   };
 
-  /// @brief A neighborhood generator.
-  ///
-  /// This is a sample implementation of the neighborhood exploration
-  /// concept. You can still derive from this class and implement the
-  /// refresh method, but, since version 0.5.x you don't need to.
+  /// @brief A mets::mana_move that assigns a value to an item of a
+  /// mets::assignment_problem.
   ///
-  /// To implement your own move manager you should simply adhere to
-  /// the following concept:
+  /// @see mets::assignment_problem, mets::assignment_tabu_list
+  class change_value : public mets::mana_move 
+  {
+  public:  
+
+    /// @brief A move that assigns value to item.
+    change_value(int item, int value) 
+      : item_m(item), value_m(value)
+    { }
+    
+    /// @brief The cost after the move.
+    gol_type
+    evaluate(const mets::feasible_solution& s) const
+    { const assignment_problem& sol = 
+	static_cast<const assignment_problem&>(s);
+      return sol.cost_function() + sol.evaluate_assign(item_m, value_m); }
+    
+    /// @brief Assign the value.
+    void
+    apply(mets::feasible_solution& s) const
+    { assignment_problem& sol = static_cast<assignment_problem&>(s);
+      sol.apply_assign(item_m, value_m); }
+            
+    clonable* 
+    clone() const
+    { return new change_value(item_m, value_m); }
+
+    size_t
+    hash() const
+    { return (item_m)<<16^(value_m); }
+    
+    bool 
+    operator==(const mets::mana_move& o) const;
+
+    const void*
+    tag() const
+    { return &move_tag<change_value>::id; }
+
+    bool
+    opposite_into(mana_move& target) const
+    { static_cast<change_value&>(target).change(item_m, value_m); return true; }
+
+    void
+    save(std::ostream& os) const
+    { write_binary(os, item_m); write_binary(os, value_m); }
+
+    void
+    load(std::istream& is)
+    { read_binary(is, item_m); read_binary(is, value_m); }
+    
+    /// @brief Modify this move.
+    void change(int item, int value)
+    { item_m = item; value_m = value; }
+
+    /// @brief The item to change.
+    int item() const
+    { return item_m; }
+
+    /// @brief The new value.
+    int value() const
+    { return value_m; }
+
+  protected:
+    int item_m; ///< the item to change
+    int value_m; ///< the value to assign
+  };
+
+  /// @brief A mets::mana_move that flips a bit of a
+  /// mets::bitvector_problem.
+  ///
+  /// @see mets::bitvector_problem, mets::flip_tabu_list
+  class flip_bit : public mets::mana_move 
+  {
+  public:  
+
+    /// @brief A move that flips bit.
+    explicit
+    flip_bit(int bit) 
+      : bit_m(bit)
+    { }
+    
+    /// @brief The cost after the move.
+    gol_type
+    evaluate(const mets::feasible_solution& s) const
+    { const bitvector_problem& sol = 
+	static_cast<const bitvector_problem&>(s);
+      return sol.cost_function() + sol.flip_delta(bit_m); }
+    
+    /// @brief Flip the bit.
+    void
+    apply(mets::feasible_solution& s) const
+    { bitvector_problem& sol = static_cast<bitvector_problem&>(s);
+      sol.apply_flip(bit_m); }
+            
+    clonable* 
+    clone() const
+    { return new flip_bit(bit_m); }
+
+    size_t
+    hash() const
+    { return bit_m; }
+    
+    bool 
+    operator==(const mets::mana_move& o) const;
+
+    const void*
+    tag() const
+    { return &move_tag<flip_bit>::id; }
+
+    bool
+    opposite_into(mana_move& target) const
+    { static_cast<flip_bit&>(target).change(bit_m); return true; }
+
+    void
+    save(std::ostream& os) const
+    { write_binary(os, bit_m); }
+
+    void
+    load(std::istream& is)
+    { read_binary(is, bit_m); }
+    
+    /// @brief Modify this move.
+    void change(int bit)
+    { bit_m = bit; }
+
+    /// @brief The bit to flip.
+    int bit() const
+    { return bit_m; }
+
+  protected:
+    int bit_m; ///< the bit to flip
+  };
+
+  /// @brief A mets::mana_move that makes a step along a coordinate
+  /// of a mets::real_vector_problem.
+  ///
+  /// The neighborhoods evaluate their moves in batch and store the
+  /// delta in the move (see cache()): evaluate() and apply() use it
+  /// as long as the solution has not changed.
+  ///
+  /// @see mets::real_vector_problem
+  class step_coordinate : public mets::mana_move 
+  {
+  public:  
+
+    /// @brief A move that adds step to coordinate.
+    step_coordinate(int coordinate, double step) 
+      : coordinate_m(coordinate), step_m(step), delta_m(0.0), owner_m(0),
+	revision_m(0)
+    { }
+
+    step_coordinate(const step_coordinate& other)
+      : mana_move(other), coordinate_m(other.coordinate_m), 
+	step_m(other.step_m), delta_m(other.delta_m), 
+	owner_m(other.owner_m), revision_m(other.revision_m)
+    { }
+
+    step_coordinate& 
+    operator=(const step_coordinate& other)
+    { 
+      coordinate_m = other.coordinate_m; step_m = other.step_m;
+      delta_m = other.delta_m; owner_m = other.owner_m; 
+      revision_m = other.revision_m;
+      return *this;
+    }
+    
+    /// @brief The cost after the move.
+    gol_type
+    evaluate(const mets::feasible_solution& s) const
+    { const real_vector_problem& sol = 
+	static_cast<const real_vector_problem&>(s);
+      return sol.cost_function() + delta(sol); }
+    
+    /// @brief Make the step.
+    void
+    apply(mets::feasible_solution& s) const
+    { real_vector_problem& sol = static_cast<real_vector_problem&>(s);
+      sol.apply_step(coordinate_m, step_m, delta(sol)); }
+            
+    clonable* 
+    clone() const
+    { return new step_coordinate(*this); }
+
+    /// @brief The step back.
+    mana_move*
+    opposite_of() const
+    { return new step_coordinate(coordinate_m, -step_m); }
+
+    /// @brief Hashes the bits of the step (any step, negative or
+    /// huge, is hashed; 0.0 and -0.0 are equal and hash the same).
+    size_t
+    hash() const
+    { 
+      double step = step_m + 0.0;
+      unsigned long long bits;
+      std::memcpy(&bits, &step, sizeof(bits));
+      return (coordinate_m)<<16^static_cast<size_t>(bits ^ (bits >> 32)); 
+    }
+    
+    bool 
+    operator==(const mets::mana_move& o) const;
+
+    const void*
+    tag() const
+    { return &move_tag<step_coordinate>::id; }
+
+    bool
+    opposite_into(mana_move& target) const
+    { static_cast<step_coordinate&>(target).change(coordinate_m, -step_m); return true; }
+
+    void
+    save(std::ostream& os) const
+    { write_binary(os, coordinate_m); write_binary(os, step_m); }
+
+    void
+    load(std::istream& is)
+    { read_binary(is, coordinate_m); read_binary(is, step_m); owner_m = 0; }
+    
+    /// @brief Modify this move.
+    void change(int coordinate, double step)
+    { coordinate_m = coordinate; step_m = step; owner_m = 0; }
+
+    /// @brief Remember the delta of this move on sol, valid until
+    /// sol changes.
+    void cache(const real_vector_problem& sol, gol_type delta)
+    { delta_m = delta; owner_m = &sol; revision_m = sol.revision(); }
+
+    /// @brief The coordinate to change.
+    int coordinate() const
+    { return coordinate_m; }
+
+    /// @brief The step.
+    double step() const
+    { return step_m; }
+
+  protected:
+    int coordinate_m; ///< the coordinate to change
+    double step_m; ///< the step to make
+    gol_type delta_m; ///< the cached delta
+    const real_vector_problem* owner_m; ///< delta_m is valid for...
+    unsigned long revision_m; ///< ...this revision of this solution
+
+    gol_type
+    delta(const real_vector_problem& sol) const
+    { 
+      if(owner_m == &sol && revision_m == sol.revision())
+	return delta_m;
+      return sol.evaluate_step(coordinate_m, step_m);
+    }
+  };
+
+  /// @brief A neighborhood generator.
+  ///
+  /// This is a sample implementation of the neighborhood exploration
+  /// concept. You can still derive from this class and implement the
+  /// refresh method, but, since version 0.5.x you don't need to.
+  ///
+  /// To implement your own move manager you should simply adhere to
+  /// the following concept:
   ///
   /// provide an iterator, and size_type types, a begin() and end()
   /// method returning iterators to a move collection. The switch to a
   /// template based move_manager was made so that you can use any
   /// iterator type that you want. This allows, between other things,
   /// to implement intelligent iterators that dynamically return
-  /// moves.
+  /// moves (see mets::swap_lazy_neighborhood).
   ///
   /// The move manager can represent both Variable and Constant
   /// Neighborhoods.
@@ -520,160 +2013,908 @@ namespace mets {
     size_type size() const 
     { return moves_m.size(); }
 
-  protected:
-    std::deque<const move*> moves_m; ///< The moves queue
-    move_manager(const move_manager&);
+  protected:
+    std::deque<const move*> moves_m; ///< The moves queue
+    move_manager(const move_manager&);
+  };
+  
+
+  /// @brief Generates a stochastic subset of the neighborhood.
+#if defined (METSLIB_HAVE_UNORDERED_MAP) && !defined (METSLIB_TR1_MIXED_NAMESPACE)
+  template<typename random_generator = std::minstd_rand0>
+#else
+  template<typename random_generator = std::tr1::minstd_rand0>
+#endif
+  class swap_neighborhood : public mets::move_manager
+  {
+  public:
+    /// @brief A neighborhood exploration strategy for mets::swap_elements.
+    ///
+    /// This strategy selects *moves* random swaps 
+    ///
+    /// @param r a random number generator (e.g. an instance of
+    /// std::tr1::minstd_rand0 or std::tr1::mt19936)
+    ///
+    /// @param moves the number of swaps to add to the exploration
+    ///
+    swap_neighborhood(random_generator& r, 
+		      unsigned int moves);
+
+    /// @brief Dtor.
+    ~swap_neighborhood();
+
+    /// @brief Selects a different set of moves at each iteration.
+    void refresh(const mets::feasible_solution& s);
+    
+  protected:
+    random_generator& rng;
+#if defined (METSLIB_HAVE_UNORDERED_MAP) && !defined (METSLIB_TR1_MIXED_NAMESPACE)
+    mets::uniform_int<> int_range;
+#else
+    std::tr1::uniform_int<> int_range;
+#endif
+    unsigned int n;
+
+    void randomize_move(swap_elements& m, unsigned int size);
+  };
+
+  //________________________________________________________________________
+  template<typename random_generator>
+  mets::swap_neighborhood< random_generator
+			   >::swap_neighborhood(random_generator& r, 
+						unsigned int moves)
+			     : mets::move_manager(), rng(r), int_range(0), n(moves)
+  { 
+    // n simple moves
+    for(unsigned int ii = 0; ii != n; ++ii) 
+      moves_m.push_back(new swap_elements(0,0));
+  }  
+  
+  template<typename random_generator>
+  mets::swap_neighborhood<random_generator>::~swap_neighborhood()
+  {
+    // delete all moves
+    for(iterator ii = begin(); ii != end(); ++ii)
+      delete (*ii);
+  }
+
+  template<typename random_generator>
+  void
+  mets::swap_neighborhood<random_generator>::refresh(const mets::feasible_solution& s)
+  {
+    const permutation_problem& sol = 
+      static_cast<const permutation_problem&>(s);
+    iterator ii = begin();
+    
+    // the first n are simple qap_moveS (we own them, so we can
+    // modify them)
+    for(unsigned int cnt = 0; cnt != n; ++cnt)
+      {
+	swap_elements* m = 
+	  static_cast<swap_elements*>(const_cast<move*>(*ii));
+	randomize_move(*m, sol.size());
+	++ii;
+      }
+    
+  }
+  
+  template<typename random_generator>
+  void
+  mets::swap_neighborhood<random_generator
+			  >::randomize_move(swap_elements& m, unsigned int size)
+  {
+    int p1 = int_range(rng, size);
+    int p2 = int_range(rng, size);
+    while(p1 == p2) 
+      p2 = int_range(rng, size);
+    // we are friend, so we know how to handle the nuts&bolts of
+    // swap_elements
+    m.p1 = std::min(p1,p2); 
+    m.p2 = std::max(p1,p2); 
+  }
+
+  /// @brief Generates a the full swap neighborhood.
+  class swap_full_neighborhood : public mets::move_manager
+  {
+  public:
+    /// @brief A neighborhood exploration strategy for mets::swap_elements.
+    ///
+    /// This strategy selects *moves* random swaps.
+    ///
+    /// @param size the size of the problem
+    swap_full_neighborhood(int size) : move_manager()
+    {
+      for(int ii(0); ii!=size-1; ++ii)
+	for(int jj(ii+1); jj!=size; ++jj)
+	  moves_m.push_back(new swap_elements(ii,jj));
+    } 
+
+    /// @brief Dtor.
+    ~swap_full_neighborhood() { 
+      for(move_manager::iterator it = moves_m.begin(); 
+	  it != moves_m.end(); ++it)
+	delete *it;
+    }
+    
+    /// @brief Use the same set set of moves at each iteration.
+    void refresh(const mets::feasible_solution& s) { }
+    
+  };
+
+
+  /// @brief The full swap neighborhood with its moves also stored
+  /// as a structure of arrays.
+  ///
+  /// The moves are the ones of the mets::swap_full_neighborhood (so
+  /// that any search can use it), the from() and to() arrays list the
+  /// same swaps in the same order and evaluate_all() stores the delta
+  /// of each swap in deltas() with a single call to
+  /// permutation_problem::evaluate_swaps.
+  ///
+  /// @see mets::fused_swap_search
+  class swap_soa_neighborhood : public swap_full_neighborhood
+  {
+  public:
+    /// @param size the size of the problem
+    swap_soa_neighborhood(int size) 
+      : swap_full_neighborhood(size), from_m(), to_m(), 
+	deltas_m(size*(size-1)/2)
+    {
+      for(int ii(0); ii!=size-1; ++ii)
+	for(int jj(ii+1); jj!=size; ++jj)
+	  {
+	    from_m.push_back(ii);
+	    to_m.push_back(jj);
+	  }
+    }
+
+    /// @brief Evaluate all the swaps on sol.
+    void
+    evaluate_all(const permutation_problem& sol)
+    { 
+      if(!from_m.empty())
+	sol.evaluate_swaps(&from_m[0], &to_m[0], &deltas_m[0], from_m.size());
+    }
+
+    /// @brief The first position of each swap.
+    const std::vector<int>&
+    from() const
+    { return from_m; }
+
+    /// @brief The second position of each swap.
+    const std::vector<int>&
+    to() const
+    { return to_m; }
+
+    /// @brief The deltas computed by the last evaluate_all().
+    const std::vector<gol_type>&
+    deltas() const
+    { return deltas_m; }
+
+  protected:
+    std::vector<int> from_m;
+    std::vector<int> to_m;
+    std::vector<gol_type> deltas_m;
+  };
+
+  /// @brief The full swap neighborhood, generated while iterating.
+  ///
+  /// Explores the same swaps of the mets::swap_full_neighborhood, in
+  /// the same order, without storing them: the iterator keeps the
+  /// index of the swap and a mets::swap_elements it changes in place
+  /// (so a move is valid as long as the iterator it came from).
+  ///
+  /// The iterator is random access: begin() + k is computed in
+  /// constant time, so that the moves can be split in ranges (e.g. to
+  /// be explored by different threads) without building them.
+  class swap_lazy_neighborhood
+  {
+  public:
+    typedef size_t size_type;
+
+    /// @brief The result of iterator::operator[]: a copy of the
+    /// move, that converts to a pointer to it valid until the end of
+    /// the full expression.
+    class stashed_move
+    {
+    public:
+      explicit
+      stashed_move(const swap_elements& m)
+	: move_m(m)
+      { }
+
+      operator const move*() const
+      { return &move_m; }
+
+      const move*
+      operator->() const
+      { return &move_m; }
+
+    protected:
+      swap_elements move_m;
+    };
+
+    /// @brief Random access iterator over the swaps.
+    ///
+    /// The iterator stashes its move: *it returns a pointer to the
+    /// move stored inside it, valid until the iterator is changed or
+    /// destroyed, and it[k] a mets::swap_lazy_neighborhood::stashed_move
+    /// valid until the end of the full expression (it[k]->apply(s) is
+    /// fine, keeping the pointer is not). For this reason the
+    /// reference type is the pointer itself and the iterator must not
+    /// be wrapped in a std::reverse_iterator (whose operator*
+    /// dereferences a local copy): walk backward with operator--
+    /// instead.
+    class iterator
+    {
+    public:
+      typedef std::random_access_iterator_tag iterator_category;
+      typedef const move* value_type;
+      typedef std::ptrdiff_t difference_type;
+      typedef const move* const* pointer;
+      typedef const move* reference;
+
+      iterator()
+	: n_m(0), index_m(0), move_m(0, 1)
+      { }
+
+      reference
+      operator*() const
+      { return &move_m; }
+
+      /// @brief The move k positions ahead (see the class
+      /// documentation for how long it lives).
+      stashed_move
+      operator[](difference_type k) const
+      { return stashed_move((*this + k).move_m); }
+
+      iterator&
+      operator++()
+      {
+	int i = move_m.first();
+	int j = move_m.second() + 1;
+	if(j == n_m)
+	  {
+	    ++i;
+	    j = i + 1;
+	  }
+	move_m.change(i, j);
+	++index_m;
+	return *this;
+      }
+
+      iterator
+      operator++(int)
+      { iterator tmp(*this); ++(*this); return tmp; }
+
+      iterator&
+      operator--()
+      {
+	int i = move_m.first();
+	int j = move_m.second() - 1;
+	if(j == i)
+	  {
+	    --i;
+	    j = n_m - 1;
+	  }
+	move_m.change(i, j);
+	--index_m;
+	return *this;
+      }
+
+      iterator
+      operator--(int)
+      { iterator tmp(*this); --(*this); return tmp; }
+
+      iterator&
+      operator+=(difference_type k)
+      { seek(index_m + k); return *this; }
+
+      iterator&
+      operator-=(difference_type k)
+      { seek(index_m - k); return *this; }
+
+      iterator
+      operator+(difference_type k) const
+      { iterator tmp(*this); tmp += k; return tmp; }
+
+      iterator
+      operator-(difference_type k) const
+      { iterator tmp(*this); tmp -= k; return tmp; }
+
+      difference_type
+      operator-(const iterator& other) const
+      { return difference_type(index_m) - difference_type(other.index_m); }
+
+      bool
+      operator==(const iterator& other) const
+      { return index_m == other.index_m; }
+
+      bool
+      operator!=(const iterator& other) const
+      { return index_m != other.index_m; }
+
+      bool
+      operator<(const iterator& other) const
+      { return index_m < other.index_m; }
+
+      bool
+      operator>(const iterator& other) const
+      { return index_m > other.index_m; }
+
+      bool
+      operator<=(const iterator& other) const
+      { return index_m <= other.index_m; }
+
+      bool
+      operator>=(const iterator& other) const
+      { return index_m >= other.index_m; }
+
+      friend iterator
+      operator+(difference_type k, const iterator& it)
+      { return it + k; }
+
+      /// @brief The index of the current swap.
+      size_type
+      index() const
+      { return index_m; }
+
+    protected:
+      int n_m;
+      size_type index_m;
+      swap_elements move_m;
+
+      /// @brief Position on the k-th swap (the swaps of the first
+      /// position i start at i*(2n-i-1)/2).
+      void
+      seek(size_type k)
+      {
+	const double b = 2.0 * n_m - 1.0;
+	double r = std::floor((b - std::sqrt(b*b - 8.0*k)) / 2.0);
+	size_type i = r > 0.0 ? size_type(r) : 0;
+	// correct the rounding of the square root
+	while(i > 0 && start(i) > k)
+	  --i;
+	while(i + 1 < size_type(n_m) && start(i + 1) <= k)
+	  ++i;
+	move_m.change(int(i), int(i + 1 + (k - start(i))));
+	index_m = k;
+      }
+
+      size_type
+      start(size_type i) const
+      { return i * (2 * size_type(n_m) - i - 1) / 2; }
+
+      friend class swap_lazy_neighborhood;
+    };
+
+    /// @param size the size of the problem
+    swap_lazy_neighborhood(int size)
+      : n_m(size)
+    { }
+
+    /// @brief Use the same set of moves at each iteration.
+    void
+    refresh(const mets::feasible_solution&)
+    { }
+
+    /// @brief The first swap.
+    iterator
+    begin() const
+    { return at(0); }
+
+    /// @brief The end of the swaps.
+    iterator
+    end() const
+    { return at(size()); }
+
+    /// @brief The k-th swap, in constant time.
+    iterator
+    at(size_type k) const
+    { iterator it; it.n_m = n_m; it.seek(k); return it; }
+
+    /// @brief The number of swaps, n(n-1)/2.
+    size_type
+    size() const
+    { return n_m > 1 ? size_type(n_m) * (n_m - 1) / 2 : 0; }
+
+  protected:
+    int n_m;
+  };
+
+  /// @brief Generates a the full subsequence inversion neighborhood.
+  class invert_full_neighborhood : public mets::move_manager
+  {
+  public:
+    invert_full_neighborhood(int size) : move_manager()
+    {
+      for(int ii(0); ii!=size; ++ii)
+	for(int jj(0); jj!=size; ++jj)
+	  if(ii != jj)
+	    moves_m.push_back(new invert_subsequence(ii,jj));
+    } 
+
+    /// @brief Dtor.
+    ~invert_full_neighborhood() { 
+      for(std::deque<const move*>::iterator it = moves_m.begin(); 
+	  it != moves_m.end(); ++it)
+	delete *it;
+    }
+
+    /// @brief This is a static neighborhood
+    void 
+    refresh(const mets::feasible_solution& s) 
+    { }
+
+  };
+
+  /// @brief Generates the full mets::change_value neighborhood.
+  ///
+  /// At each refresh the moves are changed to assign each item each
+  /// of the values it does not have: the neighborhood has n*(k-1)
+  /// moves.
+  class change_value_full_neighborhood : public mets::move_manager
+  {
+  public:
+    /// @param n The number of items.
+    /// @param k The number of values.
+    change_value_full_neighborhood(int n, int k) : move_manager()
+    {
+      for(int ii(0); ii!=n*(k-1); ++ii)
+	moves_m.push_back(new change_value(0, 0));
+    } 
+
+    /// @brief Dtor.
+    ~change_value_full_neighborhood() { 
+      for(move_manager::iterator it = moves_m.begin(); 
+	  it != moves_m.end(); ++it)
+	delete *it;
+    }
+    
+    /// @brief Skip the current value of each item.
+    void refresh(const mets::feasible_solution& s)
+    {
+      const assignment_problem& sol = 
+	static_cast<const assignment_problem&>(s);
+      const std::vector<int>& values = sol.values();
+      const int k = sol.domain();
+      iterator it = begin();
+      for(unsigned int ii = 0; ii != values.size(); ++ii)
+	for(int v = 0; v != k; ++v)
+	  if(v != values[ii])
+	    static_cast<change_value*>(const_cast<move*>(*it++))
+	      ->change(ii, v);
+    }
   };
-  
 
-  /// @brief Generates a stochastic subset of the neighborhood.
+  /// @brief Generates a stochastic subset of the mets::change_value
+  /// neighborhood.
 #if defined (METSLIB_HAVE_UNORDERED_MAP) && !defined (METSLIB_TR1_MIXED_NAMESPACE)
   template<typename random_generator = std::minstd_rand0>
 #else
   template<typename random_generator = std::tr1::minstd_rand0>
 #endif
-  class swap_neighborhood : public mets::move_manager
+  class change_value_neighborhood : public mets::move_manager
   {
   public:
-    /// @brief A neighborhood exploration strategy for mets::swap_elements.
-    ///
-    /// This strategy selects *moves* random swaps 
+    /// @brief Selects moves random assignments, each one changing
+    /// the value of the item.
     ///
     /// @param r a random number generator (e.g. an instance of
     /// std::tr1::minstd_rand0 or std::tr1::mt19936)
     ///
-    /// @param moves the number of swaps to add to the exploration
-    ///
-    swap_neighborhood(random_generator& r, 
-		      unsigned int moves);
+    /// @param moves the number of moves to add to the exploration
+    change_value_neighborhood(random_generator& r, unsigned int moves)
+      : move_manager(), rng(r), int_range(0), n(moves)
+    {
+      for(unsigned int ii = 0; ii != n; ++ii) 
+	moves_m.push_back(new change_value(0, 0));
+    }
 
     /// @brief Dtor.
-    ~swap_neighborhood();
+    ~change_value_neighborhood()
+    {
+      for(iterator ii = begin(); ii != end(); ++ii)
+	delete (*ii);
+    }
 
     /// @brief Selects a different set of moves at each iteration.
-    void refresh(const mets::feasible_solution& s);
+    void refresh(const mets::feasible_solution& s)
+    {
+      const assignment_problem& sol = 
+	static_cast<const assignment_problem&>(s);
+      const std::vector<int>& values = sol.values();
+      assert(sol.domain() > 1);
+      for(iterator ii = begin(); ii != end(); ++ii)
+	{
+	  int item = int_range(rng, sol.size());
+	  // a value different from the current one
+	  int value = int_range(rng, sol.domain() - 1);
+	  if(value >= values[item]) ++value;
+	  static_cast<change_value*>(const_cast<move*>(*ii))
+	    ->change(item, value);
+	}
+    }
     
   protected:
     random_generator& rng;
 #if defined (METSLIB_HAVE_UNORDERED_MAP) && !defined (METSLIB_TR1_MIXED_NAMESPACE)
-    std::uniform_int<> int_range;
+    mets::uniform_int<> int_range;
 #else
     std::tr1::uniform_int<> int_range;
 #endif
     unsigned int n;
-
-    void randomize_move(swap_elements& m, unsigned int size);
   };
 
-  //________________________________________________________________________
-  template<typename random_generator>
-  mets::swap_neighborhood< random_generator
-			   >::swap_neighborhood(random_generator& r, 
-						unsigned int moves)
-			     : mets::move_manager(), rng(r), int_range(0), n(moves)
-  { 
-    // n simple moves
-    for(unsigned int ii = 0; ii != n; ++ii) 
-      moves_m.push_back(new swap_elements(0,0));
-  }  
-  
-  template<typename random_generator>
-  mets::swap_neighborhood<random_generator>::~swap_neighborhood()
-  {
-    // delete all moves
-    for(iterator ii = begin(); ii != end(); ++ii)
-      delete (*ii);
-  }
-
-  template<typename random_generator>
-  void
-  mets::swap_neighborhood<random_generator>::refresh(const mets::feasible_solution& s)
-  {
-    permutation_problem& sol = dynamic_cast<permutation_problem&>(s);
-    iterator ii = begin();
-    
-    // the first n are simple qap_moveS
-    for(unsigned int cnt = 0; cnt != n; ++cnt)
-      {
-	swap_elements* m = static_cast<swap_elements*>(*ii);
-	randomize_move(*m, sol.size());
-	++ii;
-      }
-    
-  }
-  
-  template<typename random_generator>
-  void
-  mets::swap_neighborhood<random_generator
-			  >::randomize_move(swap_elements& m, unsigned int size)
-  {
-    int p1 = int_range(rng, size);
-    int p2 = int_range(rng, size);
-    while(p1 == p2) 
-      p2 = int_range(rng, size);
-    // we are friend, so we know how to handle the nuts&bolts of
-    // swap_elements
-    m.p1 = std::min(p1,p2); 
-    m.p2 = std::max(p1,p2); 
-  }
-
-  /// @brief Generates a the full swap neighborhood.
-  class swap_full_neighborhood : public mets::move_manager
+  /// @brief Generates the full mets::flip_bit neighborhood.
+  class flip_full_neighborhood : public mets::move_manager
   {
   public:
-    /// @brief A neighborhood exploration strategy for mets::swap_elements.
-    ///
-    /// This strategy selects *moves* random swaps.
-    ///
-    /// @param size the size of the problem
-    swap_full_neighborhood(int size) : move_manager()
+    /// @param size the number of bits
+    flip_full_neighborhood(int size) : move_manager()
     {
-      for(int ii(0); ii!=size-1; ++ii)
-	for(int jj(ii+1); jj!=size; ++jj)
-	  moves_m.push_back(new swap_elements(ii,jj));
+      for(int ii(0); ii!=size; ++ii)
+	moves_m.push_back(new flip_bit(ii));
     } 
 
     /// @brief Dtor.
-    ~swap_full_neighborhood() { 
+    ~flip_full_neighborhood() { 
       for(move_manager::iterator it = moves_m.begin(); 
 	  it != moves_m.end(); ++it)
 	delete *it;
     }
     
     /// @brief Use the same set set of moves at each iteration.
-    void refresh(const mets::feasible_solution& s) { }
-    
+    void refresh(const mets::feasible_solution&) { }
   };
 
-
-  /// @brief Generates a the full subsequence inversion neighborhood.
-  class invert_full_neighborhood : public mets::move_manager
+  /// @brief Base class of the mets::step_coordinate neighborhoods.
+  ///
+  /// The subclasses choose the coordinates and the steps (in
+  /// coordinates_m and steps_m) then call evaluate_all() that
+  /// evaluates them with a single real_vector_problem::evaluate_steps
+  /// call and updates the moves.
+  class step_neighborhood : public mets::move_manager
   {
   public:
-    invert_full_neighborhood(int size) : move_manager()
+    /// @param moves The number of moves.
+    step_neighborhood(int moves) 
+      : move_manager(), coordinates_m(moves), steps_m(moves, 0.0),
+	deltas_m(moves)
     {
-      for(int ii(0); ii!=size; ++ii)
-	for(int jj(0); jj!=size; ++jj)
-	  if(ii != jj)
-	    moves_m.push_back(new invert_subsequence(ii,jj));
+      for(int ii(0); ii!=moves; ++ii)
+	moves_m.push_back(new step_coordinate(0, 0.0));
     } 
 
     /// @brief Dtor.
-    ~invert_full_neighborhood() { 
-      for(std::deque<const move*>::iterator it = moves_m.begin(); 
+    ~step_neighborhood() { 
+      for(move_manager::iterator it = moves_m.begin(); 
 	  it != moves_m.end(); ++it)
 	delete *it;
     }
 
-    /// @brief This is a static neighborhood
-    void 
-    refresh(const mets::feasible_solution& s) 
+  protected:
+    std::vector<int> coordinates_m;
+    real_vector_problem::vector_type steps_m;
+    std::vector<gol_type> deltas_m;
+
+    void
+    evaluate_all(const real_vector_problem& sol)
+    {
+      const size_t count = moves_m.size();
+      if(count)
+	sol.evaluate_steps(&coordinates_m[0], &steps_m[0], &deltas_m[0], 
+			   count);
+      for(size_t ii = 0; ii != count; ++ii)
+	{
+	  step_coordinate* m = 
+	    static_cast<step_coordinate*>(const_cast<move*>(moves_m[ii]));
+	  m->change(coordinates_m[ii], steps_m[ii]);
+	  m->cache(sol, deltas_m[ii]);
+	}
+    }
+  };
+
+  /// @brief Generates the 2n moves that step forward and backward
+  /// along each coordinate (a compass search).
+  class coordinate_step_neighborhood : public step_neighborhood
+  {
+  public:
+    /// @param size the dimension of the problem
+    /// @param step the length of the steps
+    coordinate_step_neighborhood(int size, double step) 
+      : step_neighborhood(2 * size)
+    {
+      for(int ii(0); ii!=size; ++ii)
+	coordinates_m[2*ii] = coordinates_m[2*ii+1] = ii;
+      this->step(step);
+    } 
+
+    /// @brief Change the length of the steps (e.g. to shrink them
+    /// when no step improves).
+    void step(double step)
+    { 
+      for(size_t ii = 0; ii != steps_m.size(); ii += 2)
+	{ steps_m[ii] = step; steps_m[ii+1] = -step; }
+    }
+
+    /// @brief The length of the steps.
+    double step() const
+    { return steps_m.empty() ? 0.0 : steps_m[0]; }
+
+    void refresh(const mets::feasible_solution& s)
+    { evaluate_all(static_cast<const real_vector_problem&>(s)); }
+  };
+
+  /// @brief Generates random steps with a normal distribution along
+  /// random coordinates.
+#if defined (METSLIB_HAVE_UNORDERED_MAP) && !defined (METSLIB_TR1_MIXED_NAMESPACE)
+  template<typename random_generator = std::minstd_rand0>
+#else
+  template<typename random_generator = std::tr1::minstd_rand0>
+#endif
+  class gaussian_step_neighborhood : public step_neighborhood
+  {
+  public:
+    /// @param r a random number generator (e.g. an instance of
+    /// std::tr1::minstd_rand0 or std::tr1::mt19936)
+    /// @param moves the number of steps to add to the exploration
+    /// @param sigma the standard deviation of the steps
+    gaussian_step_neighborhood(random_generator& r, unsigned int moves, 
+			       double sigma)
+      : step_neighborhood(moves), int_range(0), normal(0.0, 1.0), 
+	gen(r, normal), rng(r), sigma_m(sigma)
+    { }
+
+    /// @brief Change the standard deviation of the steps.
+    void sigma(double s)
+    { sigma_m = s; }
+
+    /// @brief The standard deviation of the steps.
+    double sigma() const
+    { return sigma_m; }
+
+    void refresh(const mets::feasible_solution& s)
+    {
+      const real_vector_problem& sol = 
+	static_cast<const real_vector_problem&>(s);
+      for(size_t ii = 0; ii != steps_m.size(); ++ii)
+	{
+	  coordinates_m[ii] = int_range(rng, sol.size());
+	  steps_m[ii] = sigma_m * gen();
+	}
+      evaluate_all(sol);
+    }
+
+  protected:
+#if defined (METSLIB_HAVE_UNORDERED_MAP) && !defined (METSLIB_TR1_MIXED_NAMESPACE)
+    mets::uniform_int<> int_range;
+    std::normal_distribution<double> normal;
+    mets::variate_generator<random_generator&, 
+			    std::normal_distribution<double> > gen;
+#else
+    std::tr1::uniform_int<> int_range;
+    std::tr1::normal_distribution<double> normal;
+    std::tr1::variate_generator<random_generator&, 
+				std::tr1::normal_distribution<double> > gen;
+#endif
+    random_generator& rng;
+    double sigma_m;
+  };
+
+  /// @brief A neighborhood made of the union of other neighborhoods.
+  ///
+  /// The iterator walks the moves of the child neighborhoods in
+  /// sequence, so that moves of different types (e.g. swaps and
+  /// inversions) can be explored in the same iteration without
+  /// copying the moves into a new queue.
+  ///
+  /// Each child can be sampled: with a weight w < 1 only a window of
+  /// ceil(w * size) consecutive moves, starting at a random position,
+  /// is explored at each refresh.
+  ///
+  /// The children must be of the move_manager_type type (the default
+  /// allows to mix any mets::move_manager subclass, a
+  /// mets::swap_lazy_neighborhood can be used too), their iterators
+  /// must support it + k: the union iterator keeps an iterator of the
+  /// current child, so that the moves of a child that stashes them in
+  /// its iterators live as long as the union iterator.
+#if defined (METSLIB_HAVE_UNORDERED_MAP) && !defined (METSLIB_TR1_MIXED_NAMESPACE)
+  template<typename random_generator = std::minstd_rand0,
+	   typename move_manager_type = mets::move_manager>
+#else
+  template<typename random_generator = std::tr1::minstd_rand0,
+	   typename move_manager_type = mets::move_manager>
+#endif
+  class union_neighborhood
+  {
+  public:
+    typedef union_neighborhood<random_generator, move_manager_type> self_type;
+    typedef typename move_manager_type::size_type size_type;
+    typedef typename move_manager_type::iterator child_iterator;
+
+    /// @brief Forward iterator over the moves of the children.
+    class iterator
+    {
+    public:
+      typedef std::forward_iterator_tag iterator_category;
+      typedef const move* value_type;
+      typedef std::ptrdiff_t difference_type;
+      typedef const move* const* pointer;
+      typedef typename std::iterator_traits<child_iterator>::reference
+      reference;
+
+      iterator() 
+	: owner_m(0), child_m(0), index_m(0), left_m(0), it_m()
+      { }
+
+      iterator(const iterator& other)
+	: owner_m(other.owner_m), child_m(other.child_m), 
+	  index_m(other.index_m), left_m(other.left_m), it_m(other.it_m)
+      { }
+
+      iterator&
+      operator=(const iterator& other)
+      {
+	owner_m = other.owner_m;
+	child_m = other.child_m;
+	index_m = other.index_m;
+	left_m = other.left_m;
+	it_m = other.it_m;
+	return *this;
+      }
+
+      reference
+      operator*() const
+      { return *it_m; }
+
+      iterator&
+      operator++()
+      {
+	--left_m;
+	++it_m;
+	if(++index_m == owner_m->children_m[child_m]->size())
+	  {
+	    index_m = 0;
+	    it_m = owner_m->children_m[child_m]->begin();
+	  }
+	if(!left_m)
+	  owner_m->first_window(*this, child_m + 1);
+	return *this;
+      }
+
+      iterator
+      operator++(int)
+      { iterator tmp(*this); ++(*this); return tmp; }
+
+      bool
+      operator==(const iterator& other) const
+      { return child_m == other.child_m && left_m == other.left_m; }
+
+      bool
+      operator!=(const iterator& other) const
+      { return !(*this == other); }
+
+    protected:
+      self_type* owner_m;
+      unsigned int child_m;
+      size_type index_m;
+      size_type left_m;
+      child_iterator it_m;
+      friend class union_neighborhood<random_generator, move_manager_type>;
+    };
+
+    /// @brief An empty union (only children with weight 1 can be
+    /// added).
+    union_neighborhood()
+      : rng_m(0), int_range(0), children_m(), weights_m(), 
+	start_m(), count_m()
     { }
 
+    /// @brief An empty union.
+    ///
+    /// @param r a random number generator (e.g. an instance of
+    /// std::tr1::minstd_rand0 or std::tr1::mt19936) used to sample
+    /// the children with a weight lower than 1.
+    explicit
+    union_neighborhood(random_generator& r)
+      : rng_m(&r), int_range(0), children_m(), weights_m(), 
+	start_m(), count_m()
+    { }
+
+    /// purposely not implemented (see Effective C++)
+    union_neighborhood(const union_neighborhood&);
+    union_neighborhood& operator=(const union_neighborhood&);
+
+    /// @brief Add a child neighborhood.
+    ///
+    /// @param child The neighborhood to add (not copied, must outlive
+    /// the union)
+    /// @param weight The fraction of moves of the child explored at
+    /// each refresh.
+    void
+    add(move_manager_type& child, double weight = 1.0)
+    { 
+      assert(weight > 0.0 && (weight >= 1.0 || rng_m));
+      children_m.push_back(&child); 
+      weights_m.push_back(std::min(weight, 1.0));
+      start_m.push_back(0);
+      count_m.push_back(child.size());
+    }
+
+    /// @brief Refresh the children and select the windows to explore.
+    void
+    refresh(const mets::feasible_solution& s);
+
+    /// @brief Begin iterator of the moves to explore.
+    iterator
+    begin()
+    { iterator it; it.owner_m = this; first_window(it, 0); return it; }
+
+    /// @brief End iterator of the moves to explore.
+    iterator
+    end()
+    { iterator it; it.owner_m = this; it.child_m = children_m.size(); 
+      return it; }
+
+    /// @brief The number of moves to explore.
+    size_type
+    size() const
+    { return std::accumulate(count_m.begin(), count_m.end(), size_type(0)); }
+
+  protected:
+    random_generator* rng_m;
+#if defined (METSLIB_HAVE_UNORDERED_MAP) && !defined (METSLIB_TR1_MIXED_NAMESPACE)
+    mets::uniform_int<size_type> int_range;
+#else
+    std::tr1::uniform_int<size_type> int_range;
+#endif
+    std::vector<move_manager_type*> children_m;
+    std::vector<double> weights_m;
+    std::vector<size_type> start_m;
+    std::vector<size_type> count_m;
+
+    /// @brief Position it on the window of the first non empty child
+    /// starting from child.
+    void
+    first_window(iterator& it, unsigned int child) const
+    {
+      while(child != children_m.size() && count_m[child] == 0)
+	++child;
+      it.child_m = child;
+      it.index_m = child != children_m.size() ? start_m[child] : 0;
+      it.left_m = child != children_m.size() ? count_m[child] : 0;
+      if(child != children_m.size())
+	it.it_m = children_m[child]->begin() + start_m[child];
+    }
   };
 
   /// @}
 
+  //________________________________________________________________________
+  template<typename random_generator, typename move_manager_type>
+  void
+  union_neighborhood<random_generator, 
+		     move_manager_type>::refresh(const mets::feasible_solution& s)
+  {
+    for(unsigned int ii = 0; ii != children_m.size(); ++ii)
+      {
+	children_m[ii]->refresh(s);
+	size_type size = children_m[ii]->size();
+	if(weights_m[ii] >= 1.0 || size == 0)
+	  {
+	    start_m[ii] = 0;
+	    count_m[ii] = size;
+	  }
+	else
+	  {
+	    start_m[ii] = int_range(*rng_m, size);
+	    count_m[ii] = std::min(size, static_cast<size_type>
+				   (std::ceil(weights_m[ii] * size)));
+	  }
+      }
+  }
+
   /// @brief Functor class to allow hash_set of moves (used by tabu list)
   class mana_move_hash 
   {
@@ -697,22 +2938,99 @@ inline void
 mets::permutation_problem::copy_from(const mets::copyable& other)
 {
   const mets::permutation_problem& o = 
-    dynamic_cast<const mets::permutation_problem&>(other);
+    static_cast<const mets::permutation_problem&>(other);
   pi_m = o.pi_m;
   cost_m = o.cost_m;
+  if(zobrist_m == o.zobrist_m)
+    fingerprint_m = o.fingerprint_m;
+  else
+    update_fingerprint();
+  if(journal_m) 
+    journal_m->invalidate();
 }
 
 //________________________________________________________________________
 inline bool
 mets::swap_elements::operator==(const mets::mana_move& o) const
 {
-  try {
-    const mets::swap_elements& other = 
-      dynamic_cast<const mets::swap_elements&>(o);
-    return (this->p1 == other.p1 && this->p2 == other.p2);
-  } catch (std::bad_cast& e) {
+  if(o.tag() != tag())
     return false;
-  }
+  const mets::swap_elements& other = 
+    static_cast<const mets::swap_elements&>(o);
+  return (this->p1 == other.p1 && this->p2 == other.p2);
+}
+
+//________________________________________________________________________
+inline void
+mets::real_vector_problem::copy_from(const mets::copyable& other)
+{
+  const mets::real_vector_problem& o = 
+    static_cast<const mets::real_vector_problem&>(other);
+  x_m = o.x_m;
+  cost_m = o.cost_m;
+  ++revision_m;
+}
+
+//________________________________________________________________________
+inline bool
+mets::step_coordinate::operator==(const mets::mana_move& o) const
+{
+  if(o.tag() != tag())
+    return false;
+  const mets::step_coordinate& other = 
+    static_cast<const mets::step_coordinate&>(o);
+  return (this->coordinate_m == other.coordinate_m 
+	    && this->step_m == other.step_m);
+}
+
+//________________________________________________________________________
+inline void
+mets::bitvector_problem::copy_from(const mets::copyable& other)
+{
+  const mets::bitvector_problem& o = 
+    static_cast<const mets::bitvector_problem&>(other);
+  words_m = o.words_m;
+  n_m = o.n_m;
+  cost_m = o.cost_m;
+  if(cached_m)
+    {
+      if(o.cached_m)
+	deltas_m = o.deltas_m;
+      else
+	refresh_deltas();
+    }
+}
+
+//________________________________________________________________________
+inline bool
+mets::flip_bit::operator==(const mets::mana_move& o) const
+{
+  if(o.tag() != tag())
+    return false;
+  const mets::flip_bit& other = static_cast<const mets::flip_bit&>(o);
+  return this->bit_m == other.bit_m;
+}
+
+//________________________________________________________________________
+inline void
+mets::assignment_problem::copy_from(const mets::copyable& other)
+{
+  const mets::assignment_problem& o = 
+    static_cast<const mets::assignment_problem&>(other);
+  values_m = o.values_m;
+  domain_m = o.domain_m;
+  cost_m = o.cost_m;
+}
+
+//________________________________________________________________________
+inline bool
+mets::change_value::operator==(const mets::mana_move& o) const
+{
+  if(o.tag() != tag())
+    return false;
+  const mets::change_value& other = 
+    static_cast<const mets::change_value&>(o);
+  return (this->item_m == other.item_m && this->value_m == other.value_m);
 }
 
 //________________________________________________________________________
@@ -750,19 +3068,34 @@ mets::invert_subsequence::evaluate(const mets::feasible_solution& s) const
       assert(to >= 0 && to < size);
       eval += sol.evaluate_swap(from, to); 
     }
-  return eval;
+  return sol.cost_function() + eval;
+}
+
+inline size_t
+mets::invert_subsequence::fingerprint(const mets::permutation_problem& sol) const
+{ 
+  // the swaps of an inversion involve distinct positions, so each one
+  // contributes to the fingerprint independently of the others
+  int size = sol.size();
+  int top = p1 < p2 ? (p2-p1+1) : (size+p2-p1+1);
+  size_t fp = sol.fingerprint();
+  for(int ii(0); ii!=top/2; ++ii)
+    {
+      int from = (p1+ii)%size;
+      int to = (size+p2-ii)%size;
+      fp ^= sol.fingerprint() ^ sol.fingerprint_after_swap(from, to);
+    }
+  return fp;
 }
 
 inline bool
 mets::invert_subsequence::operator==(const mets::mana_move& o) const
 {
-  try {
-    const mets::invert_subsequence& other = 
-      dynamic_cast<const mets::invert_subsequence&>(o);
-    return (this->p1 == other.p1 && this->p2 == other.p2);
-  } catch (std::bad_cast& e) {
+  if(o.tag() != tag())
     return false;
-  }
+  const mets::invert_subsequence& other = 
+    static_cast<const mets::invert_subsequence&>(o);
+  return (this->p1 == other.p1 && this->p2 == other.p2);
 }
 
 #endif
@@ -0,0 +1,785 @@
+// METSlib source file - multi-objective.hh                      -*- C++ -*-
+//
+// Copyright (C) 2006-2010 Mirko Maischberger <mirko.maischberger@gmail.com>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//   You should have received a copy of the GNU General Public License
+//   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// This program can be distributed, at your option, under the terms of
+// the CPL 1.0 as published by the Open Source Initiative
+// http://www.opensource.org/licenses/cpl1.0.php
+
+#ifndef METS_MULTI_OBJECTIVE_HH_
+#define METS_MULTI_OBJECTIVE_HH_
+
+namespace mets {
+
+  /// @defgroup multi_objective Multi-objective
+  /// @{
+
+  /// @brief A vector of objectives (all to be minimized).
+  typedef std::vector<gol_type> objective_vector;
+
+  /// @brief A solution with many objectives.
+  ///
+  /// The searches still minimize the scalar cost_function(): make it
+  /// a scalarization of the objectives (e.g. with a
+  /// mets::weighted_sum) and run a search for each weight vector,
+  /// recording the solutions in a mets::pareto_archive.
+  ///
+  /// The archive reaches this interface through
+  /// feasible_solution::multi_objective(): override it in your
+  /// solution to return this.
+  class multi_objective_solution
+  {
+  public:
+    virtual
+    ~multi_objective_solution()
+    { }
+
+    /// @brief The number of objectives.
+    virtual size_t
+    objectives() const = 0;
+
+    /// @brief Store the objectives in f (objectives() values).
+    virtual void
+    objective_values(gol_type* f) const = 0;
+  };
+
+  /// @brief True if a dominates b (a is no worse than b in all the m
+  /// objectives and better in at least one).
+  inline bool
+  dominates(const gol_type* a, const gol_type* b, size_t m) METSLIB_NOEXCEPT
+  {
+    bool better = false;
+    for(size_t ii = 0; ii != m; ++ii)
+      {
+	if(a[ii] > b[ii]) return false;
+	better = better || a[ii] < b[ii];
+      }
+    return better;
+  }
+
+  /// @brief Weighted sum scalarization.
+  class weighted_sum
+  {
+  public:
+    /// @param weights The weight of each objective.
+    explicit
+    weighted_sum(const objective_vector& weights)
+      : weights_m(weights)
+    { }
+
+    /// @brief The scalar cost of the objectives f.
+    gol_type
+    operator()(const gol_type* f) const
+    {
+      gol_type c = 0.0;
+      for(size_t ii = 0; ii != weights_m.size(); ++ii)
+	c += weights_m[ii] * f[ii];
+      return c;
+    }
+
+    /// @brief The change of the scalar cost due to a change df of
+    /// the objectives (the sum is linear).
+    gol_type
+    delta(const gol_type* df) const
+    { return (*this)(df); }
+
+    const objective_vector&
+    weights() const
+    { return weights_m; }
+
+  protected:
+    objective_vector weights_m;
+  };
+
+  /// @brief Weighted Chebyshev scalarization: max_i w_i (f_i - z_i)
+  /// for a reference (ideal) point z.
+  ///
+  /// Unlike the weighted sum it can reach the non convex parts of
+  /// the Pareto front.
+  class chebyshev
+  {
+  public:
+    /// @param weights The weight of each objective.
+    /// @param ideal The reference point.
+    chebyshev(const objective_vector& weights, const objective_vector& ideal)
+      : weights_m(weights), ideal_m(ideal)
+    { }
+
+    /// @brief The scalar cost of the objectives f.
+    gol_type
+    operator()(const gol_type* f) const
+    {
+      gol_type c = -std::numeric_limits<gol_type>::max();
+      for(size_t ii = 0; ii != weights_m.size(); ++ii)
+	c = std::max(c, weights_m[ii] * (f[ii] - ideal_m[ii]));
+      return c;
+    }
+
+    /// @brief The change of the scalar cost moving from f to g.
+    gol_type
+    delta(const gol_type* f, const gol_type* g) const
+    { return (*this)(g) - (*this)(f); }
+
+    const objective_vector&
+    weights() const
+    { return weights_m; }
+
+  protected:
+    objective_vector weights_m;
+    objective_vector ideal_m;
+  };
+
+  /// @brief Weight vectors evenly spread on the simplex (the sum of
+  /// each vector is 1, each weight is a multiple of 1/divisions).
+  ///
+  /// There are C(divisions + m - 1, m - 1) vectors (divisions + 1 for
+  /// two objectives).
+  std::vector<objective_vector>
+  simplex_weights(size_t m, unsigned int divisions);
+
+  /// @brief A recorder keeping the non dominated solutions.
+  ///
+  /// Like the mets::elite_pool the archive copies the solutions in
+  /// slots provided by the user (see add_slot()). The accepted
+  /// solutions must be mets::multi_objective_solution instances.
+  ///
+  /// With two objectives the archive is kept sorted on the first
+  /// objective (the second one is then decreasing) in a treap whose
+  /// nodes are the slots, and the solutions are kept in a heap on
+  /// their crowding distance. An insertion, including the eviction
+  /// from a full archive, costs O(log N) (expected) plus the
+  /// dominated solutions removed, and allocates no memory.
+  ///
+  /// With more objectives there is no such structure (e.g. an
+  /// ND-tree) yet: each insertion scans the archive, with O(N)
+  /// dominance tests and O(N) distances when the archive is full.
+  /// Keep these archives small.
+  ///
+  /// When all the slots are used a new non dominated solution
+  /// replaces the most crowded one: with two objectives the inner
+  /// solution with the nearest neighbors (the extremes are kept),
+  /// with more objectives the solution nearest to the new one.
+  class pareto_archive : public solution_recorder
+  {
+  public:
+    /// @brief Ctor.
+    ///
+    /// @param objectives The number of objectives.
+    explicit
+    pareto_archive(size_t objectives)
+      : solution_recorder(), m_m(objectives), slots_m(), values_m(),
+	free_m(), nodes_m(), root_m(none), head_m(none), heap_m(), 
+	seed_m(2463534242u), members_m(), order_m(), sorted_m(true),
+	scratch_m(objectives), best_m(std::numeric_limits<gol_type>::max())
+    { }
+
+    /// @brief Unimplemented copy ctor.
+    pareto_archive(const pareto_archive&);
+    /// @brief Unimplemented assignment operator.
+    pareto_archive& operator=(const pareto_archive&);
+
+    /// @brief Adds a slot to the archive.
+    ///
+    /// @param slot An instance of the solution type (will be
+    /// modified, must outlive the archive).
+    void
+    add_slot(copyable& slot);
+
+    /// @brief Record sol if it is not dominated.
+    ///
+    /// @return True if sol entered the archive.
+    bool
+    accept(const feasible_solution& sol);
+
+    /// @brief The lowest cost_function() of the accepted solutions.
+    gol_type
+    best_cost() const
+    { return best_m; }
+
+    /// @brief Copy the non dominated solutions of another archive
+    /// (e.g. filled by a search on another thread).
+    void
+    merge(const pareto_archive& other);
+
+    /// @brief The number of objectives.
+    size_t
+    objectives() const
+    { return m_m; }
+
+    /// @brief The solutions in the archive.
+    size_t
+    size() const
+    { return m_m == 2 ? heap_m.size() : members_m.size(); }
+
+    /// @brief The number of slots.
+    size_t
+    capacity() const
+    { return slots_m.size(); }
+
+    /// @brief The i-th solution (in lexicographic order of the
+    /// objectives).
+    const copyable&
+    operator[](size_t i) const
+    { return *slots_m[order()[i]]; }
+
+    /// @brief The k-th objective of the i-th solution.
+    gol_type
+    objective(size_t i, size_t k) const
+    { return values_m[order()[i] * m_m + k]; }
+
+    /// @brief Forget all the solutions.
+    void
+    clear();
+
+  protected:
+    size_t m_m;
+    std::vector<copyable*> slots_m;
+    /// the objectives of the solution in each slot
+    std::vector<gol_type> values_m;
+    std::vector<size_t> free_m;
+
+    static const size_t none = static_cast<size_t>(-1);
+
+    /// @brief A solution of the front (two objectives), one for
+    /// each slot.
+    struct node
+    {
+      size_t left;  ///< the treap children
+      size_t right;
+      size_t prev;  ///< the neighbors on the front
+      size_t next;
+      size_t heap;  ///< the position in heap_m
+      unsigned int priority;
+      gol_type crowding;
+    };
+
+    /// two objectives: the slots of the front
+    std::vector<node> nodes_m;
+    size_t root_m;
+    size_t head_m;
+    /// two objectives: min heap of the crowding distances
+    std::vector<size_t> heap_m;
+    unsigned int seed_m;
+    /// more objectives: the used slots
+    std::vector<size_t> members_m;
+    mutable std::vector<size_t> order_m;
+    mutable bool sorted_m;
+    objective_vector scratch_m;
+    gol_type best_m;
+
+    /// @brief Insert the solution with objectives f.
+    bool
+    insert(const gol_type* f, const copyable& sol);
+
+    bool
+    insert_front(const gol_type* f, const copyable& sol);
+
+    bool
+    insert_scan(const gol_type* f, const copyable& sol);
+
+    gol_type
+    first(size_t slot) const
+    { return values_m[slot * 2]; }
+
+    gol_type
+    second(size_t slot) const
+    { return values_m[slot * 2 + 1]; }
+
+    /// @brief Split the treap t in the solutions with first
+    /// objective lower than key (l) and the others (r).
+    void
+    split(size_t t, gol_type key, size_t& l, size_t& r);
+
+    /// @brief Split the treap t in the leading solutions with second
+    /// objective not lower than key (d) and the others (r).
+    void
+    split_dominated(size_t t, gol_type key, size_t& d, size_t& r);
+
+    /// @brief Join the treaps a and b (a before b).
+    size_t
+    join(size_t a, size_t b);
+
+    /// @brief Remove slot from the treap t.
+    size_t
+    erase(size_t t, size_t slot);
+
+    /// @brief Free all the slots of the treap t.
+    void
+    release(size_t t);
+
+    /// @brief The last solution with first objective lower than key.
+    size_t
+    predecessor(gol_type key) const;
+
+    /// @brief Update the crowding distance of slot (if any).
+    void
+    crowd(size_t slot);
+
+    void
+    heap_up(size_t pos);
+
+    void
+    heap_down(size_t pos);
+
+    void
+    heap_erase(size_t slot);
+
+    /// @brief Copy sol and f in a free slot.
+    size_t
+    store(const gol_type* f, const copyable& sol);
+
+    const std::vector<size_t>&
+    order() const;
+
+    struct lexicographic_less
+    {
+      lexicographic_less(const std::vector<gol_type>& v, size_t m)
+	: values(v), m(m) {}
+      bool operator()(size_t a, size_t b) const
+      { return std::lexicographical_compare(&values[a*m], &values[a*m] + m,
+					    &values[b*m], &values[b*m] + m); }
+      const std::vector<gol_type>& values;
+      size_t m;
+    };
+  };
+
+  /// @}
+}
+
+//________________________________________________________________________
+inline std::vector<mets::objective_vector>
+mets::simplex_weights(size_t m, unsigned int divisions)
+{
+  std::vector<objective_vector> result;
+  if(m == 0)
+    return result;
+  // enumerate the compositions of divisions in m parts
+  std::vector<unsigned int> parts(m, 0);
+  parts[m-1] = divisions;
+  for(;;)
+    {
+      objective_vector w(m);
+      for(size_t ii = 0; ii != m; ++ii)
+	w[ii] = divisions ? gol_type(parts[ii]) / divisions : 1.0 / m;
+      result.push_back(w);
+      if(divisions == 0)
+	break;
+      // next composition: move one unit from the rightmost non
+      // zero part to its left and the rest of it to the last part
+      size_t ii = m - 1;
+      while(ii > 0 && parts[ii] == 0) --ii;
+      if(ii == 0)
+	break;
+      unsigned int rest = parts[ii] - 1;
+      parts[ii] = 0;
+      ++parts[ii-1];
+      parts[m-1] = rest;
+    }
+  return result;
+}
+
+//________________________________________________________________________
+inline void
+mets::pareto_archive::add_slot(copyable& slot)
+{
+  free_m.push_back(slots_m.size());
+  slots_m.push_back(&slot);
+  values_m.resize(slots_m.size() * m_m);
+  // no allocation while accepting
+  nodes_m.resize(slots_m.size());
+  heap_m.reserve(slots_m.size());
+  members_m.reserve(slots_m.size());
+  order_m.reserve(slots_m.size());
+}
+
+//________________________________________________________________________
+inline bool
+mets::pareto_archive::accept(const feasible_solution& sol)
+{
+  const multi_objective_solution* m = sol.multi_objective();
+  if(!m)
+    throw std::bad_cast();
+  m->objective_values(&scratch_m[0]);
+  const evaluable_solution& e = evaluable_cast(sol);
+  if(e.cost_function() < best_m)
+    best_m = e.cost_function();
+  return insert(&scratch_m[0], e);
+}
+
+//________________________________________________________________________
+inline void
+mets::pareto_archive::merge(const pareto_archive& other)
+{
+  assert(other.m_m == m_m);
+  const std::vector<size_t>& members = other.order();
+  for(size_t ii = 0; ii != members.size(); ++ii)
+    insert(&other.values_m[members[ii] * m_m], *other.slots_m[members[ii]]);
+  best_m = std::min(best_m, other.best_m);
+}
+
+//________________________________________________________________________
+inline void
+mets::pareto_archive::clear()
+{
+  root_m = head_m = none;
+  heap_m.clear();
+  members_m.clear();
+  free_m.clear();
+  for(size_t ii = slots_m.size(); ii != 0; --ii)
+    free_m.push_back(ii - 1);
+  sorted_m = false;
+  best_m = std::numeric_limits<gol_type>::max();
+}
+
+//________________________________________________________________________
+inline bool
+mets::pareto_archive::insert(const gol_type* f, const copyable& sol)
+{
+  if(slots_m.empty())
+    return false;
+  bool inserted = m_m == 2 ? insert_front(f, sol) : insert_scan(f, sol);
+  if(inserted)
+    sorted_m = false;
+  return inserted;
+}
+
+//________________________________________________________________________
+inline size_t
+mets::pareto_archive::store(const gol_type* f, const copyable& sol)
+{
+  size_t slot = free_m.back();
+  free_m.pop_back();
+  slots_m[slot]->copy_from(sol);
+  std::copy(f, f + m_m, values_m.begin() + slot * m_m);
+  return slot;
+}
+
+//________________________________________________________________________
+inline bool
+mets::pareto_archive::insert_front(const gol_type* f, const copyable& sol)
+{
+  // the solution with the largest first objective <= f[0] has the
+  // lowest second objective among those: it is the only one that
+  // can dominate (or equal) f
+  size_t prev = none;
+  for(size_t t = root_m; t != none; )
+    if(first(t) <= f[0])
+      {
+	prev = t;
+	t = nodes_m[t].right;
+      }
+    else
+      t = nodes_m[t].left;
+  if(prev != none && second(prev) <= f[1])
+    return false;
+
+  // the solutions dominated by f follow it
+  size_t l, r, dominated;
+  split(root_m, f[0], l, r);
+  split_dominated(r, f[1], dominated, r);
+  release(dominated);
+  root_m = join(l, r);
+
+  if(free_m.empty())
+    {
+      // evict the inner solution with the nearest neighbors (the
+      // extremes have an infinite crowding distance)
+      size_t victim = heap_m[0];
+      if(nodes_m[victim].crowding == std::numeric_limits<gol_type>::max())
+	return false;
+      size_t p = nodes_m[victim].prev;
+      size_t n = nodes_m[victim].next;
+      root_m = erase(root_m, victim);
+      nodes_m[victim].left = nodes_m[victim].right = none;
+      release(victim);
+      crowd(p);
+      crowd(n);
+    }
+
+  size_t slot = store(f, sol);
+  node& x = nodes_m[slot];
+  x.left = x.right = none;
+  seed_m ^= seed_m << 13;
+  seed_m ^= seed_m >> 17;
+  seed_m ^= seed_m << 5;
+  x.priority = seed_m;
+  x.prev = predecessor(f[0]);
+  x.next = x.prev != none ? nodes_m[x.prev].next : head_m;
+  if(x.prev != none)
+    nodes_m[x.prev].next = slot;
+  else
+    head_m = slot;
+  if(x.next != none)
+    nodes_m[x.next].prev = slot;
+  split(root_m, f[0], l, r);
+  root_m = join(join(l, slot), r);
+
+  x.crowding = std::numeric_limits<gol_type>::max();
+  x.heap = heap_m.size();
+  heap_m.push_back(slot);
+  crowd(slot);
+  crowd(x.prev);
+  crowd(x.next);
+  return true;
+}
+
+//________________________________________________________________________
+inline void
+mets::pareto_archive::split(size_t t, gol_type key, size_t& l, size_t& r)
+{
+  if(t == none)
+    l = r = none;
+  else if(first(t) < key)
+    {
+      split(nodes_m[t].right, key, nodes_m[t].right, r);
+      l = t;
+    }
+  else
+    {
+      split(nodes_m[t].left, key, l, nodes_m[t].left);
+      r = t;
+    }
+}
+
+//________________________________________________________________________
+inline void
+mets::pareto_archive::split_dominated(size_t t, gol_type key, 
+				      size_t& d, size_t& r)
+{
+  // the second objective decreases along the front
+  if(t == none)
+    d = r = none;
+  else if(second(t) >= key)
+    {
+      split_dominated(nodes_m[t].right, key, nodes_m[t].right, r);
+      d = t;
+    }
+  else
+    {
+      split_dominated(nodes_m[t].left, key, d, nodes_m[t].left);
+      r = t;
+    }
+}
+
+//________________________________________________________________________
+inline size_t
+mets::pareto_archive::join(size_t a, size_t b)
+{
+  if(a == none)
+    return b;
+  if(b == none)
+    return a;
+  if(nodes_m[a].priority > nodes_m[b].priority)
+    {
+      nodes_m[a].right = join(nodes_m[a].right, b);
+      return a;
+    }
+  nodes_m[b].left = join(a, nodes_m[b].left);
+  return b;
+}
+
+//________________________________________________________________________
+inline size_t
+mets::pareto_archive::erase(size_t t, size_t slot)
+{
+  // the first objectives on the front are distinct
+  if(t == slot)
+    return join(nodes_m[t].left, nodes_m[t].right);
+  if(first(slot) < first(t))
+    nodes_m[t].left = erase(nodes_m[t].left, slot);
+  else
+    nodes_m[t].right = erase(nodes_m[t].right, slot);
+  return t;
+}
+
+//________________________________________________________________________
+inline void
+mets::pareto_archive::release(size_t t)
+{
+  if(t == none)
+    return;
+  release(nodes_m[t].left);
+  release(nodes_m[t].right);
+  node& x = nodes_m[t];
+  if(x.prev != none)
+    nodes_m[x.prev].next = x.next;
+  else
+    head_m = x.next;
+  if(x.next != none)
+    nodes_m[x.next].prev = x.prev;
+  heap_erase(t);
+  free_m.push_back(t);
+}
+
+//________________________________________________________________________
+inline size_t
+mets::pareto_archive::predecessor(gol_type key) const
+{
+  size_t prev = none;
+  for(size_t t = root_m; t != none; )
+    if(first(t) < key)
+      {
+	prev = t;
+	t = nodes_m[t].right;
+      }
+    else
+      t = nodes_m[t].left;
+  return prev;
+}
+
+//________________________________________________________________________
+inline void
+mets::pareto_archive::crowd(size_t slot)
+{
+  if(slot == none)
+    return;
+  node& x = nodes_m[slot];
+  gol_type old = x.crowding;
+  if(x.prev == none || x.next == none)
+    x.crowding = std::numeric_limits<gol_type>::max();
+  else
+    x.crowding = (first(x.next) - first(x.prev)) 
+      + (second(x.prev) - second(x.next));
+  if(x.crowding < old)
+    heap_up(x.heap);
+  else
+    heap_down(x.heap);
+}
+
+//________________________________________________________________________
+inline void
+mets::pareto_archive::heap_up(size_t pos)
+{
+  size_t slot = heap_m[pos];
+  while(pos != 0)
+    {
+      size_t parent = (pos - 1) / 2;
+      if(!(nodes_m[slot].crowding < nodes_m[heap_m[parent]].crowding))
+	break;
+      heap_m[pos] = heap_m[parent];
+      nodes_m[heap_m[pos]].heap = pos;
+      pos = parent;
+    }
+  heap_m[pos] = slot;
+  nodes_m[slot].heap = pos;
+}
+
+//________________________________________________________________________
+inline void
+mets::pareto_archive::heap_down(size_t pos)
+{
+  size_t slot = heap_m[pos];
+  const size_t size = heap_m.size();
+  for(;;)
+    {
+      size_t child = 2 * pos + 1;
+      if(child >= size)
+	break;
+      if(child + 1 < size && nodes_m[heap_m[child + 1]].crowding 
+	 < nodes_m[heap_m[child]].crowding)
+	++child;
+      if(!(nodes_m[heap_m[child]].crowding < nodes_m[slot].crowding))
+	break;
+      heap_m[pos] = heap_m[child];
+      nodes_m[heap_m[pos]].heap = pos;
+      pos = child;
+    }
+  heap_m[pos] = slot;
+  nodes_m[slot].heap = pos;
+}
+
+//________________________________________________________________________
+inline void
+mets::pareto_archive::heap_erase(size_t slot)
+{
+  size_t pos = nodes_m[slot].heap;
+  size_t last = heap_m.back();
+  heap_m.pop_back();
+  if(pos == heap_m.size())
+    return;
+  heap_m[pos] = last;
+  nodes_m[last].heap = pos;
+  heap_up(pos);
+  heap_down(nodes_m[last].heap);
+}
+
+//________________________________________________________________________
+inline bool
+mets::pareto_archive::insert_scan(const gol_type* f, const copyable& sol)
+{
+  size_t kept = 0;
+  for(size_t ii = 0; ii != members_m.size(); ++ii)
+    {
+      const gol_type* g = &values_m[members_m[ii] * m_m];
+      if(dominates(g, f, m_m) || std::equal(g, g + m_m, f))
+	{
+	  // nothing was removed yet: a dominated f cannot dominate
+	  assert(kept == ii);
+	  return false;
+	}
+      if(dominates(f, g, m_m))
+	free_m.push_back(members_m[ii]);
+      else
+	members_m[kept++] = members_m[ii];
+    }
+  members_m.resize(kept);
+
+  if(free_m.empty())
+    {
+      // evict the solution nearest to f
+      size_t victim = 0;
+      gol_type nearest = std::numeric_limits<gol_type>::max();
+      for(size_t ii = 0; ii != members_m.size(); ++ii)
+	{
+	  const gol_type* g = &values_m[members_m[ii] * m_m];
+	  gol_type d = 0.0;
+	  for(size_t k = 0; k != m_m; ++k)
+	    d += std::fabs(g[k] - f[k]);
+	  if(d < nearest)
+	    {
+	      nearest = d;
+	      victim = ii;
+	    }
+	}
+      free_m.push_back(members_m[victim]);
+      members_m.erase(members_m.begin() + victim);
+    }
+  members_m.push_back(store(f, sol));
+  return true;
+}
+
+//________________________________________________________________________
+inline const std::vector<size_t>&
+mets::pareto_archive::order() const
+{
+  if(!sorted_m)
+    {
+      order_m.clear();
+      if(m_m == 2)
+	for(size_t slot = head_m; slot != none; slot = nodes_m[slot].next)
+	  order_m.push_back(slot);
+      else
+	{
+	  order_m = members_m;
+	  std::sort(order_m.begin(), order_m.end(),
+		    lexicographic_less(values_m, m_m));
+	}
+      sorted_m = true;
+    }
+  return order_m;
+}
+
+#endif
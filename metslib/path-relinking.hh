@@ -0,0 +1,278 @@
+// METSlib source file - path-relinking.hh                       -*- C++ -*-
+//
+// Copyright (C) 2006-2010 Mirko Maischberger <mirko.maischberger@gmail.com>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//   You should have received a copy of the GNU General Public License
+//   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// This program can be distributed, at your option, under the terms of
+// the CPL 1.0 as published by the Open Source Initiative
+// http://www.opensource.org/licenses/cpl1.0.php
+
+#ifndef METS_PATH_RELINKING_HH_
+#define METS_PATH_RELINKING_HH_
+
+namespace mets {
+
+  /// @defgroup path_relinking Path Relinking
+  /// @{
+
+  /// @brief Walks from a mets::permutation_problem solution to
+  /// another one and stops at the best solution met along the way.
+  ///
+  /// At each step every swap that puts one more element in the
+  /// position it has in the guiding solution is evaluated (with a
+  /// single call to permutation_problem::evaluate_swaps) and the best
+  /// one is applied. When the guiding solution is reached the walk is
+  /// rewound to the best intermediate solution (the endpoints
+  /// excluded).
+  class path_relinking
+  {
+  public:
+    /// @brief Ctor.
+    path_relinking()
+      : where_m(), diff_m(), slot_m(), from_m(), to_m(), deltas_m(),
+	steps_m(), best_step_m(0)
+    { }
+
+    /// purposely not implemented (see Effective C++)
+    path_relinking(const path_relinking&);
+    /// purposely not implemented (see Effective C++)
+    path_relinking& operator=(const path_relinking&);
+
+    /// @brief Relink working to guiding.
+    ///
+    /// @param working The initiating solution, modified to the best
+    /// intermediate solution (or to guiding if the solutions are too
+    /// close to have intermediate solutions).
+    /// @param guiding The guiding solution.
+    /// @return The cost of working.
+    gol_type
+    operator()(permutation_problem& working,
+	       const permutation_problem& guiding);
+
+    /// @brief Number of swaps between the two solutions of the last
+    /// relink.
+    size_t
+    steps() const
+    { return steps_m.size(); }
+
+    /// @brief Number of swaps from the initiating solution to the
+    /// solution returned by the last relink.
+    size_t
+    best_step() const
+    { return best_step_m; }
+
+  protected:
+    std::vector<int> where_m;
+    std::vector<int> diff_m;
+    std::vector<int> slot_m;
+    std::vector<int> from_m;
+    std::vector<int> to_m;
+    std::vector<gol_type> deltas_m;
+    std::vector<std::pair<int, int> > steps_m;
+    size_t best_step_m;
+
+    void
+    fixed(int position);
+  };
+
+  /// @brief A long term memory for mets::tabu_search that restarts
+  /// the search by path relinking elite solutions.
+  ///
+  /// After restart_after moves without improvement the working
+  /// solution is replaced by the best intermediate solution of a path
+  /// between two solutions taken at random from a mets::elite_pool
+  /// (that should be the solution recorder of the same search).
+  template<typename random_generator>
+  class path_relinking_restart : public long_term_memory_chain
+  {
+  public:
+    /// @brief Ctor.
+    ///
+    /// @param pool The elite solutions.
+    /// @param rng A random number generator.
+    /// @param restart_after Non improving moves before a restart.
+    /// @param epsilon Minimum improvement.
+    path_relinking_restart(const elite_pool& pool, random_generator& rng,
+			   int restart_after, gol_type epsilon = 1e-7)
+      : long_term_memory_chain(), pool_m(pool), rng_m(rng),
+	relinking_m(), restart_after_m(restart_after), epsilon_m(epsilon),
+	noimprove_m(0), restarts_m(0),
+	best_m(std::numeric_limits<gol_type>::max()), int_range_m(0)
+    { }
+
+    void
+    reset()
+    {
+      noimprove_m = 0; restarts_m = 0;
+      best_m = std::numeric_limits<gol_type>::max();
+      long_term_memory_chain::reset();
+    }
+
+    void
+    accept(const feasible_solution& fs, const move& mov, gol_type eval)
+    {
+      gol_type cost =
+	static_cast<const permutation_problem&>(fs).cost_function();
+      if(cost < best_m - epsilon_m)
+	{
+	  best_m = cost;
+	  noimprove_m = 0;
+	}
+      else
+	++noimprove_m;
+      long_term_memory_chain::accept(fs, mov, eval);
+    }
+
+    bool
+    diversify(feasible_solution& fs)
+    {
+      if(noimprove_m < restart_after_m || pool_m.size() < 2)
+	return long_term_memory_chain::diversify(fs);
+      permutation_problem& p = static_cast<permutation_problem&>(fs);
+      size_t a = int_range_m(rng_m, pool_m.size());
+      size_t b = int_range_m(rng_m, pool_m.size() - 1);
+      if(b >= a) ++b;
+      p.copy_from(pool_m[a]);
+      relinking_m(p, pool_m[b]);
+      noimprove_m = 0;
+      ++restarts_m;
+      return true;
+    }
+
+    void
+    save(std::ostream& os) const
+    {
+      write_binary(os, noimprove_m); write_binary(os, restarts_m);
+      write_binary(os, best_m); long_term_memory_chain::save(os);
+    }
+
+    void
+    load(std::istream& is)
+    {
+      read_binary(is, noimprove_m); read_binary(is, restarts_m);
+      read_binary(is, best_m); long_term_memory_chain::load(is);
+    }
+
+    /// @brief Number of restarts so far.
+    unsigned int
+    restarts() const
+    { return restarts_m; }
+
+  protected:
+    const elite_pool& pool_m;
+    random_generator& rng_m;
+    path_relinking relinking_m;
+    int restart_after_m;
+    gol_type epsilon_m;
+    int noimprove_m;
+    unsigned int restarts_m;
+    gol_type best_m;
+#if defined (METSLIB_HAVE_UNORDERED_MAP) && !defined (METSLIB_TR1_MIXED_NAMESPACE)
+    mets::uniform_int<size_t> int_range_m;
+#else
+    std::tr1::uniform_int<size_t> int_range_m;
+#endif
+  };
+
+  /// @}
+}
+
+//________________________________________________________________________
+inline void
+mets::path_relinking::fixed(int position)
+{
+  // remove position from the differing positions
+  int slot = slot_m[position];
+  if(slot < 0)
+    return;
+  int last = diff_m.back();
+  diff_m[slot] = last;
+  slot_m[last] = slot;
+  diff_m.pop_back();
+  slot_m[position] = -1;
+}
+
+//________________________________________________________________________
+inline mets::gol_type
+mets::path_relinking::operator()(permutation_problem& working,
+				 const permutation_problem& guiding)
+{
+  assert(working.size() == guiding.size());
+  const int n = working.size();
+  const std::vector<int>& pi = working.permutation();
+  const std::vector<int>& target = guiding.permutation();
+
+  where_m.resize(n);
+  slot_m.assign(n, -1);
+  diff_m.clear();
+  steps_m.clear();
+  best_step_m = 0;
+  for(int ii = 0; ii != n; ++ii)
+    {
+      where_m[pi[ii]] = ii;
+      if(pi[ii] != target[ii])
+	{
+	  slot_m[ii] = diff_m.size();
+	  diff_m.push_back(ii);
+	}
+    }
+  from_m.resize(diff_m.size());
+  to_m.resize(diff_m.size());
+  deltas_m.resize(diff_m.size());
+
+  gol_type best_cost = std::numeric_limits<gol_type>::max();
+  while(!diff_m.empty())
+    {
+      // all the swaps that fix one more position
+      const size_t count = diff_m.size();
+      for(size_t ii = 0; ii != count; ++ii)
+	{
+	  from_m[ii] = diff_m[ii];
+	  to_m[ii] = where_m[target[diff_m[ii]]];
+	}
+      working.evaluate_swaps(&from_m[0], &to_m[0], &deltas_m[0], count);
+      size_t best = std::min_element(deltas_m.begin(),
+				     deltas_m.begin() + count)
+	- deltas_m.begin();
+      int i = from_m[best];
+      int j = to_m[best];
+
+      working.apply_swap(i, j);
+      where_m[pi[i]] = i;
+      where_m[pi[j]] = j;
+      steps_m.push_back(std::make_pair(i, j));
+      fixed(i);
+      if(pi[j] == target[j])
+	fixed(j);
+
+      if(!diff_m.empty() && working.cost_function() < best_cost)
+	{
+	  best_cost = working.cost_function();
+	  best_step_m = steps_m.size();
+	}
+    }
+
+  // rewind to the best intermediate solution (swaps are their own
+  // inverse)
+  if(best_step_m)
+    for(size_t ii = steps_m.size(); ii != best_step_m; --ii)
+      working.apply_swap(steps_m[ii-1].first, steps_m[ii-1].second);
+  else
+    best_step_m = steps_m.size();
+
+  return working.cost_function();
+}
+
+#endif
@@ -109,8 +109,7 @@ namespace mets {
     /// Remember that this is a minimization process.
     ///
     virtual void
-    search()
-      throw(no_moves_error);
+    search();
 
     /// @brief The current annealing temperature.
     ///
@@ -134,9 +133,10 @@ namespace mets {
     double current_temp_m;
     double K_m;
 #if defined (METSLIB_HAVE_UNORDERED_MAP) && !defined (METSLIB_TR1_MIXED_NAMESPACE)
-    std::uniform_real<double> ureal;
+    std::uniform_real_distribution<double> ureal;
     std::mt19937 rng;
-    std::variate_generator< std::mt19937, std::uniform_real<double> > gen;
+    mets::variate_generator< std::mt19937, 
+			     std::uniform_real_distribution<double> > gen;
 #else
     std::tr1::uniform_real<double> ureal;
     std::tr1::mt19937 rng;
@@ -199,7 +199,6 @@ simulated_annealing(evaluable_solution& working,
 template<typename move_manager_t>
 void
 mets::simulated_annealing<move_manager_t>::search()
-  throw(no_moves_error)
 {
   typedef abstract_search<move_manager_t> base_t;
 
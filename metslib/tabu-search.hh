@@ -37,7 +37,7 @@ namespace mets {
   ///
   /// Aspiration critera can be chained so a criteria can decorate
   /// another criteria
-  class aspiration_criteria_chain
+  class aspiration_criteria_chain : public serializable
   {
   public:
     /// @brief Constructor.
@@ -84,6 +84,16 @@ namespace mets {
     /// @return True if the move is to be accepted.
     virtual bool 
     operator()(const feasible_solution& fs, const move& mov, gol_type evaluation) const;
+
+    /// @brief Save the state of the criteria (chain of
+    /// responsibility).
+    virtual void
+    save(std::ostream& os) const;
+
+    /// @brief Restore the state of the criteria (chain of
+    /// responsibility).
+    virtual void
+    load(std::istream& is);
     
   protected:
     aspiration_criteria_chain* next_m;
@@ -94,7 +104,7 @@ namespace mets {
   /// 
   /// This is chainable so that tabu lists can be decorated with
   /// other tabu lists.
-  class tabu_list_chain
+  class tabu_list_chain : public serializable
   {
   public:
     tabu_list_chain();
@@ -170,11 +180,101 @@ namespace mets {
     tenure(unsigned int tenure) 
     { tenure_m = tenure; }
 
+    /// @brief Save the content of the tabu list (chain of
+    /// responsibility).
+    virtual void
+    save(std::ostream& os) const;
+
+    /// @brief Restore the content of the tabu list (chain of
+    /// responsibility).
+    virtual void
+    load(std::istream& is);
+
   protected:
     tabu_list_chain* next_m;
     unsigned int tenure_m;
   };
   
+  ///
+  /// @brief An abstract long term memory.
+  ///
+  /// While the tabu list is the short term memory of the search, a
+  /// long term memory records facts about the whole search history
+  /// and is used to diversify the search: it can penalize the
+  /// evaluation of moves leading to frequently visited regions and it
+  /// can restart the search from rarely visited regions.
+  ///
+  /// This is chainable so that memories can be decorated with other
+  /// memories.
+  class long_term_memory_chain : public serializable
+  {
+  public:
+    /// @brief Constructor.
+    /// 
+    /// @param next Optional next memory in the chain.
+    explicit
+    long_term_memory_chain(long_term_memory_chain* next = 0)
+      : next_m(next) 
+    { }
+
+    /// purposely not implemented (see Effective C++)
+    long_term_memory_chain(const long_term_memory_chain&);
+    /// purposely not implemented (see Effective C++)
+    long_term_memory_chain& operator=(const long_term_memory_chain&);
+
+    /// @brief Virtual destructor.
+    virtual
+    ~long_term_memory_chain()
+    { }
+
+    /// @brief A method to reset this memory to its original state.
+    virtual void
+    reset();
+
+    /// @brief The penalty to add to the evaluation of a move.
+    ///
+    /// The search chooses the move with the best penalized
+    /// evaluation, while aspiration criteria and solution recorders
+    /// keep working on the real cost.
+    ///
+    /// @param fs The current working solution (before applying move).
+    /// @param mov The move that is being evaluated.
+    /// @param evaluation The cost after the move.
+    virtual gol_type
+    penalty(const feasible_solution& fs, const move& mov, 
+	    gol_type evaluation) const;
+
+    /// @brief This is a callback function from the algorithm that
+    /// tells us that a move was made.
+    ///
+    /// @param fs The current working solution (after applying move).
+    /// @param mov The move just made.
+    /// @param evaluation The cost after the move.
+    virtual void
+    accept(const feasible_solution& fs, const move& mov, 
+	   gol_type evaluation);
+
+    /// @brief Called at the end of each iteration, gives the memory
+    /// the opportunity to move the search to a different region.
+    ///
+    /// @param fs The current working solution (can be modified).
+    /// @return True if the working solution was modified.
+    virtual bool
+    diversify(feasible_solution& fs);
+
+    /// @brief Save the state of the memory (chain of responsibility).
+    virtual void
+    save(std::ostream& os) const;
+
+    /// @brief Restore the state of the memory (chain of
+    /// responsibility).
+    virtual void
+    load(std::istream& is);
+
+  protected:
+    long_term_memory_chain* next_m;
+  };
+
   ///
   /// @brief Tabu Search algorithm.
   ///
@@ -216,6 +316,21 @@ namespace mets {
 		aspiration_criteria_chain& aspiration,
 		termination_criteria_chain& termination);
 
+    /// @brief Creates a tabu Search instance with a long term
+    /// memory.
+    ///
+    /// @param memory The long term memory used to penalize moves and
+    /// to diversify the search (e.g. a mets::frequency_memory).
+    ///
+    /// @see The other constructor for the other parameters.
+    tabu_search(feasible_solution& starting_solution, 
+		solution_recorder& best_recorder, 
+		move_manager_type& move_manager_inst,
+		tabu_list_chain& tabus,
+		aspiration_criteria_chain& aspiration,
+		termination_criteria_chain& termination,
+		long_term_memory_chain& memory);
+
     tabu_search(const search_type&);
     search_type& operator=(const search_type&);
 
@@ -227,13 +342,32 @@ namespace mets {
     /// Remember that this is a minimization process.
     ///
     /// An exception mets::no_moves_error is risen when no move
-    /// is possible.
+    /// is possible (see run() and fallback_to_tabu_moves()).
     void 
-    search() 
-      throw(no_moves_error);
+    search();
+
+    /// @brief Starts the tabu search process, returns
+    /// SEARCH_NO_MOVES (leaving the working solution as is) when all
+    /// the moves are tabu and none meets the aspiration criteria.
+    search_status
+    run();
+
+    /// @brief When all the moves are tabu make the best tabu move
+    /// instead of stopping (the listeners are notified with
+    /// TABU_MOVE_FORCED).
+    ///
+    /// Useful with short neighborhoods or long tenures, the search
+    /// then stops only when the neighborhood is empty.
+    void
+    fallback_to_tabu_moves(bool fallback)
+    { fallback_m = fallback; }
     
     enum {
       ASPIRATION_CRITERIA_MET = abstract_search<move_manager_type>::LAST,
+      /// @brief The long term memory moved the working solution
+      DIVERSIFICATION_MADE,
+      /// @brief All the moves were tabu, the best one will be made
+      TABU_MOVE_FORCED,
       LAST
     };
 
@@ -248,10 +382,78 @@ namespace mets {
     /// @brief The termination criteria used by this tabu search
     const termination_criteria_chain& 
     get_termination_criteria() const { return termination_criteria_m; }
+
+    /// @brief The long term memory used by this tabu search (0 if
+    /// none)
+    const long_term_memory_chain*
+    get_long_term_memory() const { return long_term_memory_m; }
   protected:
     tabu_list_chain& tabu_list_m;
     aspiration_criteria_chain& aspiration_criteria_m;
     termination_criteria_chain& termination_criteria_m;
+    long_term_memory_chain* long_term_memory_m;
+    bool fallback_m;
+  };
+
+  /// @brief A free list of mets::mana_move instances.
+  ///
+  /// The released moves are kept, grouped by mets::mana_move::tag(),
+  /// and reused by opposite() through
+  /// mets::mana_move::opposite_into(), so that a tabu list working
+  /// at steady state does not allocate. Moves without a tag are
+  /// simply deleted.
+  ///
+  /// A pool is not thread safe: use one per search. Pooling is
+  /// opt-in: a mets::simple_tabu_list uses a pool only when one is
+  /// given with simple_tabu_list::pool(), and then every move type
+  /// it stores must implement mets::mana_move::opposite_into() for
+  /// its own dynamic type.
+  class move_pool
+  {
+  public:
+    /// @brief Ctor.
+    ///
+    /// @param limit The maximum number of free moves of each type
+    /// kept for reuse.
+    explicit
+    move_pool(size_t limit = 16)
+      : free_m(), limit_m(limit)
+    { }
+
+    /// purposely not implemented (see Effective C++)
+    move_pool(const move_pool&);
+    move_pool& operator=(const move_pool&);
+
+    /// @brief Deletes the free moves.
+    ~move_pool()
+    { clear(); }
+
+    /// @brief The opposite of mov, a reused move when possible (give
+    /// it back with release()).
+    mana_move*
+    opposite(const mana_move& mov);
+
+    /// @brief Give back a heap allocated move (obtained from
+    /// opposite(), clone() or opposite_of()).
+    void
+    release(const mana_move* mov);
+
+    /// @brief The number of free moves.
+    size_t
+    size() const;
+
+    /// @brief Delete the free moves.
+    void
+    clear();
+
+  protected:
+    typedef std::vector<mana_move*> move_vector;
+    /// the free moves of each tag (few, a linear search is fine)
+    std::vector<std::pair<const void*, move_vector> > free_m;
+    size_t limit_m;
+
+    move_vector*
+    bucket(const void* tag);
   };
 
   /// @brief Simplistic implementation of a tabu-list.
@@ -267,6 +469,18 @@ namespace mets {
   ///
   /// A mets::mana_move is tabu if it's in the tabu list by means 
   /// of its operator== and hash function.
+  ///
+  /// The list keeps the last tenure() distinct moves in a fixed
+  /// array of slots, linked from the least to the most recently made,
+  /// and indexes them with an open addressing hash table of at least
+  /// twice as many positions: the memory is allocated only when the
+  /// tenure changes and tabu() and is_tabu() take constant expected
+  /// time.
+  ///
+  /// The opposite moves stored in the list are made with
+  /// mets::mana_move::opposite_of() and deleted when they leave the
+  /// list, unless a mets::move_pool is given with pool() (see
+  /// mets::mana_move::opposite_into()).
   class simple_tabu_list 
     : public tabu_list_chain
   {
@@ -276,8 +490,15 @@ namespace mets {
     /// @param tenure Tenure (length) of the tabu list
     simple_tabu_list(unsigned int tenure) 
       : tabu_list_chain(tenure), 
-	tabu_moves_m(), 
-	tabu_hash_m(tenure) {}
+	slots_m(),
+	table_m(),
+	shift_m(0),
+	size_m(0),
+	oldest_m(-1),
+	newest_m(-1),
+	prototype_m(0),
+	pool_m(0) 
+    { resize(tenure); }
 
     /// @brief Ctor. Makes a tabu list of the specified tenure.
     ///
@@ -285,8 +506,15 @@ namespace mets {
     /// @param next Next list to invoke when this returns false
     simple_tabu_list(tabu_list_chain* next, unsigned int tenure) 
       : tabu_list_chain(next, tenure), 
-	tabu_moves_m(), 
-	tabu_hash_m(tenure) {}
+	slots_m(),
+	table_m(),
+	shift_m(0),
+	size_m(0),
+	oldest_m(-1),
+	newest_m(-1),
+	prototype_m(0),
+	pool_m(0) 
+    { resize(tenure); }
 
     /// @brief Destructor
     ~simple_tabu_list();
@@ -312,241 +540,1393 @@ namespace mets {
     bool
     is_tabu(const feasible_solution& sol, const move& mov) const;
 
-  protected:
-    typedef std::deque<const move*> move_list_type;
-#if defined (METSLIB_HAVE_UNORDERED_MAP) && !defined (METSLIB_TR1_MIXED_NAMESPACE)
-    typedef std::unordered_map<
-      const mana_move*, // Key type
-      int, //insert a move and the number of times it's present in the list
-      mana_move_hash, 
-      dereferenced_equal_to<const mana_move*> > move_map_type;
-#else
-    typedef std::tr1::unordered_map<
-      const mana_move*, // Key type
-      int, //insert a move and the number of times it's present in the list
-      mana_move_hash, 
-      dereferenced_equal_to<const mana_move*> > move_map_type;
-#endif    
-    move_list_type tabu_moves_m;
-    move_map_type tabu_hash_m;
-  };
+    /// @brief Change the tenure (the most recent moves are kept).
+    void
+    tenure(unsigned int tenure);
 
-  /// @brief Aspiration criteria implementation.
-  ///
-  /// This is one of the best known aspiration criteria
-  /// ready to be used in your tabu-search implementation.
-  ///
-  /// This aspiration criteria is met when a tabu move would result in
-  /// a global improvement.
-  class best_ever_criteria : public aspiration_criteria_chain
-  {
-  public:
-    explicit
-    best_ever_criteria(double min_improvement = 1e-6);
+    using tabu_list_chain::tenure;
 
-    explicit
-    best_ever_criteria(aspiration_criteria_chain* next,
-		       double min_improvement = 1e-6);
-    
-    void 
-    reset();
+    /// @brief The number of moves in the list.
+    unsigned int
+    size() const
+    { return size_m; }
 
+    /// @brief Set the prototype used to restore the moves of a saved
+    /// list.
+    ///
+    /// To save and load the list the moves must implement
+    /// mets::mana_move::save and mets::mana_move::load and must all be
+    /// of the same type of the prototype (that is cloned and then
+    /// loaded for each stored move).
     void
-    accept(const feasible_solution& fs, const move& mov, gol_type evaluation);
+    move_prototype(const mana_move& prototype)
+    { prototype_m = &prototype; }
 
-    bool 
-    operator()(const feasible_solution& fs, const move& mov, gol_type evaluation) const;
+    /// @brief Recycle the moves through p (e.g. one shared by the
+    /// tabu lists of the same thread), it must outlive this list.
+    ///
+    /// Only do this if all the moves made tabu implement
+    /// mets::mana_move::opposite_into() for their dynamic type: a
+    /// move derived from one of the library that overrides
+    /// opposite_of() must override opposite_into() (or tag()) too.
+    void
+    pool(move_pool& p)
+    { pool_m = &p; }
 
-  protected:
-    gol_type best_m;
-    gol_type tolerance_m;
-  };
-  
-  /// @}
-}
+    /// @brief The pool of the moves (0 if none was given).
+    move_pool*
+    pool()
+    { return pool_m; }
 
-template<typename move_manager_t>
-mets::tabu_search<move_manager_t>::
-tabu_search (feasible_solution& starting_solution, 
-	     solution_recorder& best_recorder, 
-	     move_manager_t& move_manager_inst,
-	     tabu_list_chain& tabus,
-	     aspiration_criteria_chain& aspiration,
-	     termination_criteria_chain& termination)
-  : abstract_search<move_manager_t>(starting_solution, 
-				    best_recorder, 
-				    move_manager_inst),
-    tabu_list_m(tabus),
-    aspiration_criteria_m(aspiration),
-    termination_criteria_m(termination)
-{}
+    /// @brief Save the moves in the list.
+    void
+    save(std::ostream& os) const;
 
-template<typename move_manager_t>
-void mets::tabu_search<move_manager_t>::search()
-  throw(no_moves_error)
-{
-  typedef abstract_search<move_manager_t> base_t;
-  while(!termination_criteria_m(base_t::working_solution_m))
+    /// @brief Restore the moves in the list (see move_prototype()).
+    void
+    load(std::istream& is);
+
+  protected:
+    /// @brief A move in the list.
+    struct slot
     {
-      // call listeners
-      base_t::step_m = base_t::ITERATION_BEGIN;
-      this->notify();
+      const mana_move* move;
+      size_t hash;
+      /// the previous (older) and next (newer) slots, -1 if none
+      int prev;
+      int next;
+    };
 
-      base_t::moves_m.refresh(base_t::working_solution_m);
-      
-      typename move_manager_t::iterator best_movit = base_t::moves_m.end(); 
-      gol_type best_move_cost = std::numeric_limits<gol_type>::max();
-      
-      for(typename move_manager_t::iterator movit = base_t::moves_m.begin(); 
-	  movit != base_t::moves_m.end(); ++movit)
-	{
-	  // evaluate proposed move
-	  gol_type cost = (*movit)->evaluate(base_t::working_solution_m);
-	  
-	  // save tabu status
-	  bool is_tabu = tabu_list_m.is_tabu(base_t::working_solution_m, 
-					     **movit);
+    std::vector<slot> slots_m;
+    /// slot + 1 for each position, 0 if empty
+    std::vector<unsigned int> table_m;
+    int shift_m;
+    unsigned int size_m;
+    int oldest_m;
+    int newest_m;
+    const mana_move* prototype_m;
+    move_pool* pool_m;
 
-	  // for each non-tabu move record the best one
-	  if(cost < best_move_cost)
-	    {
-	      
-	      bool aspiration_criteria_met = false;
-	      
-	      // not interesting if this is not a tabu move (and if we
-	      // are not improving over other moves)
-	      if(is_tabu) 
-		{
-		  aspiration_criteria_met = 
-		    aspiration_criteria_m(base_t::working_solution_m, 
-					  **movit,
-					  cost);
-		}
-	      
-	      if(!is_tabu || aspiration_criteria_met)
-		{
-		  best_move_cost = cost;
-		  best_movit = base_t::current_move_m = movit;
-		  if(aspiration_criteria_met)
-		    {
-		      base_t::step_m = ASPIRATION_CRITERIA_MET;
-		      this->notify();
-		    }
-		}
-	    }
-	} // end for each move
-      
-      if(best_movit == base_t::moves_m.end())
-	throw no_moves_error();
+    /// @brief A new opposite of mov (from the pool, if any).
+    const mana_move*
+    opposite(const mana_move& mov)
+    { return pool_m ? pool_m->opposite(mov) : mov.opposite_of(); }
 
-      // make move tabu
-      tabu_list_m.tabu(base_t::working_solution_m, **best_movit);
+    /// @brief Dispose of a move owned by the list.
+    void
+    release(const mana_move* mov)
+    { if(pool_m) pool_m->release(mov); else delete mov; }
 
-      // do the best non tabu move (unless overridden by aspiration
-      // criteria, of course)
-      (*best_movit)->apply(base_t::working_solution_m);
+    /// @brief Make mc (owned by the list) the most recent tabu move.
+    void
+    push(const mana_move* mc);
 
-      // call listeners
-      base_t::step_m = base_t::MOVE_MADE;
-      this->notify();
-      
-      aspiration_criteria_m.accept(base_t::working_solution_m, 
-				   **best_movit, 
-				   best_move_cost);
-      
-      if(base_t::solution_recorder_m.accept(base_t::working_solution_m))
-	{
-	  base_t::step_m = base_t::IMPROVEMENT_MADE;
-	  this->notify();
-	}
+    /// @brief Forget all the moves.
+    void
+    clear();
 
-      // call listeners
-      base_t::step_m = base_t::ITERATION_END;
-      this->notify();
-      
-    } // end while(!termination)
-}
+    /// @brief Allocate the slots and the table for a tenure (the
+    /// list must be empty).
+    void
+    resize(unsigned int tenure);
 
-// chain of responsibility
+    /// @brief The first position to probe for hash.
+    size_t
+    home(size_t hash) const
+    { return static_cast<size_t>
+	((hash * 0x9E3779B97F4A7C15ULL) >> shift_m); }
 
-inline void
-mets::tabu_list_chain::tabu(const feasible_solution& sol, const move& mov)
-{
-  if(next_m)
-    next_m->tabu(sol, mov);
-}
+    /// @brief The position of the move equal to mov, table_m.size()
+    /// if none.
+    size_t
+    find(const mana_move& mov, size_t hash) const;
 
-inline bool
-mets::tabu_list_chain::is_tabu(const feasible_solution& sol, const move& mov) const
-{
-  if(next_m) 
-    return next_m->is_tabu(sol, mov);
-  else 
-    return false;
-}
+    /// @brief Remove the slot at table position pos from the table
+    void
+    erase(size_t pos);
 
-inline mets::simple_tabu_list::~simple_tabu_list()
-{ 
-  for(move_map_type::iterator m = tabu_hash_m.begin(); 
-      m!=tabu_hash_m.end(); ++m)
-    delete m->first;
-}
+    /// @brief Unlink slot s from the recency list.
+    void
+    unlink(int s);
 
-inline void
-mets::simple_tabu_list::tabu(const feasible_solution& sol, const move& mov)
-{
-  const mana_move* mc = 
-    dynamic_cast<const mana_move&>(mov).opposite_of();
+    /// @brief Link slot s as the most recent one.
+    void
+    link(int s);
 
-  // This does nothing if the move was already tabu (can happen when
-  // aspiration criteria is met).
-  std::pair<move_map_type::iterator, bool> 
-    insert_result = tabu_hash_m.insert(std::make_pair(mc, 1));
+  private:
+    /// @brief Copy ctor: purposely not implemented (see Effective C++)
+    simple_tabu_list(const simple_tabu_list&);
+    /// @brief Assignment: purposely not implemented (see Effective C++)
+    simple_tabu_list& operator=(const simple_tabu_list&);
+  };
 
-  // If it was already in the map, increase the counter
-  if(!insert_result.second) 
-    {
-      insert_result.first->second++;
-      delete mc;
-      mc = insert_result.first->first;
-    }
-  // Always add the move at the end of the list (when aspiration
-  // criteria is met a move can be present more than one time in this
-  // list: this is correct, so the last made move is always the last
-  // in the queue). 
-  tabu_moves_m.push_back(mc);
-
-  // Since we use the hash size, the tenure is the number of different
-  // moves on the list (the tabu_moves_m can have more than tenure
-  // elements)
-  while(tabu_hash_m.size() > this->tenure())
-    {
-      // update hash map *and* list structures
-      move_map_type::iterator elem = tabu_hash_m.find
-	(dynamic_cast<const mana_move*>(tabu_moves_m.front()));
-      elem->second--;
-      if(elem->second == 0) 
-	{
-	  const mana_move* tmp = elem->first;
-	  tabu_hash_m.erase(elem);
-	  delete tmp;
-	}
-      tabu_moves_m.pop_front();
-    }
-  tabu_list_chain::tabu(sol, mov);
-}
+  /// @brief A bounded set of fingerprints remembering only the last
+  /// capacity() insertions.
+  ///
+  /// The fingerprints are kept both in a ring buffer (in insertion
+  /// order) and in an open addressing hash table, so that insertion,
+  /// eviction of the oldest element and lookup take constant time
+  /// and no memory is allocated after construction.
+  ///
+  /// The same fingerprint can be inserted more than once: it is
+  /// forgotten when its last occurrence is evicted.
+  class visited_set
+  {
+  public:
+    /// @brief Ctor. Makes an empty set of the given capacity.
+    explicit
+    visited_set(unsigned int capacity);
 
-inline bool
-mets::simple_tabu_list::is_tabu(const feasible_solution& sol, const move& mov) const
-{
-  // hash set. very fast but requires C++ ISO TR1 extension
-  // and an hash function in every move (Omega(1)).
-  bool tabu = (tabu_hash_m.find(&dynamic_cast<const mana_move&>(mov)) 
-	       != tabu_hash_m.end());
+    /// @brief True if the fingerprint is in the set.
+    bool
+    contains(size_t fingerprint) const;
 
-  if(tabu)
+    /// @brief Insert a fingerprint, evicting the oldest one if the set
+    /// is full.
+    void
+    insert(size_t fingerprint);
+
+    /// @brief Forget all the fingerprints.
+    void
+    clear();
+
+    /// @brief The number of fingerprints remembered.
+    unsigned int
+    size() const
+    { return size_m; }
+
+    /// @brief The maximum number of fingerprints remembered.
+    unsigned int
+    capacity() const
+    { return ring_m.size(); }
+
+    /// @brief Change the capacity (this also clears the set).
+    void
+    capacity(unsigned int capacity);
+
+    /// @brief Save capacity and content of the set.
+    void
+    save(std::ostream& os) const;
+
+    /// @brief Restore capacity and content of the set.
+    void
+    load(std::istream& is);
+
+  protected:
+    std::vector<size_t> ring_m;
+    unsigned int next_m;
+    unsigned int size_m;
+    std::vector<size_t> keys_m;
+    std::vector<unsigned int> counts_m;
+    size_t mask_m;
+
+    size_t
+    home(size_t fingerprint) const
+    { size_t h = fingerprint * 2654435761UL; return (h ^ (h >> 15)) & mask_m; }
+
+    void
+    erase(size_t fingerprint);
+  };
+
+  /// @brief A tabu list that remembers the fingerprints of the last
+  /// tenure() solutions visited.
+  ///
+  /// A move is tabu when it leads back to one of the remembered
+  /// solutions. This gives a precise cycle avoidance using a constant
+  /// amount of memory and without cloning moves.
+  ///
+  /// The working solution must be a mets::permutation_problem with a
+  /// fingerprint (see mets::permutation_problem::use_fingerprint) and
+  /// the moves must be of mets::permutation_move type.
+  class solution_tabu_list
+    : public tabu_list_chain
+  {
+  public:
+    /// @brief Ctor. Makes a tabu list of the specified tenure.
+    ///
+    /// @param tenure Number of solutions to remember
+    explicit
+    solution_tabu_list(unsigned int tenure) 
+      : tabu_list_chain(tenure), 
+	visited_m(tenure) {}
+
+    /// @brief Ctor. Makes a tabu list of the specified tenure.
+    ///
+    /// @param tenure Number of solutions to remember
+    /// @param next Next list to invoke when this returns false
+    solution_tabu_list(tabu_list_chain* next, unsigned int tenure) 
+      : tabu_list_chain(next, tenure), 
+	visited_m(tenure) {}
+
+    /// @brief Remember the solution we are leaving.
+    ///
+    /// @param sol The current working solution
+    /// @param mov The move about to be made
+    void
+    tabu(const feasible_solution& sol, const move& mov);
+
+    /// @brief True if the move leads to one of the last tenure()
+    /// visited solutions.
+    ///
+    /// @param sol The current working solution
+    /// @param mov The move to evaluate
+    bool
+    is_tabu(const feasible_solution& sol, const move& mov) const;
+
+    using tabu_list_chain::tenure;
+
+    /// @brief Change the tenure (this forgets the visited solutions).
+    void
+    tenure(unsigned int tenure)
+    { tabu_list_chain::tenure(tenure); visited_m.capacity(tenure); }
+
+    void
+    save(std::ostream& os) const
+    { visited_m.save(os); tabu_list_chain::save(os); }
+
+    void
+    load(std::istream& is)
+    { 
+      visited_m.load(is); 
+      tabu_list_chain::tenure(visited_m.capacity());
+      tabu_list_chain::load(is); 
+    }
+
+  protected:
+    visited_set visited_m;
+  };
+
+  /// @brief A tabu list for mets::assignment_problem that keeps
+  /// items from going back to the values they had recently.
+  ///
+  /// When an item leaves a value, the pair is made tabu for tenure()
+  /// iterations: the expiry iteration is stored in a flat n x k
+  /// matrix, so that tabu() and is_tabu() are O(1) and never
+  /// allocate.
+  ///
+  /// The working solution must be a mets::assignment_problem and the
+  /// moves must be of mets::change_value type.
+  class assignment_tabu_list
+    : public tabu_list_chain
+  {
+  public:
+    /// @brief Ctor.
+    ///
+    /// @param n The number of items.
+    /// @param k The number of values.
+    /// @param tenure Iterations a value stays tabu for an item.
+    assignment_tabu_list(int n, int k, unsigned int tenure) 
+      : tabu_list_chain(tenure), k_m(k), expiry_m(size_t(n) * k, 0), 
+	iteration_m(0) {}
+
+    /// @brief Ctor.
+    ///
+    /// @param next Next list to invoke when this returns false
+    /// @see The other constructor for the other parameters.
+    assignment_tabu_list(tabu_list_chain* next, int n, int k, 
+			 unsigned int tenure) 
+      : tabu_list_chain(next, tenure), k_m(k), expiry_m(size_t(n) * k, 0), 
+	iteration_m(0) {}
+
+    /// @brief Make the current value of the item tabu.
+    ///
+    /// @param sol The current working solution
+    /// @param mov The move about to be made
+    void
+    tabu(const feasible_solution& sol, const move& mov);
+
+    /// @brief True if the move gives the item a value it left less
+    /// than tenure() iterations ago.
+    bool
+    is_tabu(const feasible_solution& sol, const move& mov) const;
+
+    void
+    save(std::ostream& os) const
+    { 
+      write_binary(os, expiry_m); write_binary(os, iteration_m); 
+      tabu_list_chain::save(os); 
+    }
+
+    void
+    load(std::istream& is)
+    { 
+      read_binary_fixed(is, expiry_m); read_binary(is, iteration_m); 
+      tabu_list_chain::load(is); 
+    }
+
+  protected:
+    int k_m;
+    std::vector<unsigned int> expiry_m;
+    unsigned int iteration_m;
+  };
+
+  /// @brief A tabu list for mets::bitvector_problem that keeps
+  /// the bits just flipped from being flipped again.
+  ///
+  /// A flipped bit is tabu for tenure() iterations. The expiry
+  /// iteration of each bit is stored in a vector, so that tabu() and
+  /// is_tabu() are O(1) and never allocate.
+  ///
+  /// The moves must be of mets::flip_bit type.
+  class flip_tabu_list
+    : public tabu_list_chain
+  {
+  public:
+    /// @brief Ctor.
+    ///
+    /// @param n The number of bits.
+    /// @param tenure Iterations a flipped bit stays tabu.
+    flip_tabu_list(int n, unsigned int tenure) 
+      : tabu_list_chain(tenure), expiry_m(n, 0), iteration_m(0) {}
+
+    /// @brief Ctor.
+    ///
+    /// @param next Next list to invoke when this returns false
+    /// @see The other constructor for the other parameters.
+    flip_tabu_list(tabu_list_chain* next, int n, unsigned int tenure) 
+      : tabu_list_chain(next, tenure), expiry_m(n, 0), iteration_m(0) {}
+
+    /// @brief Make the bit tabu.
+    void
+    tabu(const feasible_solution& sol, const move& mov)
+    {
+      ++iteration_m;
+      expiry_m[static_cast<const flip_bit&>(mov).bit()] 
+	= iteration_m + tenure();
+      tabu_list_chain::tabu(sol, mov);
+    }
+
+    /// @brief True if the bit was flipped less than tenure()
+    /// iterations ago.
+    bool
+    is_tabu(const feasible_solution& sol, const move& mov) const
+    {
+      if(expiry_m[static_cast<const flip_bit&>(mov).bit()] > iteration_m)
+	return true;
+      return tabu_list_chain::is_tabu(sol, mov);
+    }
+
+    void
+    save(std::ostream& os) const
+    { 
+      write_binary(os, expiry_m); write_binary(os, iteration_m); 
+      tabu_list_chain::save(os); 
+    }
+
+    void
+    load(std::istream& is)
+    { 
+      read_binary_fixed(is, expiry_m); read_binary(is, iteration_m); 
+      tabu_list_chain::load(is); 
+    }
+
+  protected:
+    std::vector<unsigned int> expiry_m;
+    unsigned int iteration_m;
+  };
+
+  /// @brief A tabu list for mets::permutation_problem keeping the
+  /// pairs of positions just swapped from being swapped again.
+  ///
+  /// A swap is tabu for tenure() iterations. The expiry iteration of
+  /// each pair is stored in a flat vector, in the order of the
+  /// mets::swap_full_neighborhood, so that tabu() and is_tabu() are
+  /// O(1) and the whole vector can be scanned together with the
+  /// deltas of a mets::swap_soa_neighborhood (see
+  /// mets::fused_swap_search).
+  ///
+  /// The moves must be of mets::swap_elements type.
+  class swap_tabu_list
+    : public tabu_list_chain
+  {
+  public:
+    /// @brief Ctor.
+    ///
+    /// @param n The size of the permutation.
+    /// @param tenure Iterations a swapped pair stays tabu.
+    swap_tabu_list(int n, unsigned int tenure) 
+      : tabu_list_chain(tenure), n_m(n), expiry_m(pairs(n), 0), 
+	iteration_m(0) {}
+
+    /// @brief Ctor.
+    ///
+    /// @param next Next list to invoke when this returns false
+    /// @see The other constructor for the other parameters.
+    swap_tabu_list(tabu_list_chain* next, int n, unsigned int tenure) 
+      : tabu_list_chain(next, tenure), n_m(n), expiry_m(pairs(n), 0), 
+	iteration_m(0) {}
+
+    /// @brief The number of pairs of n elements.
+    static size_t
+    pairs(int n) METSLIB_NOEXCEPT
+    { return n > 1 ? size_t(n) * (n - 1) / 2 : 0; }
+
+    /// @brief The index of the swap of i and j (i < j) in the
+    /// neighborhood order.
+    static size_t
+    pair_index(int n, int i, int j) METSLIB_NOEXCEPT
+    { return size_t(i) * (2 * size_t(n) - i - 1) / 2 + (j - i - 1); }
+
+    /// @brief Make the swap tabu.
+    void
+    tabu(const feasible_solution& sol, const move& mov)
+    {
+      const swap_elements& m = static_cast<const swap_elements&>(mov);
+      ++iteration_m;
+      expiry_m[pair_index(n_m, m.first(), m.second())] 
+	= iteration_m + tenure();
+      tabu_list_chain::tabu(sol, mov);
+    }
+
+    /// @brief True if the pair was swapped less than tenure()
+    /// iterations ago.
+    bool
+    is_tabu(const feasible_solution& sol, const move& mov) const
+    {
+      const swap_elements& m = static_cast<const swap_elements&>(mov);
+      if(expiry_m[pair_index(n_m, m.first(), m.second())] > iteration_m)
+	return true;
+      return tabu_list_chain::is_tabu(sol, mov);
+    }
+
+    /// @brief The expiry iteration of each pair (a pair is tabu if
+    /// its expiry is greater than iteration()).
+    const unsigned int*
+    expiry() const
+    { return &expiry_m[0]; }
+
+    /// @brief The number of tabu() calls so far.
+    unsigned int
+    iteration() const
+    { return iteration_m; }
+
+    void
+    save(std::ostream& os) const
+    { 
+      write_binary(os, expiry_m); write_binary(os, iteration_m); 
+      tabu_list_chain::save(os); 
+    }
+
+    void
+    load(std::istream& is)
+    { 
+      read_binary_fixed(is, expiry_m); read_binary(is, iteration_m); 
+      tabu_list_chain::load(is); 
+    }
+
+  protected:
+    int n_m;
+    std::vector<unsigned int> expiry_m;
+    unsigned int iteration_m;
+  };
+
+  /// @brief Frequency based long term memory for permutation
+  /// problems.
+  ///
+  /// Counts how many times each element has been assigned to each
+  /// position (in a flat n x n matrix) and uses the counts to:
+  ///
+  /// - penalize non improving moves that assign elements to
+  ///   positions they frequently had (the penalty is weight times the
+  ///   relative frequency of the new assignments);
+  ///
+  /// - restart the search, after restart_after iterations without
+  ///   improvement, from a solution made of rarely used assignments.
+  ///   To obtain a few restarts before the search ends set this
+  ///   lower than the max of a mets::noimprove_termination_criteria.
+  ///
+  /// The working solution must be a mets::permutation_problem and the
+  /// moves must be of mets::swap_elements type.
+  class frequency_memory : public long_term_memory_chain
+  {
+  public:
+    /// @brief Ctor.
+    ///
+    /// @param n The size of the problem.
+    /// @param weight The weight of the frequency penalty (0 to
+    /// disable it).
+    /// @param restart_after Iterations without improvement before a
+    /// restart (0 to never restart).
+    /// @param epsilon The minimum improvement.
+    frequency_memory(int n, gol_type weight, int restart_after = 0, 
+		     gol_type epsilon = 1e-7);
+
+    /// @brief Ctor.
+    ///
+    /// @param next Next memory in the chain.
+    /// @see The other constructor for the other parameters.
+    frequency_memory(long_term_memory_chain* next, int n, gol_type weight, 
+		     int restart_after = 0, gol_type epsilon = 1e-7);
+
+    void
+    reset();
+
+    gol_type
+    penalty(const feasible_solution& fs, const move& mov, 
+	    gol_type evaluation) const;
+
+    void
+    accept(const feasible_solution& fs, const move& mov, 
+	   gol_type evaluation);
+
+    bool
+    diversify(feasible_solution& fs);
+
+    void
+    save(std::ostream& os) const;
+
+    void
+    load(std::istream& is);
+
+    /// @brief How many times element was assigned to position.
+    unsigned int
+    frequency(int element, int position) const
+    { return frequency_m[element*n_m + position]; }
+
+    /// @brief The number of moves recorded.
+    unsigned int
+    iterations() const
+    { return iterations_m; }
+
+    /// @brief The number of restarts made.
+    unsigned int
+    restarts() const
+    { return restarts_m; }
+
+  protected:
+    int n_m;
+    gol_type weight_m;
+    int restart_after_m;
+    gol_type epsilon_m;
+    std::vector<unsigned int> frequency_m;
+    unsigned int iterations_m;
+    unsigned int restarts_m;
+    int noimprove_m;
+    gol_type best_m;
+    std::vector<bool> taken_m;
+  };
+
+  /// @brief Aspiration criteria implementation.
+  ///
+  /// This is one of the best known aspiration criteria
+  /// ready to be used in your tabu-search implementation.
+  ///
+  /// This aspiration criteria is met when a tabu move would result in
+  /// a global improvement.
+  class best_ever_criteria : public aspiration_criteria_chain
+  {
+  public:
+    explicit
+    best_ever_criteria(double min_improvement = 1e-6);
+
+    explicit
+    best_ever_criteria(aspiration_criteria_chain* next,
+		       double min_improvement = 1e-6);
+    
+    void 
+    reset();
+
+    void
+    accept(const feasible_solution& fs, const move& mov, gol_type evaluation);
+
+    bool 
+    operator()(const feasible_solution& fs, const move& mov, gol_type evaluation) const;
+
+    void
+    save(std::ostream& os) const
+    { write_binary(os, best_m); aspiration_criteria_chain::save(os); }
+
+    void
+    load(std::istream& is)
+    { read_binary(is, best_m); aspiration_criteria_chain::load(is); }
+
+  protected:
+    gol_type best_m;
+    gol_type tolerance_m;
+  };
+  
+  /// @}
+}
+
+template<typename move_manager_t>
+mets::tabu_search<move_manager_t>::
+tabu_search (feasible_solution& starting_solution, 
+	     solution_recorder& best_recorder, 
+	     move_manager_t& move_manager_inst,
+	     tabu_list_chain& tabus,
+	     aspiration_criteria_chain& aspiration,
+	     termination_criteria_chain& termination)
+  : abstract_search<move_manager_t>(starting_solution, 
+				    best_recorder, 
+				    move_manager_inst),
+    tabu_list_m(tabus),
+    aspiration_criteria_m(aspiration),
+    termination_criteria_m(termination),
+    long_term_memory_m(0),
+    fallback_m(false)
+{}
+
+template<typename move_manager_t>
+mets::tabu_search<move_manager_t>::
+tabu_search (feasible_solution& starting_solution, 
+	     solution_recorder& best_recorder, 
+	     move_manager_t& move_manager_inst,
+	     tabu_list_chain& tabus,
+	     aspiration_criteria_chain& aspiration,
+	     termination_criteria_chain& termination,
+	     long_term_memory_chain& memory)
+  : abstract_search<move_manager_t>(starting_solution, 
+				    best_recorder, 
+				    move_manager_inst),
+    tabu_list_m(tabus),
+    aspiration_criteria_m(aspiration),
+    termination_criteria_m(termination),
+    long_term_memory_m(&memory),
+    fallback_m(false)
+{}
+
+template<typename move_manager_t>
+void mets::tabu_search<move_manager_t>::search()
+{
+  if(run() == SEARCH_NO_MOVES)
+    throw no_moves_error();
+}
+
+template<typename move_manager_t>
+mets::search_status mets::tabu_search<move_manager_t>::run()
+{
+  typedef abstract_search<move_manager_t> base_t;
+  while(!termination_criteria_m(base_t::working_solution_m))
+    {
+      // call listeners
+      base_t::step_m = base_t::ITERATION_BEGIN;
+      this->notify();
+
+      base_t::moves_m.refresh(base_t::working_solution_m);
+      
+      typename move_manager_t::iterator best_movit = base_t::moves_m.end(); 
+      gol_type best_move_cost = std::numeric_limits<gol_type>::max();
+      gol_type best_move_score = std::numeric_limits<gol_type>::max();
+      typename move_manager_t::iterator tabu_movit = base_t::moves_m.end(); 
+      gol_type tabu_move_cost = std::numeric_limits<gol_type>::max();
+      gol_type tabu_move_score = std::numeric_limits<gol_type>::max();
+      
+      for(typename move_manager_t::iterator movit = base_t::moves_m.begin(); 
+	  movit != base_t::moves_m.end(); ++movit)
+	{
+	  // evaluate proposed move
+	  gol_type cost = (*movit)->evaluate(base_t::working_solution_m);
+
+	  // penalize it using the long term memory
+	  gol_type score = cost;
+	  if(long_term_memory_m)
+	    score += long_term_memory_m->penalty(base_t::working_solution_m,
+						 **movit, cost);
+	  
+	  // save tabu status
+	  bool is_tabu = tabu_list_m.is_tabu(base_t::working_solution_m, 
+					     **movit);
+
+	  // for each non-tabu move record the best one
+	  if(score < best_move_score)
+	    {
+	      
+	      bool aspiration_criteria_met = false;
+	      
+	      // not interesting if this is not a tabu move (and if we
+	      // are not improving over other moves)
+	      if(is_tabu) 
+		{
+		  aspiration_criteria_met = 
+		    aspiration_criteria_m(base_t::working_solution_m, 
+					  **movit,
+					  cost);
+		}
+	      
+	      if(!is_tabu || aspiration_criteria_met)
+		{
+		  best_move_cost = cost;
+		  best_move_score = score;
+		  best_movit = base_t::current_move_m = movit;
+		  if(aspiration_criteria_met)
+		    {
+		      base_t::step_m = ASPIRATION_CRITERIA_MET;
+		      this->notify();
+		    }
+		}
+	      else if(fallback_m && score < tabu_move_score)
+		{
+		  // only needed if no move is admissible, in that
+		  // case all the moves get here
+		  tabu_move_cost = cost;
+		  tabu_move_score = score;
+		  tabu_movit = movit;
+		}
+	    }
+	} // end for each move
+      
+      if(best_movit == base_t::moves_m.end())
+	{
+	  if(tabu_movit == base_t::moves_m.end())
+	    return SEARCH_NO_MOVES;
+	  best_move_cost = tabu_move_cost;
+	  best_movit = base_t::current_move_m = tabu_movit;
+	  base_t::step_m = TABU_MOVE_FORCED;
+	  this->notify();
+	}
+
+      // make move tabu
+      tabu_list_m.tabu(base_t::working_solution_m, **best_movit);
+
+      // do the best non tabu move (unless overridden by aspiration
+      // criteria, of course)
+      (*best_movit)->apply(base_t::working_solution_m);
+
+      // call listeners
+      base_t::step_m = base_t::MOVE_MADE;
+      this->notify();
+      
+      aspiration_criteria_m.accept(base_t::working_solution_m, 
+				   **best_movit, 
+				   best_move_cost);
+      
+      if(base_t::solution_recorder_m.accept(base_t::working_solution_m))
+	{
+	  base_t::step_m = base_t::IMPROVEMENT_MADE;
+	  this->notify();
+	}
+
+      if(long_term_memory_m)
+	{
+	  long_term_memory_m->accept(base_t::working_solution_m, 
+				     **best_movit, 
+				     best_move_cost);
+	  if(long_term_memory_m->diversify(base_t::working_solution_m))
+	    {
+	      base_t::step_m = DIVERSIFICATION_MADE;
+	      this->notify();
+	    }
+	}
+
+      // call listeners
+      base_t::step_m = base_t::ITERATION_END;
+      this->notify();
+      
+    } // end while(!termination)
+  return SEARCH_TERMINATED;
+}
+
+// chain of responsibility
+
+inline void
+mets::tabu_list_chain::tabu(const feasible_solution& sol, const move& mov)
+{
+  if(next_m)
+    next_m->tabu(sol, mov);
+}
+
+inline bool
+mets::tabu_list_chain::is_tabu(const feasible_solution& sol, const move& mov) const
+{
+  if(next_m) 
+    return next_m->is_tabu(sol, mov);
+  else 
+    return false;
+}
+
+inline void
+mets::tabu_list_chain::save(std::ostream& os) const
+{
+  if(next_m)
+    next_m->save(os);
+}
+
+inline void
+mets::tabu_list_chain::load(std::istream& is)
+{
+  if(next_m)
+    next_m->load(is);
+}
+
+inline mets::simple_tabu_list::~simple_tabu_list()
+{ 
+  clear();
+}
+
+inline void
+mets::simple_tabu_list::clear()
+{ 
+  for(int s = oldest_m; s != -1; s = slots_m[s].next)
+    release(slots_m[s].move);
+  std::fill(table_m.begin(), table_m.end(), 0);
+  size_m = 0;
+  oldest_m = newest_m = -1;
+}
+
+inline void
+mets::simple_tabu_list::resize(unsigned int tenure)
+{
+  assert(size_m == 0);
+  slots_m.resize(tenure);
+  size_t positions = 2;
+  int bits = 1;
+  while(positions < 2 * static_cast<size_t>(tenure))
+    {
+      positions *= 2;
+      ++bits;
+    }
+  table_m.assign(positions, 0);
+  shift_m = 64 - bits;
+}
+
+inline void
+mets::simple_tabu_list::tenure(unsigned int tenure)
+{
+  // take the moves out (oldest first) and push them back
+  std::vector<const mana_move*> moves;
+  for(int s = oldest_m; s != -1; s = slots_m[s].next)
+    moves.push_back(slots_m[s].move);
+  size_m = 0;
+  oldest_m = newest_m = -1;
+  tabu_list_chain::tenure(tenure);
+  resize(tenure);
+  for(size_t ii = 0; ii != moves.size(); ++ii)
+    push(moves[ii]);
+}
+
+inline void
+mets::simple_tabu_list::tabu(const feasible_solution& sol, const move& mov)
+{
+  push(opposite(mana_cast(mov)));
+  tabu_list_chain::tabu(sol, mov);
+}
+
+inline void
+mets::simple_tabu_list::push(const mana_move* mc)
+{
+  const size_t hash = mc->hash();
+  size_t pos = find(*mc, hash);
+  if(pos != table_m.size())
+    {
+      // already tabu (can happen when aspiration criteria is met):
+      // it becomes the most recent
+      int s = table_m[pos] - 1;
+      release(mc);
+      if(s != newest_m)
+	{
+	  unlink(s);
+	  link(s);
+	}
+      return;
+    }
+
+  if(slots_m.empty())
+    {
+      release(mc);
+      return;
+    }
+
+  int s;
+  if(size_m < slots_m.size())
+    s = size_m++;
+  else
+    {
+      // forget the oldest move
+      s = oldest_m;
+      for(pos = home(slots_m[s].hash); 
+	  table_m[pos] != static_cast<unsigned int>(s + 1);
+	  pos = (pos + 1) & (table_m.size() - 1))
+	;
+      erase(pos);
+      unlink(s);
+      release(slots_m[s].move);
+    }
+  slots_m[s].move = mc;
+  slots_m[s].hash = hash;
+  link(s);
+  for(pos = home(hash); table_m[pos]; pos = (pos + 1) & (table_m.size() - 1))
+    ;
+  table_m[pos] = s + 1;
+}
+
+inline size_t
+mets::simple_tabu_list::find(const mana_move& mov, size_t hash) const
+{
+  const size_t mask = table_m.size() - 1;
+  for(size_t pos = home(hash); table_m[pos]; pos = (pos + 1) & mask)
+    {
+      const slot& s = slots_m[table_m[pos] - 1];
+      if(s.hash == hash && *s.move == mov)
+	return pos;
+    }
+  return table_m.size();
+}
+
+inline void
+mets::simple_tabu_list::erase(size_t pos)
+{
+  // linear probing deletion: shift back the following entries
+  // that would not be found anymore
+  const size_t mask = table_m.size() - 1;
+  size_t hole = pos;
+  for(size_t next = (hole + 1) & mask; table_m[next]; next = (next + 1) & mask)
+    {
+      size_t h = home(slots_m[table_m[next] - 1].hash);
+      if(((next - h) & mask) >= ((next - hole) & mask))
+	{
+	  table_m[hole] = table_m[next];
+	  hole = next;
+	}
+    }
+  table_m[hole] = 0;
+}
+
+inline void
+mets::simple_tabu_list::unlink(int s)
+{
+  slot& x = slots_m[s];
+  if(x.prev != -1) slots_m[x.prev].next = x.next; else oldest_m = x.next;
+  if(x.next != -1) slots_m[x.next].prev = x.prev; else newest_m = x.prev;
+}
+
+inline void
+mets::simple_tabu_list::link(int s)
+{
+  slots_m[s].prev = newest_m;
+  slots_m[s].next = -1;
+  if(newest_m != -1) slots_m[newest_m].next = s; else oldest_m = s;
+  newest_m = s;
+}
+
+inline void
+mets::simple_tabu_list::save(std::ostream& os) const
+{
+  write_binary(os, static_cast<size_t>(size_m));
+  for(int s = oldest_m; s != -1; s = slots_m[s].next)
+    slots_m[s].move->save(os);
+  tabu_list_chain::save(os);
+}
+
+inline void
+mets::simple_tabu_list::load(std::istream& is)
+{
+  if(!prototype_m)
+    throw std::runtime_error("A move prototype is needed to load the list.");
+  clear();
+  size_t size;
+  read_binary(is, size);
+  for(size_t ii = 0; ii != size; ++ii)
+    {
+      mana_move* mc = static_cast<mana_move*>(prototype_m->clone());
+      try {
+	mc->load(is);
+      } catch(...) {
+	delete mc;
+	throw;
+      }
+      push(mc);
+    }
+  tabu_list_chain::load(is);
+}
+
+inline mets::mana_move*
+mets::move_pool::opposite(const mana_move& mov)
+{
+  const void* tag = mov.tag();
+  if(tag)
+    {
+      move_vector* free = bucket(tag);
+      if(free && !free->empty() && mov.opposite_into(*free->back()))
+	{
+	  mana_move* m = free->back();
+	  free->pop_back();
+	  return m;
+	}
+    }
+  return mov.opposite_of();
+}
+
+inline void
+mets::move_pool::release(const mana_move* mov)
+{
+  const void* tag = mov->tag();
+  move_vector* free = tag ? bucket(tag) : 0;
+  if(tag && !free)
+    {
+      free_m.push_back(std::make_pair(tag, move_vector()));
+      free = &free_m.back().second;
+    }
+  if(free && free->size() < limit_m)
+    free->push_back(const_cast<mana_move*>(mov));
+  else
+    delete mov;
+}
+
+inline size_t
+mets::move_pool::size() const
+{
+  size_t count = 0;
+  for(size_t ii = 0; ii != free_m.size(); ++ii)
+    count += free_m[ii].second.size();
+  return count;
+}
+
+inline void
+mets::move_pool::clear()
+{
+  for(size_t ii = 0; ii != free_m.size(); ++ii)
+    for(size_t jj = 0; jj != free_m[ii].second.size(); ++jj)
+      delete free_m[ii].second[jj];
+  free_m.clear();
+}
+
+inline mets::move_pool::move_vector*
+mets::move_pool::bucket(const void* tag)
+{
+  for(size_t ii = 0; ii != free_m.size(); ++ii)
+    if(free_m[ii].first == tag)
+      return &free_m[ii].second;
+  return 0;
+}
+
+inline bool
+mets::simple_tabu_list::is_tabu(const feasible_solution& sol, const move& mov) const
+{
+  const mana_move& m = mana_cast(mov);
+  if(find(m, m.hash()) != table_m.size())
+    return true;
+
+  return tabu_list_chain::is_tabu(sol, mov);
+}
+
+//////////////////////////////////////////////////////////////////////////
+// long_term_memory_chain
+inline void
+mets::long_term_memory_chain::reset()
+{
+  if(next_m) 
+    next_m->reset();
+}
+
+inline mets::gol_type
+mets::long_term_memory_chain::penalty(const feasible_solution& fs, 
+				      const move& mov,
+				      gol_type eval) const
+{
+  if(next_m)
+    return next_m->penalty(fs, mov, eval);
+  else
+    return 0.0;
+}
+
+inline void
+mets::long_term_memory_chain::accept(const feasible_solution& fs, 
+				     const move& mov,
+				     gol_type eval)
+{
+  if(next_m) 
+    next_m->accept(fs, mov, eval);
+}
+
+inline bool
+mets::long_term_memory_chain::diversify(feasible_solution& fs)
+{
+  if(next_m)
+    return next_m->diversify(fs);
+  else
+    return false;
+}
+
+inline void
+mets::long_term_memory_chain::save(std::ostream& os) const
+{
+  if(next_m) 
+    next_m->save(os);
+}
+
+inline void
+mets::long_term_memory_chain::load(std::istream& is)
+{
+  if(next_m) 
+    next_m->load(is);
+}
+
+//////////////////////////////////////////////////////////////////////////
+// frequency_memory
+inline mets::frequency_memory::frequency_memory(int n, 
+						gol_type weight, 
+						int restart_after,
+						gol_type epsilon)
+  : long_term_memory_chain(), n_m(n), weight_m(weight), 
+    restart_after_m(restart_after), epsilon_m(epsilon),
+    frequency_m(n*n, 0), iterations_m(0), restarts_m(0), noimprove_m(0),
+    best_m(std::numeric_limits<gol_type>::max()), taken_m(n)
+{ }
+
+inline mets::frequency_memory::frequency_memory(long_term_memory_chain* next,
+						int n, 
+						gol_type weight, 
+						int restart_after,
+						gol_type epsilon)
+  : long_term_memory_chain(next), n_m(n), weight_m(weight), 
+    restart_after_m(restart_after), epsilon_m(epsilon),
+    frequency_m(n*n, 0), iterations_m(0), restarts_m(0), noimprove_m(0),
+    best_m(std::numeric_limits<gol_type>::max()), taken_m(n)
+{ }
+
+inline void
+mets::frequency_memory::reset()
+{
+  std::fill(frequency_m.begin(), frequency_m.end(), 0);
+  iterations_m = restarts_m = 0;
+  noimprove_m = 0;
+  best_m = std::numeric_limits<gol_type>::max();
+  long_term_memory_chain::reset();
+}
+
+inline mets::gol_type
+mets::frequency_memory::penalty(const feasible_solution& fs, 
+				const move& mov,
+				gol_type eval) const
+{
+  const permutation_problem& p = static_cast<const permutation_problem&>(fs);
+  gol_type penalty = long_term_memory_chain::penalty(fs, mov, eval);
+
+  // improving moves are never penalized
+  if(weight_m == 0.0 || iterations_m == 0 
+     || eval < p.cost_function() - epsilon_m)
+    return penalty;
+
+  const swap_elements& m = static_cast<const swap_elements&>(mov);
+  const std::vector<int>& pi = p.permutation();
+  unsigned int count = frequency(pi[m.first()], m.second())
+    + frequency(pi[m.second()], m.first());
+  return penalty + weight_m * count / iterations_m;
+}
+
+inline void
+mets::frequency_memory::accept(const feasible_solution& fs, 
+			       const move& mov,
+			       gol_type eval)
+{
+  const permutation_problem& p = static_cast<const permutation_problem&>(fs);
+  const swap_elements& m = static_cast<const swap_elements&>(mov);
+  const std::vector<int>& pi = p.permutation();
+  ++frequency_m[pi[m.first()]*n_m + m.first()];
+  ++frequency_m[pi[m.second()]*n_m + m.second()];
+  ++iterations_m;
+
+  if(p.cost_function() < best_m - epsilon_m)
+    {
+      best_m = p.cost_function();
+      noimprove_m = 0;
+    }
+  else
+    ++noimprove_m;
+
+  long_term_memory_chain::accept(fs, mov, eval);
+}
+
+inline bool
+mets::frequency_memory::diversify(feasible_solution& fs)
+{
+  if(restart_after_m <= 0 || noimprove_m < restart_after_m)
+    return long_term_memory_chain::diversify(fs);
+
+  // greedily assign each element to the free position it had the
+  // least number of times
+  permutation_problem& p = static_cast<permutation_problem&>(fs);
+  std::fill(taken_m.begin(), taken_m.end(), false);
+  for(int element = 0; element != n_m; ++element)
+    {
+      int best = -1;
+      for(int position = 0; position != n_m; ++position)
+	if(!taken_m[position] && 
+	   (best < 0 || frequency(element, position) < frequency(element, best)))
+	  best = position;
+      taken_m[best] = true;
+      p.pi_m[best] = element;
+    }
+  p.update_cost();
+  noimprove_m = 0;
+  ++restarts_m;
+  return true;
+}
+
+inline void
+mets::frequency_memory::save(std::ostream& os) const
+{
+  write_binary(os, frequency_m);
+  write_binary(os, iterations_m);
+  write_binary(os, restarts_m);
+  write_binary(os, noimprove_m);
+  write_binary(os, best_m);
+  long_term_memory_chain::save(os);
+}
+
+inline void
+mets::frequency_memory::load(std::istream& is)
+{
+  read_binary_fixed(is, frequency_m);
+  read_binary(is, iterations_m);
+  read_binary(is, restarts_m);
+  read_binary(is, noimprove_m);
+  read_binary(is, best_m);
+  long_term_memory_chain::load(is);
+}
+
+//////////////////////////////////////////////////////////////////////////
+// visited_set
+inline mets::visited_set::visited_set(unsigned int capacity)
+  : ring_m(), next_m(0), size_m(0), keys_m(), counts_m(), mask_m(0)
+{ 
+  this->capacity(capacity); 
+}
+
+inline void
+mets::visited_set::capacity(unsigned int capacity)
+{
+  // a power of two table at most half full
+  size_t buckets = 2;
+  while(buckets < 2 * static_cast<size_t>(capacity))
+    buckets <<= 1;
+  ring_m.assign(capacity, 0);
+  keys_m.assign(buckets, 0);
+  counts_m.assign(buckets, 0);
+  mask_m = buckets - 1;
+  next_m = size_m = 0;
+}
+
+inline void
+mets::visited_set::clear()
+{
+  std::fill(counts_m.begin(), counts_m.end(), 0);
+  next_m = size_m = 0;
+}
+
+inline bool
+mets::visited_set::contains(size_t fingerprint) const
+{
+  for(size_t ii = home(fingerprint); counts_m[ii]; ii = (ii + 1) & mask_m)
+    if(keys_m[ii] == fingerprint)
+      return true;
+  return false;
+}
+
+inline void
+mets::visited_set::insert(size_t fingerprint)
+{
+  if(ring_m.empty())
+    return;
+
+  // when full, the oldest fingerprint is where the next one goes
+  if(size_m == ring_m.size())
+    {
+      erase(ring_m[next_m]);
+      --size_m;
+    }
+  ring_m[next_m] = fingerprint;
+  if(++next_m == ring_m.size()) 
+    next_m = 0;
+  ++size_m;
+
+  size_t ii = home(fingerprint);
+  while(counts_m[ii] && keys_m[ii] != fingerprint)
+    ii = (ii + 1) & mask_m;
+  keys_m[ii] = fingerprint;
+  ++counts_m[ii];
+}
+
+inline void
+mets::visited_set::erase(size_t fingerprint)
+{
+  size_t hole = home(fingerprint);
+  while(keys_m[hole] != fingerprint)
+    hole = (hole + 1) & mask_m;
+  if(--counts_m[hole])
+    return;
+
+  // backward shift deletion: move back the entries of the cluster
+  // whose home is not between the hole and their current bucket
+  for(size_t ii = (hole + 1) & mask_m; counts_m[ii]; ii = (ii + 1) & mask_m)
+    {
+      size_t h = home(keys_m[ii]);
+      bool stays = hole < ii ? (h > hole && h <= ii) : (h > hole || h <= ii);
+      if(!stays)
+	{
+	  keys_m[hole] = keys_m[ii];
+	  counts_m[hole] = counts_m[ii];
+	  counts_m[ii] = 0;
+	  hole = ii;
+	}
+    }
+}
+
+inline void
+mets::visited_set::save(std::ostream& os) const
+{
+  // oldest first
+  unsigned int capacity = ring_m.size();
+  write_binary(os, capacity);
+  write_binary(os, size_m);
+  for(unsigned int ii = 0; ii != size_m; ++ii)
+    write_binary(os, ring_m[(next_m + capacity - size_m + ii) % capacity]);
+}
+
+inline void
+mets::visited_set::load(std::istream& is)
+{
+  unsigned int capacity, size;
+  read_binary(is, capacity);
+  read_binary(is, size);
+  this->capacity(capacity);
+  for(unsigned int ii = 0; ii != size; ++ii)
+    {
+      size_t fingerprint;
+      read_binary(is, fingerprint);
+      insert(fingerprint);
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////
+// solution_tabu_list
+inline void
+mets::solution_tabu_list::tabu(const feasible_solution& sol, const move& mov)
+{
+  visited_m.insert(static_cast<const permutation_problem&>(sol).fingerprint());
+  tabu_list_chain::tabu(sol, mov);
+}
+
+inline bool
+mets::solution_tabu_list::is_tabu(const feasible_solution& sol, 
+				  const move& mov) const
+{
+  const permutation_problem& p = static_cast<const permutation_problem&>(sol);
+  if(visited_m.contains(static_cast<const permutation_move&>(mov).fingerprint(p)))
     return true;
+  return tabu_list_chain::is_tabu(sol, mov);
+}
+
+//////////////////////////////////////////////////////////////////////////
+// assignment_tabu_list
+inline void
+mets::assignment_tabu_list::tabu(const feasible_solution& sol, 
+				 const move& mov)
+{
+  const assignment_problem& p = static_cast<const assignment_problem&>(sol);
+  int item = static_cast<const change_value&>(mov).item();
+  ++iteration_m;
+  expiry_m[size_t(item) * k_m + p.values()[item]] = iteration_m + tenure();
+  tabu_list_chain::tabu(sol, mov);
+}
 
+inline bool
+mets::assignment_tabu_list::is_tabu(const feasible_solution& sol, 
+				    const move& mov) const
+{
+  const change_value& m = static_cast<const change_value&>(mov);
+  if(expiry_m[size_t(m.item()) * k_m + m.value()] > iteration_m)
+    return true;
   return tabu_list_chain::is_tabu(sol, mov);
 }
 
@@ -578,6 +1958,18 @@ mets::aspiration_criteria_chain::operator()(const feasible_solution& fs,
     return false;
 }
 
+inline void 
+mets::aspiration_criteria_chain::save(std::ostream& os) const
+{
+  if(next_m) next_m->save(os);
+}
+
+inline void 
+mets::aspiration_criteria_chain::load(std::istream& is)
+{
+  if(next_m) next_m->load(is);
+}
+
 //////////////////////////////////////////////////////////////////////////
 // best_ever_criteria
 inline mets::best_ever_criteria::best_ever_criteria(double tolerance) 
@@ -604,7 +1996,7 @@ mets::best_ever_criteria::accept(const feasible_solution& fs,
 				 const move& mov, 
 				 gol_type eval) 
 {
-  best_m = std::min(dynamic_cast<const evaluable_solution&>(fs).cost_function(), best_m);
+  best_m = std::min(evaluable_cast(fs).cost_function(), best_m);
   aspiration_criteria_chain::accept(fs, mov, eval);
 }  
 
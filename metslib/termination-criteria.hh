@@ -22,6 +22,16 @@
 #ifndef METS_TERMINATION_CRITERIA_HH_
 #define METS_TERMINATION_CRITERIA_HH_
 
+#if __cplusplus >= 201103L
+#  include <atomic>
+#endif
+
+#if defined (METSLIB_HAVE_CLOCK_GETTIME)
+#  include <time.h>
+#elif defined (METSLIB_HAVE_SYS_TIME_H)
+#  include <sys/time.h>
+#endif
+
 namespace mets {
  
   /// @defgroup common Termination criteria
@@ -30,7 +40,10 @@ namespace mets {
   /// @brief Function object expressing a termination criteria
   ///
   /// The search loop ends when the termination criteria is met.
-  class termination_criteria_chain
+  ///
+  /// The state of the chain can be saved and restored to checkpoint
+  /// a search (see mets::checkpoint).
+  class termination_criteria_chain : public serializable
   {
   public:
     /// @brief Constructor.
@@ -65,6 +78,18 @@ namespace mets {
     ///
     virtual void reset();
 
+    /// @brief Save the state of the criterion.
+    ///
+    /// (chain of responsibility)
+    ///
+    virtual void save(std::ostream& os) const;
+
+    /// @brief Restore the state of the criterion.
+    ///
+    /// (chain of responsibility)
+    ///
+    virtual void load(std::istream& is);
+
   protected:
     termination_criteria_chain* next_m;
   };
@@ -104,6 +129,14 @@ namespace mets {
     reset() 
     { iterations_m = max_m; termination_criteria_chain::reset(); }
 
+    void 
+    save(std::ostream& os) const
+    { write_binary(os, iterations_m); termination_criteria_chain::save(os); }
+
+    void 
+    load(std::istream& is)
+    { read_binary(is, iterations_m); termination_criteria_chain::load(is); }
+
   protected:
     int max_m;
     int iterations_m;
@@ -151,6 +184,20 @@ namespace mets {
       termination_criteria_chain::reset();      
     }
 
+    void save(std::ostream& os) const
+    { write_binary(os, best_cost_m); write_binary(os, iterations_left_m);
+      write_binary(os, total_iterations_m); write_binary(os, resets_m);
+      write_binary(os, second_guess_m);
+      termination_criteria_chain::save(os);
+    }
+
+    void load(std::istream& is)
+    { read_binary(is, best_cost_m); read_binary(is, iterations_left_m);
+      read_binary(is, total_iterations_m); read_binary(is, resets_m);
+      read_binary(is, second_guess_m);
+      termination_criteria_chain::load(is);
+    }
+
     int second_guess() { return second_guess_m; }
     int iteration() { return total_iterations_m; }
     int resets() { return resets_m; }
@@ -190,7 +237,7 @@ namespace mets {
     operator()(const feasible_solution& fs)
     { 
       mets::gol_type current_cost = 
-	dynamic_cast<const evaluable_solution&>(fs).cost_function();
+	evaluable_cast(fs).cost_function();
       
       if(current_cost < level_m + epsilon_m) 
 	return true; 
@@ -206,6 +253,256 @@ namespace mets {
     gol_type epsilon_m;
   };
 
+  /// @brief Seconds elapsed from an unspecified point in the past on
+  /// a monotonic clock.
+  ///
+  /// Uses a coarse clock when available (CLOCK_MONOTONIC_COARSE on
+  /// Linux is read from memory, without a system call, and has a
+  /// resolution of some milliseconds), gettimeofday() or std::clock()
+  /// otherwise.
+  double
+  wall_time();
+
+  /// @brief Seconds of processor time used by the process.
+  double
+  cpu_time();
+
+  /// @brief Base class of the criteria terminating the search after
+  /// a time budget.
+  ///
+  /// Reading a clock is cheap but not free: the clock is only read
+  /// every stride() calls. The stride is calibrated at run time so
+  /// that the clock is read about every "interval" seconds whatever
+  /// the duration of an iteration, the search will end at most a few
+  /// intervals after the deadline.
+  ///
+  /// The clock starts on the first call (not on construction).
+  class time_termination_criteria 
+    : public termination_criteria_chain
+  {
+  public:
+    /// @brief Ctor.
+    ///
+    /// @param budget Seconds before termination.
+    /// @param interval Seconds between two readings of the clock.
+    time_termination_criteria(double budget, double interval = 0.01)
+      : termination_criteria_chain(),
+	budget_m(budget), interval_m(interval), start_m(0.0), 
+	last_m(0.0), spent_m(0.0), stride_m(1), countdown_m(0), 
+	started_m(false), expired_m(false)
+    { }
+
+    time_termination_criteria
+    (termination_criteria_chain* next, double budget, double interval = 0.01)
+      : termination_criteria_chain(next),
+	budget_m(budget), interval_m(interval), start_m(0.0), 
+	last_m(0.0), spent_m(0.0), stride_m(1), countdown_m(0), 
+	started_m(false), expired_m(false)
+    { }
+
+    bool 
+    operator()(const feasible_solution& fs);
+
+    void 
+    reset() 
+    { 
+      spent_m = 0.0; stride_m = 1; countdown_m = 0; 
+      started_m = expired_m = false;
+      termination_criteria_chain::reset(); 
+    }
+
+    /// @brief Saves the time spent so far: a resumed search will only
+    /// use the rest of the budget.
+    void
+    save(std::ostream& os) const
+    { write_binary(os, elapsed()); termination_criteria_chain::save(os); }
+
+    void
+    load(std::istream& is)
+    { 
+      read_binary(is, spent_m); 
+      started_m = expired_m = false; 
+      termination_criteria_chain::load(is);
+    }
+
+    /// @brief Seconds spent since the first call (as of the last
+    /// reading of the clock).
+    double 
+    elapsed() const
+    { return started_m ? last_m - start_m : spent_m; }
+
+    /// @brief The time budget.
+    double
+    budget() const
+    { return budget_m; }
+
+    /// @brief Calls between two readings of the clock.
+    unsigned int 
+    stride() const
+    { return stride_m; }
+
+  protected:
+    /// @brief The clock (in seconds).
+    virtual double 
+    now() const = 0;
+
+    double budget_m;
+    double interval_m;
+    double start_m;
+    double last_m;
+    double spent_m;
+    unsigned int stride_m;
+    unsigned int countdown_m;
+    bool started_m;
+    bool expired_m;
+  };
+
+  /// @brief Terminates the search after a wall clock time budget
+  /// (see mets::time_termination_criteria).
+  class wallclock_termination_criteria 
+    : public time_termination_criteria
+  {
+  public:
+    wallclock_termination_criteria(double budget, double interval = 0.01)
+      : time_termination_criteria(budget, interval) 
+    { }
+
+    wallclock_termination_criteria
+    (termination_criteria_chain* next, double budget, double interval = 0.01)
+      : time_termination_criteria(next, budget, interval) 
+    { }
+
+  protected:
+    double 
+    now() const
+    { return wall_time(); }
+  };
+
+  /// @brief Terminates the search after a processor time budget (see
+  /// mets::time_termination_criteria).
+  class cputime_termination_criteria 
+    : public time_termination_criteria
+  {
+  public:
+    cputime_termination_criteria(double budget, double interval = 0.01)
+      : time_termination_criteria(budget, interval) 
+    { }
+
+    cputime_termination_criteria
+    (termination_criteria_chain* next, double budget, double interval = 0.01)
+      : time_termination_criteria(next, budget, interval) 
+    { }
+
+  protected:
+    double 
+    now() const
+    { return cpu_time(); }
+  };
+
+  /// @brief A flag used to ask a running search to stop.
+  ///
+  /// The flag can be raised by any thread (e.g. a timeout handler)
+  /// while the search polls it through a
+  /// mets::cancellation_termination_criteria. Reading the flag is a
+  /// plain load on common architectures.
+  ///
+  /// When the search stops the best solution found so far is, as
+  /// usual, in the solution recorder.
+  class cancellation_token
+  {
+  public:
+    cancellation_token() : flag_m(0) 
+    { }
+
+    /// purposely not implemented (see Effective C++)
+    cancellation_token(const cancellation_token&);
+    /// purposely not implemented (see Effective C++)
+    cancellation_token& operator=(const cancellation_token&);
+
+    /// @brief Ask the searches polling this token to stop (thread
+    /// safe).
+    void 
+    cancel()
+    {
+#if __cplusplus >= 201103L
+      flag_m.store(1, std::memory_order_release);
+#elif defined (__ATOMIC_RELEASE)
+      __atomic_store_n(&flag_m, 1, __ATOMIC_RELEASE);
+#elif defined (__GNUC__)
+      __sync_synchronize();
+      flag_m = 1;
+#else
+      flag_m = 1;
+#endif
+    }
+
+    /// @brief True if cancel() was called (thread safe).
+    bool 
+    cancelled() const
+    {
+#if __cplusplus >= 201103L
+      return flag_m.load(std::memory_order_acquire) != 0;
+#elif defined (__ATOMIC_ACQUIRE)
+      return __atomic_load_n(&flag_m, __ATOMIC_ACQUIRE) != 0;
+#else
+      return flag_m != 0;
+#endif
+    }
+
+    /// @brief Lower the flag so that the token can be reused (call
+    /// this when no search is polling the token).
+    void 
+    reset()
+    { 
+#if __cplusplus >= 201103L
+      flag_m.store(0);
+#else
+      flag_m = 0; 
+#endif
+    }
+
+  protected:
+#if __cplusplus >= 201103L
+    std::atomic<int> flag_m;
+#else
+    volatile int flag_m;
+#endif
+  };
+
+  /// @brief Terminates the search when a mets::cancellation_token is
+  /// cancelled.
+  class cancellation_termination_criteria
+    : public termination_criteria_chain
+  {
+  public:
+    /// @brief Ctor.
+    ///
+    /// @param token The token to poll (must outlive this object).
+    explicit
+    cancellation_termination_criteria(const cancellation_token& token)
+      : termination_criteria_chain(), token_m(token)
+    { }
+
+    cancellation_termination_criteria
+    (termination_criteria_chain* next, const cancellation_token& token)
+      : termination_criteria_chain(next), token_m(token)
+    { }
+
+    bool 
+    operator()(const feasible_solution& fs)
+    { 
+      if(token_m.cancelled())
+	return true;
+      return termination_criteria_chain::operator()(fs); 
+    }
+
+    void reset() 
+    { termination_criteria_chain::reset(); }
+
+  protected:
+    const cancellation_token& token_m;
+  };
+
   /// The mets::forever termination criterion will never terminate the
   /// search.
   ///
@@ -247,12 +544,99 @@ mets::termination_criteria_chain::reset()
   if(next_m) next_m->reset();
 }
 
+//________________________________________________________________________
+inline void
+mets::termination_criteria_chain::save(std::ostream& os) const
+{
+  if(next_m) next_m->save(os);
+}
+
+//________________________________________________________________________
+inline void
+mets::termination_criteria_chain::load(std::istream& is)
+{
+  if(next_m) next_m->load(is);
+}
+
+//________________________________________________________________________
+inline double
+mets::wall_time()
+{
+#if defined (METSLIB_HAVE_CLOCK_GETTIME)
+  timespec ts;
+#  if defined (CLOCK_MONOTONIC_COARSE)
+  clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+#  else
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+#  endif
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+#elif defined (METSLIB_HAVE_SYS_TIME_H)
+  timeval tv;
+  gettimeofday(&tv, 0);
+  return tv.tv_sec + tv.tv_usec * 1e-6;
+#else
+  return static_cast<double>(std::clock()) / CLOCKS_PER_SEC;
+#endif
+}
+
+//________________________________________________________________________
+inline double
+mets::cpu_time()
+{
+#if defined (METSLIB_HAVE_CLOCK_GETTIME) && defined (CLOCK_PROCESS_CPUTIME_ID)
+  timespec ts;
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+#else
+  return static_cast<double>(std::clock()) / CLOCKS_PER_SEC;
+#endif
+}
+
+//________________________________________________________________________
+inline bool 
+mets::time_termination_criteria::operator()(const feasible_solution& fs)
+{
+  if(expired_m)
+    return true;
+
+  if(!started_m)
+    {
+      // resumed searches start with the time already spent
+      last_m = now();
+      start_m = last_m - spent_m;
+      started_m = true;
+      countdown_m = stride_m;
+    }
+  else if(--countdown_m == 0)
+    {
+      double previous = last_m;
+      last_m = now();
+      // calibrate the stride to read the clock about every interval
+      // seconds (a coarse clock may not have advanced yet: that only
+      // means we can read it less often)
+      double lapse = last_m - previous;
+      if(lapse < interval_m / 2 && stride_m < (1u << 30))
+	stride_m *= 2;
+      else if(lapse > interval_m * 2 && stride_m > 1)
+	stride_m /= 2;
+      countdown_m = stride_m;
+    }
+
+  if(last_m - start_m >= budget_m)
+    {
+      expired_m = true;
+      return true;
+    }
+  
+  return termination_criteria_chain::operator()(fs);
+}
+
 //________________________________________________________________________
 inline bool 
 mets::noimprove_termination_criteria::operator()(const feasible_solution& fs)
 {
   mets::gol_type current_cost = 
-    dynamic_cast<const evaluable_solution&>(fs).cost_function();
+    evaluable_cast(fs).cost_function();
   if(current_cost < best_cost_m - epsilon_m)
     {
       best_cost_m = current_cost;
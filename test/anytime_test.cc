@@ -0,0 +1,124 @@
+// anytime solution recorder regression
+#include <metslib/mets.hh>
+
+using namespace std;
+
+#if defined (METSLIB_HAVE_UNORDERED_MAP) && !defined (METSLIB_TR1_MIXED_NAMESPACE)
+typedef std::mt19937 generator;
+#else
+typedef std::tr1::mt19937 generator;
+#endif
+
+class q : public mets::permutation_problem
+{
+public:
+  q(int n) : permutation_problem(n)
+  { }
+
+  mets::gol_type compute_cost() const
+  {
+    mets::gol_type c = 0.0;
+    for(unsigned int ii = 0; ii != pi_m.size(); ++ii)
+      c += ii * pi_m[ii];
+    return c;
+  }
+
+  mets::gol_type evaluate_swap(int i, int j) const
+  { return (i - j) * (pi_m[j] - pi_m[i]); }
+};
+
+struct searcher
+{
+  typedef mets::swap_neighborhood<generator> neighborhood;
+
+  searcher()
+    : rng(7), working(200), best(200), front(200), back(200),
+      recorder(best), anytime(recorder, front, back), moves(rng, 50),
+      tabus(20), aspiration(), termination(3000),
+      search(working, anytime, moves, tabus, aspiration, termination)
+  {
+    mets::random_shuffle(working, rng);
+    best.copy_from(working);
+  }
+
+  void run()
+  {
+    search.search();
+    anytime.close();
+  }
+
+  generator rng;
+  q working, best, front, back;
+  mets::best_ever_solution recorder;
+  mets::anytime_solution_recorder anytime;
+  neighborhood moves;
+  mets::simple_tabu_list tabus;
+  mets::best_ever_criteria aspiration;
+  mets::iteration_termination_criteria termination;
+  mets::tabu_search<neighborhood> search;
+};
+
+extern "C" void* run_search(void* s)
+{
+  static_cast<searcher*>(s)->run();
+  return 0;
+}
+
+int main()
+{
+  searcher s;
+  q seen(200);
+
+  if(s.anytime.latest(seen) != 0)
+    {
+      cerr << "Something published before the search." << endl;
+      return 1;
+    }
+
+#if defined (METSLIB_HAVE_PTHREAD_H)
+  pthread_t thread;
+  if(pthread_create(&thread, 0, run_search, &s) != 0)
+    {
+      cerr << "Unable to start the search thread." << endl;
+      return 1;
+    }
+#else
+  s.run();
+#endif
+
+  // consume improvements while the search runs: each one must be
+  // newer and better than the previous one
+  unsigned long version = 0;
+  unsigned int received = 0;
+  mets::gol_type last = std::numeric_limits<mets::gol_type>::max();
+  for(;;)
+    {
+      unsigned long v = s.anytime.wait(version, seen);
+      if(v == version)
+	break;
+      if(v < version || seen.cost_function() >= last
+	 || seen.cost_function() != seen.compute_cost())
+	{
+	  cerr << "Inconsistent solution published." << endl;
+	  return 1;
+	}
+      last = seen.cost_function();
+      version = v;
+      ++received;
+    }
+
+#if defined (METSLIB_HAVE_PTHREAD_H)
+  pthread_join(thread, 0);
+#endif
+
+  if(!s.anytime.closed() || received == 0
+     || version != s.anytime.version()
+     || last != s.best.cost_function()
+     || s.anytime.best_cost() != s.best.cost_function())
+    {
+      cerr << "The last published solution is not the best one." << endl;
+      return 1;
+    }
+
+  return 0;
+}
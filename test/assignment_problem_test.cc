@@ -0,0 +1,150 @@
+// assignment problem regression
+#include <metslib/mets.hh>
+
+using namespace std;
+
+#if defined (METSLIB_HAVE_UNORDERED_MAP) && !defined (METSLIB_TR1_MIXED_NAMESPACE)
+typedef std::mt19937 generator;
+#else
+typedef std::tr1::mt19937 generator;
+#endif
+
+// graph coloring: the cost is the number of edges with both ends of
+// the same color. The graph has a planted k-coloring.
+class coloring : public mets::assignment_problem
+{
+public:
+  coloring(int n, int k, int edges)
+    : assignment_problem(n, k), adjacency_m(n)
+  {
+    generator rng(n);
+    while(edges)
+      {
+	int a = rng() % n;
+	int b = rng() % n;
+	if(a % k == b % k)
+	  continue;
+	adjacency_m[a].push_back(b);
+	adjacency_m[b].push_back(a);
+	--edges;
+      }
+  }
+
+  mets::gol_type compute_cost() const
+  {
+    mets::gol_type c = 0.0;
+    for(unsigned int ii = 0; ii != adjacency_m.size(); ++ii)
+      for(unsigned int jj = 0; jj != adjacency_m[ii].size(); ++jj)
+	c += values_m[ii] == values_m[adjacency_m[ii][jj]];
+    return c / 2;
+  }
+
+  mets::gol_type evaluate_assign(int i, int v) const
+  {
+    mets::gol_type delta = 0.0;
+    for(unsigned int jj = 0; jj != adjacency_m[i].size(); ++jj)
+      {
+	int other = values_m[adjacency_m[i][jj]];
+	delta += (other == v) - (other == values_m[i]);
+      }
+    return delta;
+  }
+
+private:
+  std::vector<std::vector<int> > adjacency_m;
+};
+
+int main()
+{
+  const int n = 60;
+  const int k = 3;
+  generator rng(1);
+  coloring working(n, k, 180);
+  mets::random_assign(working, rng);
+
+  // incremental cost
+  mets::change_value_neighborhood<generator> sample(rng, 50);
+  for(int ii = 0; ii != 20; ++ii)
+    {
+      sample.refresh(working);
+      for(mets::move_manager::iterator it = sample.begin();
+	  it != sample.end(); ++it)
+	{
+	  const mets::change_value& m =
+	    static_cast<const mets::change_value&>(**it);
+	  if(working.values()[m.item()] == m.value())
+	    {
+	      cerr << "Sampled move does not change the value." << endl;
+	      return 1;
+	    }
+	}
+      (*sample.begin())->apply(working);
+    }
+  if(working.cost_function() != working.compute_cost())
+    {
+      cerr << "Incremental cost: " << working.cost_function()
+	   << " != " << working.compute_cost() << endl;
+      return 1;
+    }
+
+  // the full neighborhood skips the current values
+  mets::change_value_full_neighborhood full(n, k);
+  full.refresh(working);
+  if(full.size() != static_cast<size_t>(n * (k - 1)))
+    {
+      cerr << "Wrong full neighborhood size." << endl;
+      return 1;
+    }
+  for(mets::move_manager::iterator it = full.begin(); it != full.end(); ++it)
+    {
+      const mets::change_value& m =
+	static_cast<const mets::change_value&>(**it);
+      if(working.values()[m.item()] == m.value())
+	{
+	  cerr << "Full neighborhood move does not change the value." << endl;
+	  return 1;
+	}
+    }
+
+  // an item cannot go back to the value it left for tenure iterations
+  mets::assignment_tabu_list tabus(n, k, 3);
+  mets::change_value leave(0, (working.values()[0] + 1) % k);
+  mets::change_value back(0, working.values()[0]);
+  mets::change_value other(1, working.values()[0]);
+  tabus.tabu(working, leave);
+  leave.apply(working);
+  if(!tabus.is_tabu(working, back) || tabus.is_tabu(working, other))
+    {
+      cerr << "Failed tabu status test." << endl;
+      return 1;
+    }
+  tabus.tabu(working, other);
+  tabus.tabu(working, other);
+  bool still_tabu = tabus.is_tabu(working, back);
+  tabus.tabu(working, other);
+  if(!still_tabu || tabus.is_tabu(working, back))
+    {
+      cerr << "Failed tabu expiry test." << endl;
+      return 1;
+    }
+
+  // a tabu search finds the planted coloring
+  coloring best(n, k, 180);
+  best.copy_from(working);
+  mets::best_ever_solution recorder(best);
+  mets::assignment_tabu_list tabu_list(n, k, 7);
+  mets::best_ever_criteria aspiration;
+  mets::iteration_termination_criteria iterations(5000);
+  mets::threshold_termination_criteria termination(&iterations, 0.0);
+  mets::tabu_search<mets::change_value_full_neighborhood>
+    search(working, recorder, full, tabu_list, aspiration, termination);
+  search.search();
+  if(best.cost_function() != 0.0 || best.compute_cost() != 0.0)
+    {
+      cerr << "Best cost: " << best.cost_function() << endl;
+      cerr << "Failed tabu search test." << endl;
+      return 1;
+    }
+
+  return 0;
+}
@@ -0,0 +1,137 @@
+// bit vector problem regression
+#include <metslib/mets.hh>
+
+using namespace std;
+
+#if defined (METSLIB_HAVE_UNORDERED_MAP) && !defined (METSLIB_TR1_MIXED_NAMESPACE)
+typedef std::mt19937 generator;
+#else
+typedef std::tr1::mt19937 generator;
+#endif
+
+// quadratic unconstrained binary optimization: the cost is the sum
+// of q[i][j] for each pair of bits i, j set (i == j included)
+class qubo : public mets::bitvector_problem
+{
+public:
+  qubo(int n) : bitvector_problem(n), q_m(n*n)
+  {
+    generator rng(n);
+    for(int ii = 0; ii != n; ++ii)
+      for(int jj = ii; jj != n; ++jj)
+	q_m[ii*n+jj] = q_m[jj*n+ii] = static_cast<int>(rng() % 21) - 10;
+  }
+
+  mets::gol_type compute_cost() const
+  {
+    mets::gol_type c = 0.0;
+    for(int ii = 0; ii != n_m; ++ii)
+      if(bit(ii))
+	for(int jj = 0; jj != n_m; ++jj)
+	  if(bit(jj))
+	    c += q_m[ii*n_m+jj];
+    return c;
+  }
+
+  mets::gol_type evaluate_flip(int i) const
+  {
+    mets::gol_type d = q_m[i*n_m+i];
+    for(int jj = 0; jj != n_m; ++jj)
+      if(jj != i && bit(jj))
+	d += 2 * q_m[i*n_m+jj];
+    return bit(i) ? -d : d;
+  }
+
+protected:
+  // only the pairs with i change
+  void update_deltas(int i)
+  {
+    const int sign = bit(i) ? 1 : -1;
+    for(int jj = 0; jj != n_m; ++jj)
+      if(jj != i)
+	deltas_m[jj] += (bit(jj) ? -2 : 2) * sign * q_m[i*n_m+jj];
+    deltas_m[i] = -deltas_m[i];
+  }
+
+  std::vector<int> q_m;
+};
+
+// a one flip tabu search
+mets::gol_type search(qubo& working, bool cached, std::vector<bool>& best_bits)
+{
+  const int n = working.size();
+  working.cache_deltas(cached);
+  qubo best(n);
+  best.copy_from(working);
+  mets::best_ever_solution recorder(best);
+  mets::flip_full_neighborhood moves(n);
+  mets::flip_tabu_list tabus(n, 7);
+  mets::best_ever_criteria aspiration;
+  mets::iteration_termination_criteria termination(500);
+  mets::tabu_search<mets::flip_full_neighborhood>
+    ts(working, recorder, moves, tabus, aspiration, termination);
+  ts.search();
+  best_bits.resize(n);
+  for(int ii = 0; ii != n; ++ii)
+    best_bits[ii] = best.bit(ii);
+  return best.cost_function() == best.compute_cost()
+    ? best.cost_function() : 1e30;
+}
+
+int main()
+{
+  const int n = 100;
+  generator rng(3);
+  qubo a(n), b(n);
+  mets::random_bits(a, rng);
+  b.copy_from(a);
+
+  // packed words, popcount and distance
+  size_t set = 0;
+  for(int ii = 0; ii != n; ++ii)
+    set += a.bit(ii);
+  if(a.words().size() != 2 || a.count() != set || (a.words()[1] >> 36) != 0)
+    {
+      cerr << "Failed packing test." << endl;
+      return 1;
+    }
+  b.apply_flip(3); b.apply_flip(70); b.apply_flip(99);
+  if(mets::hamming_distance(a, b) != 3)
+    {
+      cerr << "Failed distance test." << endl;
+      return 1;
+    }
+
+  // the cached deltas follow the flips
+  b.cache_deltas(true);
+  for(int ii = 0; ii != 200; ++ii)
+    {
+      b.apply_flip(rng() % n);
+      for(int jj = 0; jj != n; ++jj)
+	if(b.flip_delta(jj) != b.evaluate_flip(jj))
+	  {
+	    cerr << "Wrong cached delta for bit " << jj << endl;
+	    return 1;
+	  }
+    }
+  if(b.cost_function() != b.compute_cost())
+    {
+      cerr << "Incremental cost: " << b.cost_function()
+	   << " != " << b.compute_cost() << endl;
+      return 1;
+    }
+
+  // the search is the same with and without the cache
+  b.copy_from(a);
+  std::vector<bool> bits_a, bits_b;
+  mets::gol_type cost_a = search(a, false, bits_a);
+  mets::gol_type cost_b = search(b, true, bits_b);
+  if(cost_a != cost_b || bits_a != bits_b || cost_a >= 0)
+    {
+      cerr << "Costs: " << cost_a << " " << cost_b << endl;
+      cerr << "Failed tabu search test." << endl;
+      return 1;
+    }
+
+  return 0;
+}
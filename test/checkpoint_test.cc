@@ -0,0 +1,276 @@
+// checkpoint and resume regression
+#include <metslib/mets.hh>
+#include "qap.hh"
+
+using namespace std;
+
+// everything needed by a tabu search, built from scratch
+struct run
+{
+  typedef mets::swap_neighborhood<generator> neighborhood;
+
+  generator rng;
+  mets::zobrist_table table;
+  qap working;
+  qap best;
+  mets::best_ever_solution recorder;
+  neighborhood moves;
+  mets::solution_tabu_list solutions;
+  mets::simple_tabu_list tabus;
+  mets::swap_elements prototype;
+  mets::best_ever_criteria aspiration;
+  mets::iteration_termination_criteria iterations;
+  mets::noimprove_termination_criteria noimprove;
+  mets::frequency_memory memory;
+  mets::serializable_generator<generator> srng;
+  mets::checkpoint ckp;
+  mets::tabu_search<neighborhood> search;
+
+  run()
+    : rng(42), table(20, rng), working(20), best(20), recorder(best),
+      moves(rng, 40), solutions(5), tabus(&solutions, 10), prototype(0, 0),
+      aspiration(), iterations(400), noimprove(&iterations, 200),
+      memory(20, 50.0, 60), srng(rng), ckp(),
+      search(working, recorder, moves, tabus, aspiration, noimprove, memory)
+  {
+    working.use_fingerprint(table);
+    best.use_fingerprint(table);
+    tabus.move_prototype(prototype);
+    mets::random_shuffle(working, rng);
+    best.copy_from(working);
+    ckp.add(working);
+    ckp.add(best);
+    ckp.add(tabus);
+    ckp.add(aspiration);
+    ckp.add(noimprove);
+    ckp.add(memory);
+    ckp.add(srng);
+  }
+};
+
+// save the state after some iterations
+struct snapshot : public mets::search_listener<run::neighborhood>
+{
+  snapshot(mets::checkpoint& ckp, std::ostream& os, int after)
+    : ckp_m(ckp), os_m(os), left_m(after) { }
+
+  void update(mets::abstract_search<run::neighborhood>* as)
+  {
+    if(as->step() == mets::abstract_search<run::neighborhood>::ITERATION_END
+       && --left_m == 0)
+      ckp_m.save(os_m);
+  }
+
+  mets::checkpoint& ckp_m;
+  std::ostream& os_m;
+  int left_m;
+};
+
+bool same(const run& a, const run& b)
+{
+  return a.working.permutation() == b.working.permutation()
+    && a.best.permutation() == b.best.permutation()
+    && a.working.cost_function() == b.working.cost_function()
+    && a.best.cost_function() == b.best.cost_function()
+    && a.memory.iterations() == b.memory.iterations()
+    && a.memory.restarts() == b.memory.restarts();
+}
+
+int main()
+{
+  // the uninterrupted search
+  run reference;
+  reference.search.search();
+  if(reference.memory.iterations() < 150 || reference.memory.restarts() == 0)
+    {
+      cerr << "Search too short to be meaningful." << endl;
+      return 1;
+    }
+
+  // searches resumed from a snapshot on fresh objects must end
+  // exactly the same way
+  const int stops[] = { 1, 37, 100, 149 };
+  for(unsigned int ii = 0; ii != sizeof(stops)/sizeof(stops[0]); ++ii)
+    {
+      std::stringstream saved;
+      {
+	run first;
+	snapshot stop(first.ckp, saved, stops[ii]);
+	first.search.attach(stop);
+	first.search.search();
+	if(!same(reference, first))
+	  {
+	    cerr << "Search not deterministic." << endl;
+	    return 1;
+	  }
+      }
+
+      run resumed;
+      resumed.ckp.load(saved);
+      resumed.search.search();
+      if(!same(reference, resumed))
+	{
+	  cerr << "Resumed search differs (stop at " << stops[ii]
+	       << ")." << endl;
+	  return 1;
+	}
+    }
+
+  // periodic asynchronous checkpoints on file
+  {
+    const std::string path = "checkpoint_test.ckp";
+    run first;
+    mets::checkpoint_writer<run::neighborhood> writer(first.ckp, path, 10);
+    first.search.attach(writer);
+    first.search.search();
+    if(!first.ckp.wait())
+      {
+	cerr << "Asynchronous checkpoint failed." << endl;
+	return 1;
+      }
+    run resumed;
+    resumed.ckp.read(path);
+    std::remove(path.c_str());
+    resumed.search.search();
+    if(!same(reference, resumed))
+      {
+	cerr << "Resumed search from file differs." << endl;
+	return 1;
+      }
+  }
+
+  // a writer that never writes
+  {
+    const std::string path = "checkpoint_test_never.ckp";
+    run first;
+    mets::checkpoint_writer<run::neighborhood> writer(first.ckp, path, 0);
+    first.search.attach(writer);
+    first.search.search();
+    first.ckp.wait();
+    if(std::ifstream(path.c_str()))
+      {
+	std::remove(path.c_str());
+	cerr << "Checkpoint written with every = 0." << endl;
+	return 1;
+      }
+  }
+
+#ifdef METSLIB_FORKED_CHECKPOINT
+  // a failed asynchronous write is remembered until cleared, and
+  // reported by the writer
+  {
+    const std::string bad = "no_such_directory/checkpoint_test.ckp";
+    const std::string path = "checkpoint_test_failed.ckp";
+    run first;
+    first.ckp.write_async(bad);
+    if(first.ckp.wait())
+      {
+	cerr << "Failed write not reported." << endl;
+	return 1;
+      }
+    first.ckp.write_async(path);
+    if(first.ckp.wait() || !first.ckp.failed())
+      {
+	std::remove(path.c_str());
+	cerr << "Failed write forgotten." << endl;
+	return 1;
+      }
+    mets::checkpoint_writer<run::neighborhood> writer(first.ckp, path, 10);
+    first.search.attach(writer);
+    bool thrown = false;
+    try {
+      first.search.search();
+    } catch(std::runtime_error& e) {
+      thrown = true;
+    }
+    first.ckp.wait();
+    std::remove(path.c_str());
+    if(!thrown || first.ckp.failed())
+      {
+	cerr << "Failed write not raised by the writer." << endl;
+	return 1;
+      }
+  }
+#endif
+
+  // a checkpoint of different objects is refused
+  {
+    std::stringstream saved;
+    run first;
+    first.ckp.save(saved);
+    mets::checkpoint other;
+    other.add(first.working);
+    try {
+      other.load(saved);
+      cerr << "Wrong checkpoint accepted." << endl;
+      return 1;
+    } catch(std::runtime_error&) { }
+  }
+
+  // a checkpoint of a problem of a different size is refused, and
+  // the problem left as it was
+  {
+    std::stringstream saved;
+    qap large(8);
+    mets::checkpoint first;
+    first.add(large);
+    first.save(saved);
+    qap small(5);
+    const std::vector<int> before(small.permutation());
+    mets::checkpoint other;
+    other.add(small);
+    try {
+      other.load(saved);
+      cerr << "Checkpoint of a different size accepted." << endl;
+      return 1;
+    } catch(std::runtime_error&) { }
+    if(small.permutation() != before)
+      {
+	cerr << "Problem modified by a refused checkpoint." << endl;
+	return 1;
+      }
+  }
+
+  // so is a tabu list saved for a different size
+  {
+    std::stringstream saved;
+    mets::swap_tabu_list small(5, 3);
+    small.save(saved);
+    mets::swap_tabu_list large(10, 3);
+    try {
+      large.load(saved);
+      cerr << "Tabu list of a different size accepted." << endl;
+      return 1;
+    } catch(std::runtime_error&) { }
+  }
+
+  // corrupted lengths are refused before anything is allocated
+  {
+    const size_t lengths[] = { size_t(-1), size_t(-1) / 4 + 1, 3 };
+    for(int ii = 0; ii != 3; ++ii)
+      {
+	std::stringstream saved;
+	mets::write_binary(saved, lengths[ii]);
+	mets::write_binary(saved, 0);
+	mets::write_binary(saved, 0);
+	std::vector<int> values;
+	try {
+	  mets::read_binary(saved, values);
+	  cerr << "Corrupted vector length accepted " << ii << endl;
+	  return 1;
+	} catch(std::runtime_error&) { }
+	saved.clear();
+	saved.seekg(0);
+	try {
+	  mets::read_string(saved);
+	  if(ii != 2)
+	    {
+	      cerr << "Corrupted string length accepted " << ii << endl;
+	      return 1;
+	    }
+	} catch(std::runtime_error&) { }
+      }
+  }
+
+  return 0;
+}
@@ -0,0 +1,133 @@
+// constraint tracking regression
+#include <metslib/mets.hh>
+
+using namespace std;
+
+#if defined (METSLIB_HAVE_UNORDERED_MAP) && !defined (METSLIB_TR1_MIXED_NAMESPACE)
+typedef std::mt19937 generator;
+#else
+typedef std::tr1::mt19937 generator;
+#endif
+
+// generalized assignment: assign each item to a bin minimizing the
+// total cost, without exceeding the capacity of the bins
+class gap : public mets::constrained_assignment_problem
+{
+public:
+  gap(int n, int k)
+    : constrained_assignment_problem(n, k, k), cost_m(n*k), weight_m(n),
+      capacity_m(k)
+  {
+    generator rng(n);
+    int total = 0;
+    for(int ii = 0; ii != n; ++ii)
+      {
+	weight_m[ii] = 1 + rng() % 10;
+	total += weight_m[ii];
+	for(int v = 0; v != k; ++v)
+	  cost_m[ii*k+v] = rng() % 50;
+      }
+    // tight capacities: 10% slack
+    for(int v = 0; v != k; ++v)
+      capacity_m[v] = 1.1 * total / k;
+  }
+
+  mets::gol_type compute_objective() const
+  {
+    mets::gol_type c = 0.0;
+    for(unsigned int ii = 0; ii != values_m.size(); ++ii)
+      c += cost_m[ii*domain_m+values_m[ii]];
+    return c;
+  }
+
+  mets::gol_type evaluate_objective(int i, int v) const
+  { return cost_m[i*domain_m+v] - cost_m[i*domain_m+values_m[i]]; }
+
+  void compute_amounts(mets::gol_type* amounts) const
+  {
+    for(int v = 0; v != domain_m; ++v)
+      amounts[v] = -capacity_m[v];
+    for(unsigned int ii = 0; ii != values_m.size(); ++ii)
+      amounts[values_m[ii]] += weight_m[ii];
+  }
+
+  void amount_deltas(int i, int v,
+		     mets::constraint_tracker::delta_list& deltas) const
+  {
+    deltas.push_back(std::make_pair(values_m[i], -weight_m[i]));
+    deltas.push_back(std::make_pair(v, mets::gol_type(weight_m[i])));
+  }
+
+private:
+  std::vector<int> cost_m;
+  std::vector<int> weight_m;
+  std::vector<mets::gol_type> capacity_m;
+};
+
+int main()
+{
+  const int n = 40;
+  const int k = 5;
+  generator rng(9);
+  gap working(n, k);
+  mets::random_assign(working, rng);
+
+  // the incremental tracker matches the one built from scratch
+  mets::change_value_neighborhood<generator> sample(rng, 1);
+  for(int ii = 0; ii != 500; ++ii)
+    {
+      sample.refresh(working);
+      (*sample.begin())->apply(working);
+    }
+  gap scratch(n, k);
+  scratch.copy_from(working);
+  scratch.update_cost();
+  if(std::fabs(working.cost_function() - working.compute_cost()) > 1e-6
+     || std::fabs(working.constraints().penalty()
+		  - scratch.constraints().penalty()) > 1e-6
+     || working.constraints().violated() != scratch.constraints().violated())
+    {
+      cerr << "Incremental cost: " << working.cost_function()
+	   << " != " << working.compute_cost() << endl;
+      return 1;
+    }
+
+  // changing the multiplier does not change the objective
+  mets::gol_type objective = working.objective();
+  working.penalty_multiplier(3.0);
+  if(std::fabs(working.objective() - objective) > 1e-6
+     || std::fabs(working.cost_function() - working.compute_cost()) > 1e-6)
+    {
+      cerr << "Failed multiplier test." << endl;
+      return 1;
+    }
+
+  // tabu search with strategic oscillation records the best feasible
+  // solution
+  typedef mets::change_value_full_neighborhood neighborhood;
+  gap best(n, k);
+  mets::best_feasible_solution recorder(best);
+  neighborhood moves(n, k);
+  mets::assignment_tabu_list tabus(n, k, 5);
+  mets::best_ever_criteria aspiration;
+  mets::iteration_termination_criteria termination(2000);
+  mets::tabu_search<neighborhood>
+    search(working, recorder, moves, tabus, aspiration, termination);
+  mets::strategic_oscillation<neighborhood> oscillation(working, 10);
+  search.attach(oscillation);
+  search.search();
+
+  if(!recorder.found() || !best.constraints().feasible()
+     || std::fabs(best.objective() - best.compute_objective()) > 1e-6
+     || recorder.best_cost() != best.objective()
+     || oscillation.adjustments() == 0)
+    {
+      cerr << "Found: " << recorder.found() << " objective: "
+	   << best.objective() << " adjustments: "
+	   << oscillation.adjustments() << endl;
+      cerr << "Failed oscillation test." << endl;
+      return 1;
+    }
+
+  return 0;
+}
@@ -0,0 +1,156 @@
+// exact (integer) cost regression
+#include <metslib/mets.hh>
+
+using namespace std;
+
+#if defined (METSLIB_HAVE_UNORDERED_MAP) && !defined (METSLIB_TR1_MIXED_NAMESPACE)
+typedef std::mt19937 generator;
+#else
+typedef std::tr1::mt19937 generator;
+#endif
+
+// quadratic assignment with integer flows and distances, scaled by
+// factor (to test large costs)
+template<typename cost_type>
+class qap : public mets::exact_permutation_problem<cost_type>
+{
+public:
+  qap(int n, cost_type factor)
+    : mets::exact_permutation_problem<cost_type>(n), f_m(n*n), d_m(n*n)
+  {
+    generator rng(n);
+    for(int ii = 0; ii != n*n; ++ii)
+      {
+	f_m[ii] = rng() % 10;
+	d_m[ii] = factor * cost_type(rng() % 10);
+      }
+  }
+
+  cost_type compute_exact_cost() const
+  {
+    const int n = this->size();
+    cost_type c = 0;
+    for(int ii = 0; ii != n; ++ii)
+      for(int jj = 0; jj != n; ++jj)
+	c += f_m[ii*n+jj] * d_m[this->pi_m[ii]*n+this->pi_m[jj]];
+    return c;
+  }
+
+  cost_type evaluate_exact_swap(int r, int s) const
+  {
+    const int n = this->size();
+    std::vector<int> q(this->pi_m);
+    std::swap(q[r], q[s]);
+    const std::vector<int>& p = this->pi_m;
+    cost_type d = 0;
+    for(int k = 0; k != n; ++k)
+      {
+	d += f_m[r*n+k] * (d_m[q[r]*n+q[k]] - d_m[p[r]*n+p[k]])
+	  + f_m[s*n+k] * (d_m[q[s]*n+q[k]] - d_m[p[s]*n+p[k]]);
+	if(k != r && k != s)
+	  d += f_m[k*n+r] * (d_m[q[k]*n+q[r]] - d_m[p[k]*n+p[r]])
+	    + f_m[k*n+s] * (d_m[q[k]*n+q[s]] - d_m[p[k]*n+p[s]]);
+      }
+    return d;
+  }
+
+private:
+  std::vector<cost_type> f_m;
+  std::vector<cost_type> d_m;
+};
+
+template<typename cost_type>
+bool search(int n, cost_type factor)
+{
+  generator rng(11);
+  qap<cost_type> working(n, factor), best(n, factor);
+  mets::random_shuffle(working, rng);
+  best.copy_from(working);
+
+  // a swap changes the cost by its exact delta
+  for(int ii = 0; ii != 100; ++ii)
+    {
+      int r = rng() % n, s = rng() % n;
+      if(r == s) continue;
+      cost_type before = working.compute_exact_cost();
+      cost_type delta = working.evaluate_exact_swap(r, s);
+      working.apply_swap(r, s);
+      if(working.compute_exact_cost() - before != delta)
+	{
+	  cerr << "Wrong delta for " << r << " " << s << endl;
+	  return false;
+	}
+    }
+
+  // the batch evaluation matches the single ones (every pair three
+  // times, more than a chunk)
+  std::vector<int> from, to;
+  for(int round = 0; round != 3; ++round)
+    for(int ii = 0; ii != n; ++ii)
+      for(int jj = ii + 1; jj != n; ++jj)
+	{
+	  from.push_back(ii);
+	  to.push_back(jj);
+	}
+  std::vector<mets::gol_type> deltas(from.size());
+  working.evaluate_swaps(&from[0], &to[0], &deltas[0], from.size());
+  for(size_t k = 0; k != from.size(); ++k)
+    if(deltas[k] != working.evaluate_swap(from[k], to[k]))
+      return false;
+  working.evaluate_swaps(0, 0, 0, 0);
+
+  mets::best_ever_solution recorder(best);
+  mets::swap_full_neighborhood moves(n);
+  mets::simple_tabu_list tabus(10);
+  mets::best_ever_criteria aspiration;
+  mets::iteration_termination_criteria termination(1000);
+  mets::tabu_search<mets::swap_full_neighborhood>
+    ts(working, recorder, moves, tabus, aspiration, termination);
+  ts.search();
+
+  // the incremental cost did not drift
+  if(working.exact_cost() != working.compute_exact_cost()
+     || best.exact_cost() != best.compute_exact_cost())
+    {
+      cerr << "Incremental cost: " << working.exact_cost() << " != "
+	   << working.compute_exact_cost() << endl;
+      return false;
+    }
+  return true;
+}
+
+int main()
+{
+  if(!search<int>(15, 1) || !search<long long>(15, 1000000000LL))
+    {
+      cerr << "Failed exact cost test." << endl;
+      return 1;
+    }
+
+  // integer and floating point problems side by side
+  generator rng(4);
+  qap<int> q(12, 1);
+  qap<double> r(12, 1.0);
+  mets::random_shuffle(q, rng);
+  r.copy_from(q);
+  if(q.cost_function() != r.cost_function()
+     || q.exact_cost() != q.compute_exact_cost()
+     || q.evaluate_swap(2, 7) != r.evaluate_swap(2, 7))
+    {
+      cerr << "Failed mixed cost test." << endl;
+      return 1;
+    }
+
+  // costs beyond the mantissa of gol_type are refused
+  if(std::numeric_limits<mets::gol_type>::digits < 63)
+    {
+      qap<long long> huge(12, 1LL << 45);
+      try {
+	huge.update_cost();
+	cerr << "Inexact cost accepted." << endl;
+	return 1;
+      } catch(std::runtime_error&) { }
+    }
+
+  return 0;
+}
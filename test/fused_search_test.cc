@@ -0,0 +1,187 @@
+// fused tabu search regression
+#include <metslib/mets.hh>
+
+using namespace std;
+
+#if defined (METSLIB_HAVE_UNORDERED_MAP) && !defined (METSLIB_TR1_MIXED_NAMESPACE)
+typedef std::mt19937 generator;
+#else
+typedef std::tr1::mt19937 generator;
+#endif
+
+// quadratic assignment with integer flows and distances
+class qap : public mets::exact_permutation_problem<int>
+{
+public:
+  qap(int n)
+    : exact_permutation_problem<int>(n), f_m(n*n), d_m(n*n)
+  {
+    generator rng(n);
+    for(int ii = 0; ii != n*n; ++ii)
+      {
+	f_m[ii] = rng() % 10;
+	d_m[ii] = rng() % 10;
+      }
+  }
+
+  int compute_exact_cost() const
+  {
+    const int n = size();
+    int c = 0;
+    for(int ii = 0; ii != n; ++ii)
+      for(int jj = 0; jj != n; ++jj)
+	c += f_m[ii*n+jj] * d_m[pi_m[ii]*n+pi_m[jj]];
+    return c;
+  }
+
+  int evaluate_exact_swap(int r, int s) const
+  {
+    const int n = size();
+    std::vector<int> q(pi_m);
+    std::swap(q[r], q[s]);
+    int d = 0;
+    for(int k = 0; k != n; ++k)
+      {
+	d += f_m[r*n+k] * (d_m[q[r]*n+q[k]] - d_m[pi_m[r]*n+pi_m[k]])
+	  + f_m[s*n+k] * (d_m[q[s]*n+q[k]] - d_m[pi_m[s]*n+pi_m[k]]);
+	if(k != r && k != s)
+	  d += f_m[k*n+r] * (d_m[q[k]*n+q[r]] - d_m[pi_m[k]*n+pi_m[r]])
+	    + f_m[k*n+s] * (d_m[q[k]*n+q[s]] - d_m[pi_m[k]*n+pi_m[s]]);
+      }
+    return d;
+  }
+
+private:
+  std::vector<int> f_m;
+  std::vector<int> d_m;
+};
+
+// records the moves made
+class trajectory
+  : public mets::search_listener<mets::swap_soa_neighborhood>
+{
+public:
+  trajectory() : search_listener<mets::swap_soa_neighborhood>(), moves() {}
+  void update(search_type* search)
+  {
+    if(search->step() == search_type::MOVE_MADE)
+      {
+	const search_type& s = *search;
+	const mets::swap_elements& m =
+	  static_cast<const mets::swap_elements&>(s.current_move());
+	moves.push_back(m.first()*1000 + m.second());
+      }
+  }
+  std::vector<int> moves;
+};
+
+int main()
+{
+  // every kernel chooses the same move as the scalar one
+  generator rng(5);
+  const mets::simd_level top = mets::simd_available();
+  for(int count = 0; count != 38; ++count)
+    for(int trial = 0; trial != 50; ++trial)
+      {
+	std::vector<mets::gol_type> deltas(count + 1);
+	std::vector<unsigned int> expiry(count + 1);
+	for(int k = 0; k != count; ++k)
+	  {
+	    // few distinct values to have ties
+	    deltas[k] = int(rng() % 7) - 3;
+	    expiry[k] = rng() % 20;
+	  }
+	unsigned int iteration = 5 + rng() % 10;
+	mets::gol_type threshold = int(rng() % 5) - 4;
+	size_t expected = mets::best_admissible(&deltas[0], &expiry[0],
+						iteration, threshold, count,
+						mets::SIMD_SCALAR);
+	for(int level = mets::SIMD_AVX2; level <= top; ++level)
+	  {
+	    size_t k = mets::best_admissible
+	      (&deltas[0], &expiry[0], iteration, threshold, count,
+	       mets::simd_level(level));
+	    if(k != expected)
+	      {
+		cerr << "Kernel " << level << " chose " << k
+		     << " instead of " << expected << endl;
+		return 1;
+	      }
+	  }
+      }
+
+  // the fused search makes the same moves of the tabu search
+  const int n = 25;
+  for(int level = mets::SIMD_SCALAR; level <= top; ++level)
+    {
+      qap start(n);
+      mets::random_shuffle(start, rng);
+
+      qap working1(n), best1(n);
+      working1.copy_from(start);
+      best1.copy_from(start);
+      mets::best_ever_solution recorder1(best1);
+      mets::swap_soa_neighborhood moves1(n);
+      mets::swap_tabu_list tabus1(n, 15);
+      mets::best_ever_criteria aspiration;
+      mets::iteration_termination_criteria termination1(300);
+      mets::tabu_search<mets::swap_soa_neighborhood>
+	ts(working1, recorder1, moves1, tabus1, aspiration, termination1);
+      trajectory path1;
+      ts.attach(path1);
+      ts.search();
+
+      qap working2(n), best2(n);
+      working2.copy_from(start);
+      best2.copy_from(start);
+      mets::best_ever_solution recorder2(best2);
+      mets::swap_soa_neighborhood moves2(n);
+      mets::swap_tabu_list tabus2(n, 15);
+      mets::iteration_termination_criteria termination2(300);
+      mets::fused_swap_search
+	fs(working2, recorder2, moves2, tabus2, termination2);
+      fs.simd(mets::simd_level(level));
+      trajectory path2;
+      fs.attach(path2);
+      fs.search();
+
+      if(path1.moves != path2.moves
+	 || best1.cost_function() != best2.cost_function()
+	 || fs.best_cost() != best2.cost_function()
+	 || working2.exact_cost() != working2.compute_exact_cost()
+	 || working1.permutation() != working2.permutation())
+	{
+	  cerr << "Best: " << best1.cost_function() << " "
+	       << best2.cost_function() << endl;
+	  cerr << "Failed trajectory test for kernel " << level << endl;
+	  return 1;
+	}
+    }
+
+  // with a long tenure on a small problem all the moves become tabu
+  {
+    const int m = 4;
+    qap working(m), best(m);
+    working.update_cost();
+    best.copy_from(working);
+    mets::best_ever_solution recorder(best);
+    mets::swap_soa_neighborhood moves(m);
+    mets::swap_tabu_list tabus(m, 100);
+    mets::iteration_termination_criteria termination(50);
+    mets::fused_swap_search fs(working, recorder, moves, tabus, termination);
+    if(fs.run() != mets::SEARCH_NO_MOVES)
+      {
+	cerr << "Failed no moves test." << endl;
+	return 1;
+      }
+    fs.fallback_to_tabu_moves(true);
+    if(fs.run() != mets::SEARCH_TERMINATED
+       || working.exact_cost() != working.compute_exact_cost())
+      {
+	cerr << "Failed fallback test." << endl;
+	return 1;
+      }
+  }
+
+  return 0;
+}
@@ -0,0 +1,186 @@
+// iterated local search regression
+#include <metslib/mets.hh>
+#include "lap.hh"
+
+using namespace std;
+
+// records the strength and the incumbent cost of each perturbation
+class recording_perturbation : public mets::abstract_perturbation
+{
+public:
+  recording_perturbation(generator& rng)
+    : abstract_perturbation(), swaps(rng), strengths(), costs() {}
+  void operator()(mets::feasible_solution& fs, unsigned int strength)
+  {
+    strengths.push_back(strength);
+    costs.push_back(static_cast<mets::evaluable_solution&>(fs)
+		    .cost_function());
+    swaps(fs, strength);
+  }
+  mets::swap_perturbation<generator> swaps;
+  std::vector<unsigned int> strengths;
+  std::vector<mets::gol_type> costs;
+};
+
+typedef mets::iterated_local_search<mets::swap_full_neighborhood> ils_type;
+
+// a fixed acceptance policy
+class policy_search : public ils_type
+{
+public:
+  policy_search(mets::evaluable_solution& working,
+		mets::evaluable_solution& incumbent,
+		mets::solution_recorder& recorder,
+		mets::swap_full_neighborhood& moveman,
+		mets::abstract_perturbation& perturbation,
+		mets::termination_criteria_chain& termination,
+		bool always)
+    : ils_type(working, incumbent, recorder, moveman, perturbation,
+	       termination), always_m(always) {}
+  bool accept(mets::gol_type, mets::gol_type)
+  { return always_m; }
+private:
+  bool always_m;
+};
+
+// the cost of the best assignment by enumeration
+static mets::gol_type
+optimum(int n)
+{
+  lap p(n);
+  std::vector<int> pi(p.permutation());
+  mets::gol_type best = std::numeric_limits<mets::gol_type>::max();
+  do {
+    best = std::min(best, p.cost_of(pi));
+  } while(std::next_permutation(pi.begin(), pi.end()));
+  return best;
+}
+
+int main()
+{
+  const int n = 8;
+
+  // the optimum is found and the strength adapts to the progress
+  {
+    generator rng(1);
+    lap working(n), incumbent(n), best(n);
+    mets::random_shuffle(working, rng);
+    best.copy_from(working);
+    mets::best_ever_solution recorder(best);
+    mets::swap_full_neighborhood moves(n);
+    recording_perturbation perturbation(rng);
+    mets::noimprove_termination_criteria termination(100);
+    ils_type ils(working, incumbent, recorder, moves, perturbation,
+		 termination, 2, 5);
+    ils.search();
+
+    if(best.cost_function() != optimum(n)
+       || best.cost_function() != best.compute_cost()
+       || incumbent.cost_function() != best.cost_function()
+       || ils.rounds() != perturbation.strengths.size()
+       || ils.rounds() < 100)
+      {
+	cerr << "Failed optimum test: " << best.cost_function() << " "
+	     << optimum(n) << endl;
+	return 1;
+      }
+    // the incumbent never gets worse; the strength is back to the
+    // minimum after an improvement, one more (up to the maximum)
+    // otherwise
+    for(size_t k = 0; k != perturbation.strengths.size(); ++k)
+      {
+	unsigned int expected = 2;
+	if(k != 0 && perturbation.costs[k] >= perturbation.costs[k-1])
+	  expected = std::min(perturbation.strengths[k-1] + 1, 5u);
+	if(perturbation.strengths[k] != expected
+	   || (k != 0 && perturbation.costs[k] > perturbation.costs[k-1]))
+	  {
+	    cerr << "Wrong strength at round " << k << endl;
+	    return 1;
+	  }
+      }
+    unsigned int next = 2;
+    if(perturbation.costs.back() >= incumbent.cost_function())
+      next = std::min(perturbation.strengths.back() + 1, 5u);
+    if(ils.strength() != next)
+      {
+	cerr << "Wrong final strength." << endl;
+	return 1;
+      }
+  }
+
+  // without improvements the strength grows up to the maximum
+  {
+    generator rng(2);
+    lap working(n, true), incumbent(n, true), best(n, true);
+    working.update_cost();
+    best.copy_from(working);
+    mets::best_ever_solution recorder(best);
+    mets::swap_full_neighborhood moves(n);
+    recording_perturbation perturbation(rng);
+    mets::iteration_termination_criteria termination(7);
+    ils_type ils(working, incumbent, recorder, moves, perturbation,
+		 termination, 1, 4);
+    ils.search();
+    const unsigned int expected[] = { 1, 2, 3, 4, 4, 4, 4 };
+    if(perturbation.strengths
+       != std::vector<unsigned int>(expected, expected + 7)
+       || ils.rounds() != 7 || ils.strength() != 4)
+      {
+	cerr << "Failed growing strength test." << endl;
+	return 1;
+      }
+  }
+
+  // the acceptance policy decides the incumbent
+  for(int always = 0; always != 2; ++always)
+    {
+      generator rng(3);
+      lap working(n), incumbent(n), best(n);
+      mets::random_shuffle(working, rng);
+      best.copy_from(working);
+
+      // the first local optimum
+      lap first(n), first_best(n);
+      first.copy_from(working);
+      first_best.copy_from(working);
+      mets::best_ever_solution first_recorder(first_best);
+      mets::swap_full_neighborhood first_moves(n);
+      mets::local_search<mets::swap_full_neighborhood>
+	descent(first, first_recorder, first_moves);
+      descent.search();
+
+      mets::best_ever_solution recorder(best);
+      mets::swap_full_neighborhood moves(n);
+      recording_perturbation perturbation(rng);
+      mets::iteration_termination_criteria termination(30);
+      policy_search ils(working, incumbent, recorder, moves, perturbation,
+			termination, always != 0);
+      ils.search();
+
+      // never: each round restarts from the first local optimum,
+      // always: worse local optima are accepted too
+      bool ok = working.permutation() == incumbent.permutation()
+	&& best.cost_function() <= incumbent.cost_function()
+	&& perturbation.costs.size() == 30;
+      bool worsened = false;
+      for(size_t k = 0; k != perturbation.costs.size(); ++k)
+	{
+	  if(!always)
+	    ok = ok && perturbation.costs[k] == first.cost_function();
+	  else if(k != 0 && perturbation.costs[k] > perturbation.costs[k-1])
+	    worsened = true;
+	}
+      if(always)
+	ok = ok && worsened;
+      else
+	ok = ok && incumbent.permutation() == first.permutation();
+      if(!ok)
+	{
+	  cerr << "Failed acceptance test " << always << endl;
+	  return 1;
+	}
+    }
+
+  return 0;
+}
@@ -0,0 +1,49 @@
+// linear assignment problem shared by the regressions
+#ifndef METS_TEST_LAP_HH_
+#define METS_TEST_LAP_HH_
+
+#include <metslib/mets.hh>
+
+#if defined (METSLIB_HAVE_UNORDERED_MAP) && !defined (METSLIB_TR1_MIXED_NAMESPACE)
+typedef std::mt19937 generator;
+#else
+typedef std::tr1::mt19937 generator;
+#endif
+
+// linear assignment: position i gets element pi(i) at cost c(i, pi(i)),
+// the costs are random (all 0 if flat)
+class lap : public mets::permutation_problem
+{
+public:
+  lap(int n, bool flat = false) : permutation_problem(n), c_m(n*n)
+  {
+    generator rng(n);
+    for(int ii = 0; ii != n*n; ++ii)
+      c_m[ii] = flat ? 0 : rng() % 100;
+  }
+
+  mets::gol_type compute_cost() const
+  { return cost_of(pi_m); }
+
+  mets::gol_type evaluate_swap(int i, int j) const
+  {
+    const int n = size();
+    return c_m[i*n+pi_m[j]] + c_m[j*n+pi_m[i]]
+      - c_m[i*n+pi_m[i]] - c_m[j*n+pi_m[j]];
+  }
+
+  // the cost of any permutation pi
+  mets::gol_type cost_of(const std::vector<int>& pi) const
+  {
+    const int n = size();
+    mets::gol_type c = 0.0;
+    for(int ii = 0; ii != n; ++ii)
+      c += c_m[ii*n+pi[ii]];
+    return c;
+  }
+
+private:
+  std::vector<int> c_m;
+};
+
+#endif
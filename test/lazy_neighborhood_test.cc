@@ -0,0 +1,205 @@
+// lazy neighborhood regression
+#include <metslib/mets.hh>
+#include "lap.hh"
+
+using namespace std;
+
+static int
+pair_of(const mets::move* m)
+{
+  const mets::swap_elements& s = static_cast<const mets::swap_elements&>(*m);
+  return s.first()*1000 + s.second();
+}
+
+int main()
+{
+  typedef mets::swap_lazy_neighborhood lazy;
+
+  // nothing to swap
+  for(int n = 0; n != 2; ++n)
+    {
+      lazy moves(n);
+      if(moves.size() != 0 || moves.begin() != moves.end())
+	{
+	  cerr << "Wrong empty neighborhood for " << n << endl;
+	  return 1;
+	}
+    }
+
+  // same moves in the same order as the full neighborhood
+  for(int n = 2; n != 12; ++n)
+    {
+      mets::swap_full_neighborhood full(n);
+      lazy moves(n);
+      if(moves.size() != full.size()
+	 || size_t(moves.end() - moves.begin()) != full.size())
+	{
+	  cerr << "Wrong size for " << n << endl;
+	  return 1;
+	}
+      mets::move_manager::iterator fit = full.begin();
+      size_t k = 0;
+      for(lazy::iterator it = moves.begin(); it != moves.end(); 
+	  ++it, ++fit, ++k)
+	{
+	  // sequential, random access and backwards agree
+	  lazy::iterator back = moves.end();
+	  back -= moves.size() - k;
+	  if(pair_of(*it) != pair_of(*fit) 
+	     || pair_of(*moves.at(k)) != pair_of(*fit)
+	     || pair_of(*(moves.begin() + k)) != pair_of(*fit)
+	     || pair_of(*(k + moves.begin())) != pair_of(*fit)
+	     || pair_of(moves.begin()[k]) != pair_of(*fit)
+	     || pair_of(*back) != pair_of(*fit) || it.index() != k
+	     || !(it < moves.end()) || it > moves.end()
+	     || !(it <= back) || !(it >= back) || !(moves.end() > it))
+	    {
+	      cerr << "Wrong move " << k << " for " << n << endl;
+	      return 1;
+	    }
+	  for(lazy::iterator down = moves.end(); down != it; )
+	    if(--down == it && pair_of(*down) != pair_of(*fit))
+	      {
+		cerr << "Wrong decrement " << k << " for " << n << endl;
+		return 1;
+	      }
+	}
+    }
+
+  // huge neighborhoods are not built: seek to the last swap
+  {
+    const int n = 50000;
+    lazy moves(n);
+    lazy::iterator last = moves.end() - 1;
+    const mets::swap_elements& s =
+      static_cast<const mets::swap_elements&>(**last);
+    if(moves.size() != size_t(n)*(n-1)/2
+       || s.first() != n-2 || s.second() != n-1
+       || pair_of(*moves.at(n-1)) != 1*1000 + 2)
+      {
+	cerr << "Failed huge neighborhood test." << endl;
+	return 1;
+      }
+  }
+
+  // scanning the ranges of a split gives the best move of the whole
+  // neighborhood
+  {
+    const int n = 60;
+    generator rng(3);
+    lap working(n);
+    mets::random_shuffle(working, rng);
+    lazy moves(n);
+    const size_t parts = 7;
+    lazy::iterator best = moves.end();
+    mets::gol_type best_cost = std::numeric_limits<mets::gol_type>::max();
+    for(size_t p = 0; p != parts; ++p)
+      {
+	lazy::iterator it = moves.at(moves.size() * p / parts);
+	lazy::iterator stop = moves.at(moves.size() * (p+1) / parts);
+	for(; it != stop; ++it)
+	  {
+	    mets::gol_type cost = (*it)->evaluate(working);
+	    if(cost < best_cost)
+	      {
+		best_cost = cost;
+		best = it;
+	      }
+	  }
+      }
+    mets::swap_full_neighborhood full(n);
+    mets::move_manager::iterator fbest = full.end();
+    mets::gol_type fbest_cost = std::numeric_limits<mets::gol_type>::max();
+    for(mets::move_manager::iterator it = full.begin(); 
+	it != full.end(); ++it)
+      if((*it)->evaluate(working) < fbest_cost)
+	{
+	  fbest_cost = (*it)->evaluate(working);
+	  fbest = it;
+	}
+    if(best_cost != fbest_cost || pair_of(*best) != pair_of(*fbest)
+       || moves.begin()[best.index()]->evaluate(working) != best_cost)
+      {
+	cerr << "Failed split scan test." << endl;
+	return 1;
+      }
+  }
+
+  // the moves of a union of lazy neighborhoods, some sampled, live
+  // as long as the union iterator
+  {
+    typedef mets::union_neighborhood<generator, lazy> union_type;
+    generator rng(4);
+    lazy swaps(5), sampled(6);
+    union_type moves(rng);
+    moves.add(swaps);
+    moves.add(sampled, 0.5);
+    lap working(6);
+    for(int trial = 0; trial != 10; ++trial)
+      {
+	moves.refresh(working);
+	std::vector<int> seen;
+	for(union_type::iterator it = moves.begin(); it != moves.end(); ++it)
+	  seen.push_back(pair_of(*it));
+	bool ok = moves.size() == 10 + 8 && seen.size() == 10 + 8;
+	for(size_t k = 0; ok && k != 10; ++k)
+	  ok = seen[k] == pair_of(*swaps.at(k));
+	size_t start = 0;
+	while(ok && start != sampled.size()
+	      && pair_of(*sampled.at(start)) != seen[10])
+	  ++start;
+	for(size_t k = 0; ok && k != 8; ++k)
+	  ok = seen[10 + k]
+	    == pair_of(*sampled.at((start + k) % sampled.size()));
+	if(!ok)
+	  {
+	    cerr << "Failed union test " << trial << endl;
+	    return 1;
+	  }
+      }
+  }
+
+  // a tabu search makes the same moves on both neighborhoods
+  {
+    const int n = 30;
+    generator rng(7);
+    lap start(n);
+    mets::random_shuffle(start, rng);
+
+    lap working1(n), best1(n);
+    working1.copy_from(start);
+    best1.copy_from(start);
+    mets::best_ever_solution recorder1(best1);
+    mets::swap_full_neighborhood moves1(n);
+    mets::simple_tabu_list tabus1(10);
+    mets::best_ever_criteria aspiration1;
+    mets::iteration_termination_criteria termination1(200);
+    mets::tabu_search<mets::swap_full_neighborhood>
+      ts1(working1, recorder1, moves1, tabus1, aspiration1, termination1);
+    ts1.search();
+
+    lap working2(n), best2(n);
+    working2.copy_from(start);
+    best2.copy_from(start);
+    mets::best_ever_solution recorder2(best2);
+    lazy moves2(n);
+    mets::simple_tabu_list tabus2(10);
+    mets::best_ever_criteria aspiration2;
+    mets::iteration_termination_criteria termination2(200);
+    mets::tabu_search<lazy>
+      ts2(working2, recorder2, moves2, tabus2, aspiration2, termination2);
+    ts2.search();
+
+    const mets::abstract_search<mets::swap_full_neighborhood>& s1 = ts1;
+    const mets::abstract_search<lazy>& s2 = ts2;
+    if(working1.permutation() != working2.permutation()
+       || best1.cost_function() != best2.cost_function()
+       || pair_of(&s1.current_move()) != pair_of(&s2.current_move()))
+      {
+	cerr << "Failed tabu search test." << endl;
+	return 1;
+      }
+  }
+
+  return 0;
+}
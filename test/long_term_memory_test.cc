@@ -0,0 +1,213 @@
+// long term memory regression
+#include <metslib/mets.hh>
+#include "lap.hh"
+
+using namespace std;
+
+// every permutation costs the same: no move ever improves
+class flat : public mets::permutation_problem
+{
+public:
+  flat(int n) : permutation_problem(n) {}
+  mets::gol_type compute_cost() const { return 0.0; }
+  mets::gol_type evaluate_swap(int, int) const { return 0.0; }
+};
+
+// counts the diversifications
+class diversification_counter
+  : public mets::search_listener<mets::swap_full_neighborhood>
+{
+public:
+  diversification_counter()
+    : search_listener<mets::swap_full_neighborhood>(), count(0), moves(0) {}
+  void update(search_type* search)
+  {
+    if(search->step()
+       == mets::tabu_search<mets::swap_full_neighborhood>::DIVERSIFICATION_MADE)
+      ++count;
+    else if(search->step() == search_type::MOVE_MADE)
+      ++moves;
+  }
+  int count;
+  int moves;
+};
+
+// makes mov on working and tells memory about it
+static void
+make(mets::frequency_memory& memory, mets::permutation_problem& working,
+     const mets::swap_elements& mov)
+{
+  mov.apply(working);
+  memory.accept(working, mov, working.cost_function());
+}
+
+int main()
+{
+  const int n = 3;
+  const mets::swap_elements s01(0, 1);
+  const mets::swap_elements s02(0, 2);
+
+  // penalty scoring
+  {
+    flat working(n);
+    working.update_cost();
+    mets::frequency_memory memory(n, 10.0);
+    if(memory.penalty(working, s01, 0.0) != 0.0)
+      {
+	cerr << "Penalty before any move." << endl;
+	return 1;
+      }
+    // [1 0 2] then [0 1 2]: 0 and 1 visited both positions once
+    make(memory, working, s01);
+    make(memory, working, s01);
+    if(memory.iterations() != 2 || memory.frequency(0, 0) != 1
+       || memory.frequency(0, 1) != 1 || memory.frequency(1, 0) != 1
+       || memory.frequency(1, 1) != 1 || memory.frequency(2, 2) != 0)
+      {
+	cerr << "Wrong frequencies." << endl;
+	return 1;
+      }
+    // weight * (f(0, 1) + f(1, 0)) / iterations
+    if(memory.penalty(working, s01, 0.0) != 10.0
+       || memory.penalty(working, s02, 0.0) != 0.0)
+      {
+	cerr << "Wrong penalty." << endl;
+	return 1;
+      }
+    // improving moves are never penalized
+    if(memory.penalty(working, s01, -1.0) != 0.0)
+      {
+	cerr << "Improving move penalized." << endl;
+	return 1;
+      }
+    // a chain sums the penalties, a zero weight disables them
+    mets::frequency_memory tail(n, 4.0);
+    mets::frequency_memory head(&tail, n, 0.0);
+    s01.apply(working);
+    head.accept(working, s01, 0.0);
+    s01.apply(working);
+    head.accept(working, s01, 0.0);
+    if(tail.iterations() != 2 || head.penalty(working, s01, 0.0) != 4.0)
+      {
+	cerr << "Wrong chained penalty." << endl;
+	return 1;
+      }
+    memory.reset();
+    if(memory.iterations() != 0 || memory.frequency(0, 1) != 0
+       || memory.penalty(working, s01, 0.0) != 0.0)
+      {
+	cerr << "Failed reset test." << endl;
+	return 1;
+      }
+  }
+
+  // diversification triggering
+  {
+    flat working(n);
+    working.update_cost();
+    mets::frequency_memory memory(n, 0.0, 3);
+    mets::frequency_memory never(n, 0.0);
+    for(int ii = 0; ii != 3; ++ii)
+      {
+	make(memory, working, s01);
+	never.accept(working, s01, 0.0);
+	if(memory.diversify(working) || never.diversify(working))
+	  {
+	    cerr << "Early diversification at " << ii << endl;
+	    return 1;
+	  }
+      }
+    // the fourth move without improvement restarts: each element
+    // goes to its least visited free position
+    make(memory, working, s01);
+    if(!memory.diversify(working) || memory.restarts() != 1
+       || never.diversify(working) || never.restarts() != 0)
+      {
+	cerr << "Failed diversification test." << endl;
+	return 1;
+      }
+    const int expected[] = { 1, 2, 0 };
+    if(working.permutation() != std::vector<int>(expected, expected + n))
+      {
+	cerr << "Wrong diversified permutation." << endl;
+	return 1;
+      }
+    if(memory.diversify(working))
+      {
+	cerr << "Diversified twice in a row." << endl;
+	return 1;
+      }
+  }
+
+  // save and load
+  {
+    flat working(n);
+    working.update_cost();
+    mets::frequency_memory memory(n, 6.0, 2);
+    make(memory, working, s01);
+    make(memory, working, s02);
+    make(memory, working, s01);
+    std::stringstream saved;
+    memory.save(saved);
+
+    mets::frequency_memory restored(n, 6.0, 2);
+    restored.load(saved);
+    if(restored.iterations() != memory.iterations()
+       || restored.restarts() != memory.restarts())
+      {
+	cerr << "Wrong restored counters." << endl;
+	return 1;
+      }
+    for(int e = 0; e != n; ++e)
+      for(int p = 0; p != n; ++p)
+	if(restored.frequency(e, p) != memory.frequency(e, p))
+	  {
+	    cerr << "Wrong restored frequency " << e << " " << p << endl;
+	    return 1;
+	  }
+    // both continue the same way
+    flat other(n);
+    other.copy_from(working);
+    if(restored.penalty(other, s01, 0.0) != memory.penalty(working, s01, 0.0)
+       || restored.diversify(other) != memory.diversify(working)
+       || other.permutation() != working.permutation())
+      {
+	cerr << "Failed save and load test." << endl;
+	return 1;
+      }
+  }
+
+  // a tabu search with a long term memory
+  {
+    const int m = 12;
+    generator rng(1);
+    lap working(m), best(m);
+    mets::random_shuffle(working, rng);
+    best.copy_from(working);
+    mets::best_ever_solution recorder(best);
+    mets::swap_full_neighborhood moves(m);
+    mets::simple_tabu_list tabus(5);
+    mets::best_ever_criteria aspiration;
+    mets::iteration_termination_criteria termination(200);
+    mets::frequency_memory memory(m, 50.0, 20);
+    mets::tabu_search<mets::swap_full_neighborhood>
+      ts(working, recorder, moves, tabus, aspiration, termination, memory);
+    diversification_counter counter;
+    ts.attach(counter);
+    ts.search();
+
+    if(ts.get_long_term_memory() != &memory || counter.moves != 200
+       || memory.iterations() != 200 || counter.count == 0
+       || counter.count != int(memory.restarts())
+       || working.cost_function() != working.compute_cost()
+       || best.cost_function() != best.compute_cost()
+       || best.cost_function() > working.cost_function())
+      {
+	cerr << "Failed tabu search test (" << counter.count
+	     << " diversifications)." << endl;
+	return 1;
+      }
+  }
+
+  return 0;
+}
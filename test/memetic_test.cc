@@ -0,0 +1,119 @@
+// memetic algorithm regression
+#include <metslib/mets.hh>
+#include "qap.hh"
+
+using namespace std;
+
+bool is_permutation(const std::vector<int>& p)
+{
+  std::vector<int> seen(p.size(), 0);
+  for(unsigned int ii = 0; ii != p.size(); ++ii)
+    {
+      if(p[ii] < 0 || p[ii] >= static_cast<int>(p.size()) || seen[p[ii]])
+	return false;
+      seen[p[ii]] = 1;
+    }
+  return true;
+}
+
+// run a memetic algorithm with local search on "workers" workers
+mets::gol_type run(int workers, unsigned long seed, std::vector<int>& best_pi,
+		   mets::memetic_algorithm<generator>::crossover_type cx)
+{
+  const int n = 12;
+  typedef mets::local_search_improver<mets::swap_full_neighborhood> improver;
+  std::vector<qap*> scratch;
+  std::vector<mets::swap_full_neighborhood*> moves;
+  std::vector<improver*> improvers;
+  qap best(n);
+  best.update_cost();
+  mets::best_ever_solution recorder(best);
+  mets::iteration_termination_criteria termination(10);
+  mets::memetic_algorithm<generator>
+    ma(recorder, termination, 8, 6, cx, seed);
+  for(int ii = 0; ii != workers; ++ii)
+    {
+      scratch.push_back(new qap(n));
+      moves.push_back(new mets::swap_full_neighborhood(n));
+      improvers.push_back(new improver(*moves.back()));
+      ma.add_worker(*scratch.back(), *improvers.back());
+    }
+  ma.search();
+
+  bool ok = ma.generation() == 10
+    && best.cost_function() == best.compute_cost()
+    && best.cost_function() == ma.cost(0);
+  for(unsigned int ii = 1; ii != ma.population_size(); ++ii)
+    ok = ok && ma.cost(ii-1) <= ma.cost(ii);
+  for(int ii = 0; ii != workers; ++ii)
+    {
+      delete improvers[ii];
+      delete moves[ii];
+      delete scratch[ii];
+    }
+  best_pi = best.permutation();
+  return ok ? best.cost_function() : -1.0;
+}
+
+int main()
+{
+  // crossovers produce permutations
+  const int n = 30;
+  generator rng(3);
+  std::vector<int> a(n), b(n), child(n), work;
+  for(int ii = 0; ii != n; ++ii)
+    a[ii] = b[ii] = ii;
+  for(int trial = 0; trial != 200; ++trial)
+    {
+#if defined (METSLIB_HAVE_UNORDERED_MAP) && !defined (METSLIB_TR1_MIXED_NAMESPACE)
+      std::shuffle(b.begin(), b.end(), rng);
+#else
+      std::random_shuffle(b.begin(), b.end());
+#endif
+      mets::order_crossover(&a[0], &b[0], &child[0], n, rng, work);
+      if(!is_permutation(child))
+	{
+	  cerr << "Invalid order crossover." << endl;
+	  return 1;
+	}
+      mets::pmx_crossover(&a[0], &b[0], &child[0], n, rng, work);
+      if(!is_permutation(child))
+	{
+	  cerr << "Invalid partially mapped crossover." << endl;
+	  return 1;
+	}
+      mets::cycle_crossover(&a[0], &b[0], &child[0], n, work);
+      bool positions = is_permutation(child);
+      for(int ii = 0; ii != n; ++ii)
+	positions = positions && (child[ii] == a[ii] || child[ii] == b[ii]);
+      if(!positions)
+	{
+	  cerr << "Invalid cycle crossover." << endl;
+	  return 1;
+	}
+    }
+
+  // the search is reproducible and does not depend on the number of
+  // workers (with stateless improvers)
+  typedef mets::memetic_algorithm<generator> memetic;
+  memetic::crossover_type types[] = { memetic::ORDER_CROSSOVER,
+				      memetic::PARTIALLY_MAPPED_CROSSOVER,
+				      memetic::CYCLE_CROSSOVER };
+  for(int t = 0; t != 3; ++t)
+    {
+      std::vector<int> p1, p2, p3;
+      mets::gol_type c1 = run(1, 11, p1, types[t]);
+      mets::gol_type c2 = run(1, 11, p2, types[t]);
+      mets::gol_type c3 = run(3, 11, p3, types[t]);
+      if(c1 < 0 || c1 != c2 || c1 != c3 || p1 != p2 || p1 != p3
+	 || !is_permutation(p1))
+	{
+	  cerr << "Crossover " << t << ": " << c1 << " " << c2 << " "
+	       << c3 << endl;
+	  cerr << "Failed memetic algorithm test." << endl;
+	  return 1;
+	}
+    }
+
+  return 0;
+}
@@ -0,0 +1,324 @@
+// multi-objective regression
+#include <metslib/mets.hh>
+
+using namespace std;
+
+#if defined (METSLIB_HAVE_UNORDERED_MAP) && !defined (METSLIB_TR1_MIXED_NAMESPACE)
+typedef std::mt19937 generator;
+#else
+typedef std::tr1::mt19937 generator;
+#endif
+
+// bi-objective knapsack: maximize the profit (minimize its opposite)
+// and minimize the weight of the selected items, the cost is a
+// weighted sum of the two
+class knapsack : public mets::bitvector_problem,
+		 public mets::multi_objective_solution
+{
+public:
+  knapsack(int n, const mets::objective_vector& w)
+    : bitvector_problem(n), multi_objective_solution(), profit_m(n),
+      weight_m(n), sum_m(w)
+  {
+    generator rng(n);
+    for(int ii = 0; ii != n; ++ii)
+      {
+	profit_m[ii] = 1 + rng() % 20;
+	weight_m[ii] = 1 + rng() % 20;
+      }
+  }
+
+  const mets::multi_objective_solution* multi_objective() const
+  { return this; }
+
+  size_t objectives() const
+  { return 2; }
+
+  void objective_values(mets::gol_type* f) const
+  {
+    f[0] = f[1] = 0.0;
+    for(int ii = 0; ii != n_m; ++ii)
+      if(bit(ii))
+	{
+	  f[0] -= profit_m[ii];
+	  f[1] += weight_m[ii];
+	}
+  }
+
+  mets::gol_type compute_cost() const
+  {
+    mets::gol_type f[2];
+    objective_values(f);
+    return sum_m(f);
+  }
+
+  mets::gol_type evaluate_flip(int i) const
+  {
+    mets::gol_type df[2] = { -profit_m[i], weight_m[i] };
+    mets::gol_type d = sum_m.delta(df);
+    return bit(i) ? -d : d;
+  }
+
+private:
+  std::vector<mets::gol_type> profit_m;
+  std::vector<mets::gol_type> weight_m;
+  mets::weighted_sum sum_m;
+};
+
+// true if the archive is sorted and has no dominated solutions
+bool check(const mets::pareto_archive& archive)
+{
+  const size_t m = archive.objectives();
+  for(size_t ii = 0; ii != archive.size(); ++ii)
+    {
+      mets::gol_type f[3];
+      for(size_t k = 0; k != m; ++k)
+	f[k] = archive.objective(ii, k);
+      for(size_t jj = 0; jj != archive.size(); ++jj)
+	{
+	  mets::gol_type g[3];
+	  for(size_t k = 0; k != m; ++k)
+	    g[k] = archive.objective(jj, k);
+	  if(mets::dominates(g, f, m))
+	    return false;
+	  if(jj > ii && !std::lexicographical_compare(f, f + m, g, g + m))
+	    return false;
+	}
+    }
+  return true;
+}
+
+// a point on the plane, or in the space
+class point : public mets::evaluable_solution,
+	      public mets::multi_objective_solution
+{
+public:
+  point(size_t m) : f_m(m) {}
+  const mets::multi_objective_solution* multi_objective() const
+  { return this; }
+  size_t objectives() const { return f_m.size(); }
+  void objective_values(mets::gol_type* f) const
+  { std::copy(f_m.begin(), f_m.end(), f); }
+  mets::gol_type cost_function() const { return f_m[0]; }
+  void copy_from(const mets::copyable& o)
+  { f_m = dynamic_cast<const point&>(o).f_m; }
+  mets::objective_vector f_m;
+};
+
+int main()
+{
+  // the simplex lattice
+  std::vector<mets::objective_vector> w2 = mets::simplex_weights(2, 4);
+  std::vector<mets::objective_vector> w3 = mets::simplex_weights(3, 3);
+  if(w2.size() != 5 || w3.size() != 10 || w2[0][1] != 1.0 || w2[4][0] != 1.0)
+    {
+      cerr << "Failed simplex test." << endl;
+      return 1;
+    }
+  for(size_t ii = 0; ii != w3.size(); ++ii)
+    if(std::fabs(w3[ii][0] + w3[ii][1] + w3[ii][2] - 1.0) > 1e-12)
+      {
+	cerr << "Failed simplex sum test." << endl;
+	return 1;
+      }
+
+  // random points in two and three dimensions
+  generator rng(5);
+  for(size_t m = 2; m != 4; ++m)
+    {
+      std::vector<point*> slots;
+      mets::pareto_archive archive(m);
+      for(int ii = 0; ii != 400; ++ii)
+	{
+	  slots.push_back(new point(m));
+	  archive.add_slot(*slots.back());
+	}
+      point p(m);
+      std::vector<mets::objective_vector> seen;
+      for(int ii = 0; ii != 2000; ++ii)
+	{
+	  for(size_t k = 0; k != m; ++k)
+	    p.f_m[k] = rng() % 1000;
+	  archive.accept(p);
+	  seen.push_back(p.f_m);
+	}
+      // the archive is the set of the non dominated points seen
+      size_t expected = 0;
+      for(size_t ii = 0; ii != seen.size(); ++ii)
+	{
+	  bool dominated = false;
+	  for(size_t jj = 0; jj != seen.size() && !dominated; ++jj)
+	    dominated = mets::dominates(&seen[jj][0], &seen[ii][0], m)
+	      || (jj < ii && seen[jj] == seen[ii]);
+	  expected += !dominated;
+	}
+      if(!check(archive) || archive.size() != expected
+	 || archive.size() > archive.capacity())
+	{
+	  cerr << "Archive: " << archive.size() << " expected: "
+	       << expected << endl;
+	  cerr << "Failed archive test." << endl;
+	  return 1;
+	}
+      for(size_t ii = 0; ii != archive.size(); ++ii)
+	if(dynamic_cast<const point&>(archive[ii]).f_m[0]
+	   != archive.objective(ii, 0))
+	  {
+	    cerr << "Failed slot test." << endl;
+	    return 1;
+	  }
+      for(size_t ii = 0; ii != slots.size(); ++ii)
+	delete slots[ii];
+    }
+
+  // a full archive keeps its extremes
+  {
+    std::vector<point*> slots;
+    mets::pareto_archive archive(2);
+    for(int ii = 0; ii != 5; ++ii)
+      {
+	slots.push_back(new point(2));
+	archive.add_slot(*slots.back());
+      }
+    point p(2);
+    for(int ii = 0; ii != 20; ++ii)
+      {
+	p.f_m[0] = ii; p.f_m[1] = 19 - ii;
+	archive.accept(p);
+      }
+    if(archive.size() != 5 || archive.objective(0, 0) != 0
+       || archive.objective(4, 0) != 19 || !check(archive))
+      {
+	cerr << "Failed eviction test." << endl;
+	return 1;
+      }
+    for(size_t ii = 0; ii != slots.size(); ++ii)
+      delete slots[ii];
+  }
+
+  // a full archive evicts the inner solution with the nearest
+  // neighbors, as a sorted vector would
+  {
+    const int capacity = 20;
+    std::vector<point*> slots;
+    mets::pareto_archive archive(2);
+    for(int ii = 0; ii != capacity; ++ii)
+      {
+	slots.push_back(new point(2));
+	archive.add_slot(*slots.back());
+      }
+    std::vector<std::pair<mets::gol_type, mets::gol_type> > reference;
+    point p(2);
+    for(int round = 0; round != 2; ++round)
+      {
+	archive.clear();
+	reference.clear();
+	for(int ii = 0; ii != 3000; ++ii)
+	  {
+	    p.f_m[0] = rng() % 100000;
+	    p.f_m[1] = 100000 - p.f_m[0] + rng() % 3000 + ii / 10;
+	    std::pair<mets::gol_type, mets::gol_type> q(p.f_m[0], p.f_m[1]);
+	    bool dominated = false;
+	    for(size_t jj = 0; jj != reference.size(); ++jj)
+	      dominated = dominated || (reference[jj].first <= q.first 
+					&& reference[jj].second <= q.second);
+	    if(!dominated)
+	      {
+		for(size_t jj = reference.size(); jj != 0; --jj)
+		  if(q.first <= reference[jj-1].first 
+		     && q.second <= reference[jj-1].second)
+		    reference.erase(reference.begin() + jj - 1);
+		if(reference.size() == size_t(capacity))
+		  {
+		    size_t victim = 0;
+		    mets::gol_type crowding = 
+		      std::numeric_limits<mets::gol_type>::max();
+		    for(size_t jj = 1; jj + 1 < reference.size(); ++jj)
+		      {
+			mets::gol_type c = 
+			  reference[jj+1].first - reference[jj-1].first
+			  + reference[jj-1].second - reference[jj+1].second;
+			if(c < crowding)
+			  {
+			    crowding = c;
+			    victim = jj;
+			  }
+		      }
+		    reference.erase(reference.begin() + victim);
+		  }
+		reference.insert(std::lower_bound(reference.begin(), 
+						  reference.end(), q), q);
+	      }
+	    if(archive.accept(p) == dominated)
+	      {
+		cerr << "Wrong accept " << ii << endl;
+		return 1;
+	      }
+	    bool same = archive.size() == reference.size();
+	    for(size_t jj = 0; same && jj != reference.size(); ++jj)
+	      same = archive.objective(jj, 0) == reference[jj].first
+		&& archive.objective(jj, 1) == reference[jj].second;
+	    if(!same || !check(archive))
+	      {
+		cerr << "Failed crowding test at " << ii << endl;
+		return 1;
+	      }
+	  }
+      }
+    for(size_t ii = 0; ii != slots.size(); ++ii)
+      delete slots[ii];
+  }
+
+  // a weighted search for each weight vector, each one with its own
+  // archive (these could run on different threads), then merged
+  const int n = 30;
+  const int capacity = 200;
+  std::vector<knapsack*> slots;
+  mets::pareto_archive front(2);
+  for(int ii = 0; ii != capacity; ++ii)
+    {
+      slots.push_back(new knapsack(n, w2[0]));
+      front.add_slot(*slots.back());
+    }
+  size_t largest = 0;
+  for(size_t ww = 0; ww != w2.size(); ++ww)
+    {
+      mets::pareto_archive archive(2);
+      std::vector<knapsack*> local;
+      for(int ii = 0; ii != capacity; ++ii)
+	{
+	  local.push_back(new knapsack(n, w2[ww]));
+	  archive.add_slot(*local.back());
+	}
+      knapsack working(n, w2[ww]);
+      working.update_cost();
+      mets::flip_full_neighborhood moves(n);
+      mets::flip_tabu_list tabus(n, 5);
+      mets::best_ever_criteria aspiration;
+      mets::iteration_termination_criteria termination(300);
+      mets::tabu_search<mets::flip_full_neighborhood>
+	ts(working, archive, moves, tabus, aspiration, termination);
+      ts.search();
+      if(archive.size() == 0 || !check(archive))
+	{
+	  cerr << "Failed weighted search test." << endl;
+	  return 1;
+	}
+      largest = std::max(largest, archive.size());
+      front.merge(archive);
+      for(int ii = 0; ii != capacity; ++ii)
+	delete local[ii];
+    }
+  // the extremes: nothing selected, everything selected
+  if(!check(front) || front.size() < largest
+     || front.objective(front.size() - 1, 1) != 0.0)
+    {
+      cerr << "Front: " << front.size() << " largest: " << largest << endl;
+      cerr << "Failed merge test." << endl;
+      return 1;
+    }
+
+  for(size_t ii = 0; ii != slots.size(); ++ii)
+    delete slots[ii];
+  return 0;
+}
@@ -0,0 +1,96 @@
+// regression built with -fno-rtti: the library must not need RTTI
+#include <metslib/mets.hh>
+
+using namespace std;
+
+#if defined (METSLIB_HAVE_UNORDERED_MAP) && !defined (METSLIB_TR1_MIXED_NAMESPACE)
+typedef std::minstd_rand0 generator;
+#else
+typedef std::tr1::minstd_rand0 generator;
+#endif
+
+// the cost is the sum of i * pi[i] (minimized by the reversal)
+class weighted : public mets::permutation_problem
+{
+public:
+  weighted(int n) : permutation_problem(n) {}
+
+  mets::gol_type compute_cost() const
+  {
+    mets::gol_type c = 0.0;
+    for(unsigned int ii = 0; ii != pi_m.size(); ++ii)
+      c += ii * pi_m[ii];
+    return c;
+  }
+
+  mets::gol_type evaluate_swap(int i, int j) const
+  { return (i - j) * (pi_m[j] - pi_m[i]); }
+};
+
+// a solution without cost
+class plain : public mets::feasible_solution
+{ };
+
+int main()
+{
+  const int n = 20;
+
+  // moves of different types are never equal
+  mets::swap_elements s(2, 5);
+  mets::invert_subsequence i(2, 5);
+  mets::swap_elements s2(2, 5);
+  if(s == i || i == s || !(s == s2) || s.tag() == i.tag())
+    {
+      cerr << "Failed move tag test." << endl;
+      return 1;
+    }
+
+  // the checked conversions
+  plain p;
+  weighted w(n);
+  bool thrown = false;
+  try {
+    mets::evaluable_cast(p);
+  } catch(std::bad_cast& e) {
+    thrown = true;
+  }
+  if(!thrown || &mets::evaluable_cast(w) != &w || &mets::mana_cast(s) != &s)
+    {
+      cerr << "Failed cast test." << endl;
+      return 1;
+    }
+
+  // a tabu search through the hot paths that used dynamic_cast
+  generator rng(1);
+  weighted working(n), best(n);
+  mets::random_shuffle(working, rng);
+  best.copy_from(working);
+  mets::best_ever_solution recorder(best);
+  mets::swap_neighborhood<generator> swaps(rng, 30);
+  mets::invert_full_neighborhood inversions(n);
+  mets::union_neighborhood<generator> moves;
+  moves.add(swaps);
+  moves.add(inversions);
+  mets::simple_tabu_list tabus(15);
+  mets::best_ever_criteria aspiration;
+  mets::noimprove_termination_criteria noimprove(200);
+  mets::threshold_termination_criteria threshold(&noimprove, 0.0);
+  mets::tabu_search<mets::union_neighborhood<generator> >
+    ts(working, recorder, moves, tabus, aspiration, threshold);
+  ts.search();
+
+  // the reversal costs sum(i * (n-1-i))
+  mets::gol_type optimum = 0.0;
+  for(int ii = 0; ii != n; ++ii)
+    optimum += ii * (n - 1 - ii);
+  if(best.cost_function() != best.compute_cost() 
+     || best.cost_function() > optimum * 1.05)
+    {
+      cerr << "Best: " << best.cost_function() << " optimum: " 
+	   << optimum << endl;
+      cerr << "Failed search test." << endl;
+      return 1;
+    }
+
+  return 0;
+}
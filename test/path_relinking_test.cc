@@ -0,0 +1,105 @@
+// path relinking regression
+#include <metslib/mets.hh>
+#include "qap.hh"
+
+using namespace std;
+
+// records the swaps applied to a solution
+struct swap_log : public mets::swap_journal
+{
+  swap_log() : swaps() { }
+  void record(int i, int j) { swaps.push_back(std::make_pair(i, j)); }
+  void invalidate() { }
+  std::vector<std::pair<int, int> > swaps;
+};
+
+int main()
+{
+  const int n = 25;
+  generator rng(5);
+  qap a(n), b(n);
+  mets::random_shuffle(a, rng);
+  mets::random_shuffle(b, rng);
+
+  // batched evaluation
+  {
+    int i[] = { 0, 3, 7, 24 };
+    int j[] = { 1, 9, 2, 11 };
+    mets::gol_type deltas[4];
+    a.evaluate_swaps(i, j, deltas, 4);
+    for(int k = 0; k != 4; ++k)
+      if(deltas[k] != a.evaluate_swap(i[k], j[k]))
+	{
+	  cerr << "Failed evaluate_swaps." << endl;
+	  return 1;
+	}
+  }
+
+  // the walk reaches the guiding solution and the result is the best
+  // intermediate solution
+  {
+    qap working(n);
+    working.copy_from(a);
+    swap_log journal;
+    working.journal(&journal);
+    mets::path_relinking relink;
+    mets::gol_type cost = relink(working, b);
+    working.journal(0);
+
+    if(relink.steps() < 2 || relink.steps() >= static_cast<size_t>(n)
+       || relink.best_step() == 0 || relink.best_step() >= relink.steps()
+       || cost != working.cost_function() || cost != working.compute_cost())
+      {
+	cerr << "Failed path relinking." << endl;
+	return 1;
+      }
+
+    qap replay(n);
+    replay.copy_from(a);
+    mets::gol_type best = std::numeric_limits<mets::gol_type>::max();
+    for(size_t ii = 0; ii != relink.steps(); ++ii)
+      {
+	replay.apply_swap(journal.swaps[ii].first, journal.swaps[ii].second);
+	if(ii + 1 < relink.steps())
+	  best = std::min(best, replay.cost_function());
+	if(ii + 1 == relink.best_step()
+	   && replay.permutation() != working.permutation())
+	  {
+	    cerr << "Failed path relinking rewind." << endl;
+	    return 1;
+	  }
+      }
+    if(replay.permutation() != b.permutation() || best != cost)
+      {
+	cerr << "Failed path relinking walk." << endl;
+	return 1;
+      }
+  }
+
+  // restarts of a tabu search from relinked elite solutions
+  {
+    typedef mets::swap_neighborhood<generator> neighborhood;
+    qap working(n);
+    working.copy_from(a);
+    std::vector<qap> slots(4, qap(n));
+    mets::elite_pool pool(3);
+    for(size_t ii = 0; ii != slots.size(); ++ii)
+      pool.add_slot(slots[ii]);
+    neighborhood moves(rng, 30);
+    mets::simple_tabu_list tabus(7);
+    mets::best_ever_criteria aspiration;
+    mets::iteration_termination_criteria termination(400);
+    mets::path_relinking_restart<generator> restart(pool, rng, 40);
+    mets::tabu_search<neighborhood> ts(working, pool, moves, tabus, 
+				       aspiration, termination, restart);
+    ts.search();
+    if(restart.restarts() == 0 || pool.size() != slots.size()
+       || pool[0].cost_function() != pool[0].compute_cost())
+      {
+	cerr << "Failed path relinking restarts." << endl;
+	return 1;
+      }
+  }
+
+  return 0;
+}
@@ -30,6 +30,25 @@ p::~p() {}
 mets::gol_type p::cost_function() const
 { return 0.0; }
 
+// position i costs i times the element it holds
+class weighted : public mets::permutation_problem
+{
+public:
+  weighted(int n) : permutation_problem(n) { update_cost(); }
+
+  mets::gol_type compute_cost() const
+  { 
+    const int n = size();
+    mets::gol_type c = 0.0;
+    for(int ii(0); ii!=n; ++ii)
+      c += ii * pi_m[ii];
+    return c;
+  }
+
+  mets::gol_type evaluate_swap(int i, int j) const
+  { return (i - j) * (pi_m[j] - pi_m[i]); }
+};
+
 int main()
 {
   // test swap_elements
@@ -112,6 +131,25 @@ int main()
       }
   }
 
+  // test invert_subsequence::evaluate (the cost after the move)
+  {
+    int from[]={2,5,0,7};
+    int to[]={5,2,8,1};
+    for(int ii(0); ii!=4; ++ii)
+      {
+	weighted pi(9);
+	mets::invert_subsequence move(from[ii],to[ii]);
+	mets::gol_type eval = move.evaluate(pi);
+	move.apply(pi);
+	if(eval != pi.compute_cost() || eval != pi.cost_function())
+	  {
+	    cerr << "Failed invert_subsequence evaluate (" << ii << ")." 
+		 << endl;
+	    return 1;
+	  }
+      }
+  }
+
   return 0;
 }
 #endif
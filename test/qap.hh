@@ -0,0 +1,49 @@
+// quadratic assignment problem shared by the regressions
+#ifndef METS_TEST_QAP_HH_
+#define METS_TEST_QAP_HH_
+
+#include <metslib/mets.hh>
+
+#if defined (METSLIB_HAVE_UNORDERED_MAP) && !defined (METSLIB_TR1_MIXED_NAMESPACE)
+typedef std::mt19937 generator;
+#else
+typedef std::tr1::mt19937 generator;
+#endif
+
+// a small random quadratic assignment problem
+class qap : public mets::permutation_problem
+{
+public:
+  qap(int n) : permutation_problem(n), a_m(n*n), b_m(n*n)
+  {
+    generator rng(n);
+    for(int ii = 0; ii != n*n; ++ii)
+      {
+	a_m[ii] = rng() % 100;
+	b_m[ii] = rng() % 100;
+      }
+  }
+
+  mets::gol_type compute_cost() const
+  {
+    const int n = size();
+    mets::gol_type c = 0.0;
+    for(int ii = 0; ii != n; ++ii)
+      for(int jj = 0; jj != n; ++jj)
+	c += a_m[ii*n+jj] * b_m[pi_m[ii]*n+pi_m[jj]];
+    return c;
+  }
+
+  mets::gol_type evaluate_swap(int i, int j) const
+  {
+    qap tmp(*this);
+    std::swap(tmp.pi_m[i], tmp.pi_m[j]);
+    return tmp.compute_cost() - cost_m;
+  }
+
+private:
+  std::vector<int> a_m;
+  std::vector<int> b_m;
+};
+
+#endif
@@ -0,0 +1,145 @@
+// real vector problem regression
+#include <metslib/mets.hh>
+
+using namespace std;
+
+#if defined (METSLIB_HAVE_UNORDERED_MAP) && !defined (METSLIB_TR1_MIXED_NAMESPACE)
+typedef std::mt19937 generator;
+#else
+typedef std::tr1::mt19937 generator;
+#endif
+
+// calibrate the n parameters of a model to a known target: the cost
+// is a weighted squared distance
+class calibration : public mets::real_vector_problem
+{
+public:
+  calibration(int n) : real_vector_problem(n), target_m(n), weight_m(n)
+  {
+    for(int ii = 0; ii != n; ++ii)
+      {
+	target_m[ii] = 0.5 * ii - 3.0;
+	weight_m[ii] = 1.0 + ii % 3;
+      }
+  }
+
+  mets::gol_type compute_cost() const
+  {
+    mets::gol_type c = 0.0;
+    for(unsigned int ii = 0; ii != x_m.size(); ++ii)
+      c += weight_m[ii] * (x_m[ii] - target_m[ii]) * (x_m[ii] - target_m[ii]);
+    return c;
+  }
+
+  mets::gol_type evaluate_step(int i, double step) const
+  {
+    double d = x_m[i] - target_m[i];
+    return weight_m[i] * (2.0 * d + step) * step;
+  }
+
+private:
+  std::vector<double> target_m;
+  std::vector<double> weight_m;
+};
+
+int main()
+{
+  const int n = 20;
+  calibration working(n);
+  working.update_cost();
+
+  if(reinterpret_cast<size_t>(&working.point()[0]) % 64 != 0)
+    {
+      cerr << "The point is not aligned." << endl;
+      return 1;
+    }
+
+  // a compass search with shrinking steps
+  calibration best(n);
+  best.copy_from(working);
+  mets::best_ever_solution recorder(best);
+  mets::coordinate_step_neighborhood compass(n, 1.0);
+  while(compass.step() > 1e-4)
+    {
+      mets::local_search<mets::coordinate_step_neighborhood>
+	ls(working, recorder, compass);
+      ls.search();
+      compass.step(compass.step() / 2);
+    }
+  if(best.cost_function() > 1e-6
+     || std::fabs(best.cost_function() - best.compute_cost()) > 1e-9)
+    {
+      cerr << "Compass search: " << best.cost_function() << " "
+	   << best.compute_cost() << endl;
+      return 1;
+    }
+
+  // a cached delta is not used once the solution has changed
+  mets::step_coordinate m(0, 1.0);
+  m.cache(working, 42.0);
+  mets::gol_type cached = m.evaluate(working) - working.cost_function();
+  working.apply_step(1, 0.5);
+  mets::gol_type fresh = m.evaluate(working) - working.cost_function();
+  if(cached != 42.0 || fresh != working.evaluate_step(0, 1.0))
+    {
+      cerr << "Failed cached delta test." << endl;
+      return 1;
+    }
+
+  // simulated annealing with gaussian steps from a far point
+  generator rng(7);
+  calibration sa_working(n), sa_best(n);
+  sa_working.update_cost();
+  sa_best.copy_from(sa_working);
+  mets::gol_type start = sa_working.cost_function();
+  mets::best_ever_solution sa_recorder(sa_best);
+  mets::gaussian_step_neighborhood<generator> gauss(rng, 10, 0.3);
+  mets::noimprove_termination_criteria noimprove(2000);
+  mets::exponential_cooling cooling(0.999);
+  mets::simulated_annealing<mets::gaussian_step_neighborhood<generator> >
+    sa(sa_working, sa_recorder, gauss, noimprove, cooling, 10.0, 1e-6);
+  sa.search();
+  if(sa_best.cost_function() > start / 100
+     || std::fabs(sa_best.cost_function() - sa_best.compute_cost()) > 1e-6)
+    {
+      cerr << "Simulated annealing: " << start << " -> "
+	   << sa_best.cost_function() << " " << sa_best.compute_cost() << endl;
+      return 1;
+    }
+
+  // equal steps hash the same, whatever their sign and size
+  {
+    const double steps[] = { 1.0, -1.0, -1e-9, 1e300, -1e300, 0.0 };
+    for(int ii = 0; ii != 6; ++ii)
+      {
+	mets::step_coordinate a(3, steps[ii]), b(3, steps[ii]);
+	if(!(a == b) || a.hash() != b.hash())
+	  {
+	    cerr << "Failed hash test for " << steps[ii] << endl;
+	    return 1;
+	  }
+      }
+    mets::step_coordinate zero(3, 0.0), negative_zero(3, -0.0);
+    if(!(zero == negative_zero) || zero.hash() != negative_zero.hash()
+       || mets::step_coordinate(3, 1.0).hash() 
+       == mets::step_coordinate(3, -1.0).hash())
+      {
+	cerr << "Failed signed hash test." << endl;
+	return 1;
+      }
+  }
+
+  // checkpoint roundtrip
+  std::stringstream ss;
+  sa_best.save(ss);
+  calibration restored(n);
+  restored.load(ss);
+  if(restored.point() != sa_best.point()
+     || restored.cost_function() != sa_best.cost_function())
+    {
+      cerr << "Failed save/load test." << endl;
+      return 1;
+    }
+
+  return 0;
+}
@@ -0,0 +1,128 @@
+// solution recorders regression
+#include <metslib/mets.hh>
+
+using namespace std;
+
+#if defined (METSLIB_HAVE_UNORDERED_MAP) && !defined (METSLIB_TR1_MIXED_NAMESPACE)
+typedef std::mt19937 generator;
+#else
+typedef std::tr1::mt19937 generator;
+#endif
+
+// a linear assignment problem with random weights
+class lap : public mets::permutation_problem
+{
+public:
+  lap(int n) : permutation_problem(n), w_m(n)
+  { 
+    generator rng(n);
+    for(int ii = 0; ii != n; ++ii)
+      w_m[ii] = static_cast<int>(rng() % 1000) - 500;
+  }
+
+  mets::gol_type compute_cost() const  
+  { 
+    mets::gol_type c = 0.0;
+    for(unsigned int ii = 0; ii != pi_m.size(); ++ii)
+      c += w_m[ii] * pi_m[ii];
+    return c;
+  }
+
+  mets::gol_type evaluate_swap(int i, int j) const 
+  { return (w_m[i] - w_m[j]) * (pi_m[j] - pi_m[i]); }
+
+private:
+  std::vector<int> w_m;
+};
+
+// run a tabu search (with diversification) using recorder
+mets::gol_type
+search(lap& working, mets::solution_recorder& recorder)
+{
+  typedef mets::swap_neighborhood<generator> neighborhood;
+  generator rng(3);
+  neighborhood moves(rng, 20);
+  mets::simple_tabu_list tabus(15);
+  mets::best_ever_criteria aspiration;
+  mets::iteration_termination_criteria termination(2000);
+  mets::frequency_memory memory(working.size(), 10.0, 50);
+  mets::tabu_search<neighborhood> ts(working, recorder, moves, tabus, 
+				     aspiration, termination, memory);
+  ts.search();
+  return memory.restarts();
+}
+
+int main()
+{
+  const int n = 300;
+  generator rng(1);
+  lap start(n);
+  mets::random_shuffle(start, rng);
+
+  lap working(n), best(n);
+  working.copy_from(start);
+  best.copy_from(start);
+  mets::best_ever_solution reference(best);
+  if(search(working, reference) == 0)
+    {
+      cerr << "No diversification, test is not meaningful." << endl;
+      return 1;
+    }
+
+  // the lazy recorder must record the same solution
+  const size_t logs[] = { 0, 3 };
+  for(unsigned int ii = 0; ii != sizeof(logs)/sizeof(logs[0]); ++ii)
+    {
+      lap lazy_working(n), lazy_best(n);
+      lazy_working.copy_from(start);
+      mets::lazy_best_solution lazy(lazy_working, lazy_best, logs[ii]);
+      search(lazy_working, lazy);
+      if(lazy.best_cost() != reference.best_cost()
+	 || lazy.best_seen().permutation() != best.permutation()
+	 || lazy.best_seen().cost_function() != best.cost_function())
+	{
+	  cerr << "Failed lazy_best_solution (" << logs[ii] << ")." << endl;
+	  return 1;
+	}
+      if(logs[ii] == 0 && lazy.copies() > 10)
+	{
+	  cerr << "Too many copies: " << lazy.copies() << endl;
+	  return 1;
+	}
+    }
+
+  // the elite pool keeps the best distinct solutions, best first
+  {
+    const size_t k = 6;
+    std::vector<lap> slots(k, lap(n));
+    mets::elite_pool pool(n / 10);
+    for(size_t ii = 0; ii != k; ++ii)
+      pool.add_slot(slots[ii]);
+    lap pool_working(n);
+    pool_working.copy_from(start);
+    search(pool_working, pool);
+    if(pool.size() != k || pool.best_cost() != reference.best_cost()
+       || pool[0].permutation() != best.permutation())
+      {
+	cerr << "Failed elite_pool best." << endl;
+	return 1;
+      }
+    for(size_t ii = 0; ii != k; ++ii)
+      {
+	if(pool[ii].cost_function() != pool[ii].compute_cost()
+	   || (ii && pool[ii-1].cost_function() > pool[ii].cost_function()))
+	  {
+	    cerr << "Failed elite_pool order." << endl;
+	    return 1;
+	  }
+	for(size_t jj = 0; jj != ii; ++jj)
+	  if(mets::hamming_distance(pool[ii], pool[jj]) == 0)
+	    {
+	      cerr << "Failed elite_pool duplicates." << endl;
+	      return 1;
+	    }
+      }
+  }
+
+  return 0;
+}
@@ -0,0 +1,112 @@
+// solution tabu list and fingerprint regression
+#include <metslib/mets.hh>
+
+using namespace std;
+
+class q : public mets::permutation_problem
+{
+public:
+  q(int n) : permutation_problem(n) 
+  { }
+
+  mets::gol_type compute_cost() const  
+  { 
+    mets::gol_type c = 0.0;
+    for(unsigned int ii = 0; ii != pi_m.size(); ++ii)
+      c += ii * pi_m[ii];
+    return c;
+  }
+
+  mets::gol_type evaluate_swap(int i, int j) const 
+  { return (i - j) * (pi_m[j] - pi_m[i]); }
+
+  friend int main();
+};
+
+int main()
+{
+#if defined (METSLIB_HAVE_UNORDERED_MAP) && !defined (METSLIB_TR1_MIXED_NAMESPACE)
+  std::mt19937 rng;
+#else
+  std::tr1::mt19937 rng;
+#endif
+
+  // test incremental fingerprint against full recomputation
+  {
+    const int n = 30;
+    mets::zobrist_table table(n, rng);
+    q a(n);
+    a.use_fingerprint(table);
+    mets::random_shuffle(a, rng);
+    size_t start = a.fingerprint();
+    for(int ii = 0; ii != 1000; ++ii)
+      {
+	mets::perturbate(a, 1, rng);
+	size_t incremental = a.fingerprint();
+	a.update_cost();
+	if(a.fingerprint() != incremental)
+	  {
+	    cerr << "Failed incremental fingerprint." << endl;
+	    return 1;
+	  }
+      }
+    mets::invert_subsequence inv(3, 17);
+    size_t predicted = inv.fingerprint(a);
+    inv.apply(a);
+    if(predicted != a.fingerprint() || start == a.fingerprint())
+      {
+	cerr << "Failed invert_subsequence fingerprint." << endl;
+	return 1;
+      }
+  }
+
+  // test visited set eviction with duplicated fingerprints
+  {
+    mets::visited_set vs(3);
+    vs.insert(1); vs.insert(2); vs.insert(2); vs.insert(3);
+    if(vs.contains(1) || !vs.contains(2) || !vs.contains(3))
+      {
+	cerr << "Failed visited_set (1)." << endl;
+	return 1;
+      }
+    for(size_t ii = 4; ii != 10000; ++ii)
+      {
+	vs.insert(ii * 1031);
+	if(!vs.contains(ii * 1031) || vs.contains((ii - 3) * 1031) 
+	   || vs.size() != 3)
+	  {
+	    cerr << "Failed visited_set (2) at " << ii << endl;
+	    return 1;
+	  }
+      }
+  }
+
+  // test that going back to a visited solution is tabu
+  {
+    const int n = 10;
+    mets::zobrist_table table(n, rng);
+    q a(n);
+    a.use_fingerprint(table);
+    mets::solution_tabu_list tl(2);
+    mets::swap_elements m01(0, 1), m12(1, 2), m02(0, 2);
+
+    tl.tabu(a, m01); m01.apply(a);
+    if(!tl.is_tabu(a, m01) || tl.is_tabu(a, m12))
+      {
+	cerr << "Failed solution_tabu_list (1)." << endl;
+	return 1;
+      }
+    tl.tabu(a, m12); m12.apply(a);
+    tl.tabu(a, m02); m02.apply(a);
+    // m12 leads back to the starting solution that is now out of
+    // the tenure window, m02 leads back to the previous one
+    if(tl.is_tabu(a, m02) == false || tl.is_tabu(a, m12))
+      {
+	cerr << "Failed solution_tabu_list (2)." << endl;
+	return 1;
+      }
+  }
+
+  cerr << "Success!" << endl;
+  return 0;
+}
@@ -12,6 +12,21 @@ class my_sol : public mets::evaluable_solution
   { }
 };
 
+// a user swap with its own opposite_of() (but no opposite_into())
+class counted_swap : public mets::swap_elements
+{
+public:
+  counted_swap(int from, int to, int& calls) 
+    : swap_elements(from, to), calls_m(calls) 
+  { }
+
+  mets::mana_move* opposite_of() const
+  { ++calls_m; return new counted_swap(first(), second(), calls_m); }
+
+private:
+  int& calls_m;
+};
+
 class my_move : public mets::mana_move 
 {
   int i_m;
@@ -105,6 +120,103 @@ int main(void)
       }
   }
 
+  // without a pool the list always asks the move for its opposite
+  {
+    my_sol s;
+    int calls = 0;
+    mets::simple_tabu_list tl(2);
+    if(tl.pool())
+      {
+	cerr << "Failed default pool test." << endl;
+	return 1;
+      }
+    for(int ii = 0; ii != 10; ++ii)
+      {
+	counted_swap m(ii, ii + 1, calls);
+	tl.tabu(s, m);
+      }
+    if(calls != 10)
+      {
+	cerr << "Failed opposite_of override test." << endl;
+	return 1;
+      }
+  }
+
+  // the pool recycles the moves that leave the list
+  {
+    mets::move_pool pool;
+    mets::swap_elements s1(1, 2);
+    mets::mana_move* a = pool.opposite(s1);
+    pool.release(a);
+    mets::swap_elements s2(3, 4);
+    mets::mana_move* b = pool.opposite(s2);
+    mets::invert_subsequence inv(3, 4);
+    mets::mana_move* c = pool.opposite(inv);
+    if(a != b || !(*b == s2) || pool.size() != 0 || c == b || !(*c == inv))
+      {
+	cerr << "Failed move pool test." << endl;
+	return 1;
+      }
+    pool.release(b);
+    pool.release(c);
+
+    // at steady state the list only reuses moves
+    my_sol s;
+    mets::simple_tabu_list tl(5);
+    tl.pool(pool);
+    for(int ii = 0; ii != 100; ++ii)
+      {
+	mets::swap_elements m(ii % 11, ii % 11 + 1);
+	tl.tabu(s, m);
+	if(!tl.is_tabu(s, m) || pool.size() > 2)
+	  {
+	    cerr << "Failed pooled tabu list test at " << ii << endl;
+	    return 1;
+	  }
+      }
+    mets::swap_elements old(94 % 11, 94 % 11 + 1);
+    mets::swap_elements recent(95 % 11, 95 % 11 + 1);
+    if(tl.is_tabu(s, old) || !tl.is_tabu(s, recent))
+      {
+	cerr << "Failed pooled tenure test." << endl;
+	return 1;
+      }
+  }
+
+  // recurring moves do not grow the list, the tenure can change
+  {
+    my_sol s;
+    mets::simple_tabu_list tl(4);
+    my_move a(0);
+    for(int ii = 0; ii != 1000; ++ii)
+      {
+	tl.tabu(s, a);
+	my_move m(1 + ii % 3);
+	tl.tabu(s, m);
+	if(tl.size() > 4)
+	  {
+	    cerr << "Failed bounded size test." << endl;
+	    return 1;
+	  }
+      }
+    // from the oldest: 2, 3, 0, 1 (999 % 3 + 1 == 1)
+    tl.tenure(2);
+    my_move m0(0), m1(1), m2(2), m3(3);
+    if(tl.size() != 2 || tl.tenure() != 2 || !tl.is_tabu(s, m0) 
+       || !tl.is_tabu(s, m1) || tl.is_tabu(s, m2) || tl.is_tabu(s, m3))
+      {
+	cerr << "Failed tenure change test." << endl;
+	return 1;
+      }
+    tl.tenure(0);
+    tl.tabu(s, m2);
+    if(tl.size() != 0 || tl.is_tabu(s, m2) || tl.is_tabu(s, m0))
+      {
+	cerr << "Failed empty tenure test." << endl;
+	return 1;
+      }
+  }
+
   cerr << "Success!" << endl;
   return 0;
 }
@@ -0,0 +1,94 @@
+// tabu search regression
+#include <metslib/mets.hh>
+
+using namespace std;
+
+// the number of bits set
+class ones : public mets::bitvector_problem
+{
+public:
+  ones(int n) : bitvector_problem(n) {}
+  mets::gol_type compute_cost() const { return count(); }
+  mets::gol_type evaluate_flip(int i) const { return bit(i) ? -1.0 : 1.0; }
+};
+
+// counts the forced tabu moves
+class forced_counter
+  : public mets::search_listener<mets::flip_full_neighborhood>
+{
+public:
+  forced_counter() : search_listener<mets::flip_full_neighborhood>(), 
+		     forced(0) {}
+  void update(search_type* search)
+  {
+    if(search->step() 
+       == mets::tabu_search<mets::flip_full_neighborhood>::TABU_MOVE_FORCED)
+      ++forced;
+  }
+  int forced;
+};
+
+int main()
+{
+  const int n = 3;
+  typedef mets::tabu_search<mets::flip_full_neighborhood> search_type;
+
+  // after clearing all the bits every move is tabu and worsening
+  for(int mode = 0; mode != 3; ++mode)
+    {
+      ones working(n), best(n);
+      for(int ii = 0; ii != n; ++ii)
+	working.apply_flip(ii);
+      working.update_cost();
+      best.copy_from(working);
+      mets::best_ever_solution recorder(best);
+      mets::flip_full_neighborhood moves(n);
+      mets::flip_tabu_list tabus(n, 10);
+      mets::best_ever_criteria aspiration;
+      mets::iteration_termination_criteria termination(20);
+      search_type ts(working, recorder, moves, tabus, aspiration, termination);
+      forced_counter counter;
+      ts.attach(counter);
+
+      if(mode == 0)
+	{
+	  // status returned, the best solution is kept
+	  if(ts.run() != mets::SEARCH_NO_MOVES || best.cost_function() != 0
+	     || working.cost_function() != 0 || counter.forced != 0)
+	    {
+	      cerr << "Failed no moves status test." << endl;
+	      return 1;
+	    }
+	}
+      else if(mode == 1)
+	{
+	  // the old interface still throws
+	  bool thrown = false;
+	  try {
+	    ts.search();
+	  } catch(mets::no_moves_error& e) {
+	    thrown = true;
+	  }
+	  if(!thrown)
+	    {
+	      cerr << "Failed no moves exception test." << endl;
+	      return 1;
+	    }
+	}
+      else
+	{
+	  // the best tabu move is made until termination
+	  ts.fallback_to_tabu_moves(true);
+	  if(ts.run() != mets::SEARCH_TERMINATED || best.cost_function() != 0
+	     || counter.forced == 0 || counter.forced > 20 - n
+	     || working.cost_function() != working.compute_cost())
+	    {
+	      cerr << "Forced moves: " << counter.forced << endl;
+	      cerr << "Failed fallback test." << endl;
+	      return 1;
+	    }
+	}
+    }
+
+  return 0;
+}
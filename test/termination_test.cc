@@ -12,6 +12,38 @@ class zero_sol : public mets::evaluable_solution
   { }
 };
 
+// a time criterion reading a clock set by hand
+class fake_clock_criteria : public mets::time_termination_criteria
+{
+public:
+  fake_clock_criteria(double budget, double interval)
+    : time_termination_criteria(budget, interval), time(1000.0), reads(0)
+  { }
+
+  double time;
+  mutable int reads;
+
+protected:
+  double now() const
+  { ++reads; return time; }
+};
+
+// advance the clock by lapse and call the criterion until it reads
+// the clock once: false if it reads it before stride() calls, if the
+// stride is not then updated to expected, or if the answer is not
+// expired on the reading (and false before)
+bool read_once(fake_clock_criteria& t, const mets::feasible_solution& s,
+	       double lapse, unsigned int expected, bool expired)
+{
+  const unsigned int stride = t.stride();
+  const int reads = t.reads;
+  t.time += lapse;
+  for(unsigned int ii = 1; ii != stride; ++ii)
+    if(t(s) || t.reads != reads)
+      return false;
+  return t(s) == expired && t.reads == reads + 1 && t.stride() == expected;
+}
+
 int main(void)
 {
   zero_sol s;
@@ -39,6 +71,97 @@ int main(void)
       return -1;
     }
 
+  // stride calibration and deadline, on a fake clock: the stride
+  // doubles while the clock is read more often than every interval/2,
+  // halves while it is read less often than every 2*interval, and
+  // the deadline fires on the first reading past the budget
+  {
+    fake_clock_criteria t(100.0, 1.0);
+    if(t(s) || t.reads != 1 || t.stride() != 1)
+      {
+	cerr << "Failed fake clock start." << endl;
+	return -1;
+      }
+    unsigned int expected = 1;
+    for(int ii = 0; ii != 5; ++ii)
+      if(!read_once(t, s, 0.25, expected *= 2, false))
+	{
+	  cerr << "Stride not doubled: " << t.stride() << endl;
+	  return -1;
+	}
+    for(int ii = 0; ii != 4; ++ii)
+      if(!read_once(t, s, 4.0, expected /= 2, false))
+	{
+	  cerr << "Stride not halved: " << t.stride() << endl;
+	  return -1;
+	}
+    if(!read_once(t, s, 1.0, 2, false))
+      {
+	cerr << "Stride changed on time: " << t.stride() << endl;
+	return -1;
+      }
+    // the next reading is exactly on the budget (and slow)
+    if(!read_once(t, s, 100.0 - t.elapsed(), 1, true) 
+       || !t(s) || t.reads != 12)
+      {
+	cerr << "Failed fake clock deadline." << endl;
+	return -1;
+      }
+  }
+
+  // time budgets on the real clocks: the deadline is respected (the
+  // upper bound is generous, a loaded host may preempt the loop for
+  // a while)
+  double budget = 0.2;
+  double slack = 5.0;
+  mets::wallclock_termination_criteria hours(budget);
+  double start = mets::wall_time();
+  count = 0;
+  while(!hours(s)) count++;
+  double elapsed = mets::wall_time() - start;
+  if(elapsed < budget || elapsed > budget + slack || !hours(s))
+    {
+      cerr << "Elapsed: " << elapsed << " calls: " << count 
+	   << " stride: " << hours.stride() << endl;
+      cerr << "Failed wall clock test." << endl;
+      return -1;
+    }
+
+  mets::cputime_termination_criteria minutes(budget);
+  start = mets::cpu_time();
+  while(!minutes(s)) ;
+  elapsed = mets::cpu_time() - start;
+  if(elapsed < budget || elapsed > budget + slack)
+    {
+      cerr << "Elapsed: " << elapsed << endl;
+      cerr << "Failed cpu time test." << endl;
+      return -1;
+    }
+
+  // cancellation
+  mets::cancellation_token token;
+  mets::iteration_termination_criteria centuries(10);
+  mets::cancellation_termination_criteria stop(&centuries, token);
+  if(stop(s) || token.cancelled())
+    {
+      cerr << "Failed cancellation test (not cancelled)." << endl;
+      return -1;
+    }
+  token.cancel();
+  if(!stop(s) || !token.cancelled())
+    {
+      cerr << "Failed cancellation test (cancelled)." << endl;
+      return -1;
+    }
+  token.reset();
+  count = 1;
+  while(!stop(s)) count++;
+  if(count != 10)
+    {
+      cerr << "Failed cancellation test (chain)." << endl;
+      return -1;
+    }
+
   cerr << "Success!" << endl;
   return 0;
 }
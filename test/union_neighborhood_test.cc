@@ -0,0 +1,129 @@
+// union neighborhood regression
+#include <metslib/mets.hh>
+
+using namespace std;
+
+#if defined (METSLIB_HAVE_UNORDERED_MAP) && !defined (METSLIB_TR1_MIXED_NAMESPACE)
+typedef std::mt19937 generator;
+#else
+typedef std::tr1::mt19937 generator;
+#endif
+
+// every permutation costs the same
+class flat : public mets::permutation_problem
+{
+public:
+  flat(int n) : permutation_problem(n) {}
+  mets::gol_type compute_cost() const { return 0.0; }
+  mets::gol_type evaluate_swap(int, int) const { return 0.0; }
+};
+
+// a neighborhood without moves
+class no_moves : public mets::move_manager
+{
+public:
+  no_moves() : move_manager() {}
+  void refresh(const mets::feasible_solution&) {}
+};
+
+typedef mets::union_neighborhood<generator> union_type;
+
+// the moves of the union, in iteration order
+static std::vector<const mets::move*>
+walk(union_type& moves)
+{
+  std::vector<const mets::move*> seen;
+  for(union_type::iterator it = moves.begin(); it != moves.end(); it++)
+    seen.push_back(*it);
+  return seen;
+}
+
+// the moves of child, in iteration order
+static std::vector<const mets::move*>
+walk(mets::move_manager& child)
+{
+  return std::vector<const mets::move*>(child.begin(), child.end());
+}
+
+int main()
+{
+  flat working(5);
+
+  // nothing to explore
+  {
+    union_type moves;
+    moves.refresh(working);
+    no_moves none1, none2;
+    union_type empties;
+    empties.add(none1);
+    empties.add(none2);
+    empties.refresh(working);
+    if(moves.size() != 0 || moves.begin() != moves.end()
+       || empties.size() != 0 || empties.begin() != empties.end())
+      {
+	cerr << "Failed empty union test." << endl;
+	return 1;
+      }
+  }
+
+  // the moves of each child in sequence, the empty ones skipped
+  {
+    no_moves none1, none2, none3;
+    mets::swap_full_neighborhood swaps(5);
+    mets::invert_full_neighborhood inversions(4);
+    union_type moves;
+    moves.add(none1);
+    moves.add(swaps);
+    moves.add(none2);
+    moves.add(inversions);
+    moves.add(none3);
+    moves.refresh(working);
+
+    std::vector<const mets::move*> expected = walk(swaps);
+    std::vector<const mets::move*> more = walk(inversions);
+    expected.insert(expected.end(), more.begin(), more.end());
+    if(moves.size() != 10 + 12 || walk(moves) != expected)
+      {
+	cerr << "Failed iteration order test." << endl;
+	return 1;
+      }
+  }
+
+  // a sampled child contributes a window of consecutive moves, that
+  // can wrap around its end
+  {
+    generator rng(1);
+    mets::swap_full_neighborhood swaps(5);
+    mets::invert_full_neighborhood inversions(4);
+    union_type moves(rng);
+    moves.add(swaps, 0.25);
+    moves.add(inversions);
+    const std::vector<const mets::move*> all = walk(swaps);
+    for(int trial = 0; trial != 20; ++trial)
+      {
+	moves.refresh(working);
+	std::vector<const mets::move*> seen = walk(moves);
+	if(moves.size() != 3 + 12 || seen.size() != 3 + 12)
+	  {
+	    cerr << "Wrong sampled size." << endl;
+	    return 1;
+	  }
+	size_t start = std::find(all.begin(), all.end(), seen[0])
+	  - all.begin();
+	for(size_t k = 0; k != 3; ++k)
+	  if(start == all.size() || seen[k] != all[(start + k) % all.size()])
+	    {
+	      cerr << "Wrong sampled window." << endl;
+	      return 1;
+	    }
+	if(std::vector<const mets::move*>(seen.begin() + 3, seen.end())
+	   != walk(inversions))
+	  {
+	    cerr << "Wrong moves after the sampled window." << endl;
+	    return 1;
+	  }
+      }
+  }
+
+  return 0;
+}
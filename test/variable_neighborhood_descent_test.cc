@@ -0,0 +1,143 @@
+// variable neighborhood descent regression
+#include <metslib/mets.hh>
+#include "lap.hh"
+
+using namespace std;
+
+// a neighborhood without moves
+class no_moves : public mets::move_manager
+{
+public:
+  no_moves() : move_manager() {}
+  void refresh(const mets::feasible_solution&) {}
+};
+
+typedef mets::variable_neighborhood_descent<> vnd_type;
+
+// records the cost and the neighborhood of each move
+class move_recorder : public mets::search_listener<mets::move_manager>
+{
+public:
+  move_recorder() : search_listener<mets::move_manager>(), costs(),
+		    neighborhoods() {}
+  void update(search_type* search)
+  {
+    if(search->step() == search_type::MOVE_MADE)
+      {
+	costs.push_back(static_cast<const mets::evaluable_solution&>
+			(search->working()).cost_function());
+	neighborhoods.push_back(static_cast<vnd_type*>(search)
+				->current_neighborhood());
+      }
+  }
+  std::vector<mets::gol_type> costs;
+  std::vector<unsigned int> neighborhoods;
+};
+
+// true if no move of moves improves working
+static bool
+local_optimum(mets::move_manager& moves, lap& working)
+{
+  moves.refresh(working);
+  for(mets::move_manager::iterator it = moves.begin(); it != moves.end(); ++it)
+    if((*it)->evaluate(working) < working.cost_function() - 1e-7)
+      return false;
+  return true;
+}
+
+int main()
+{
+  const int n = 12;
+
+  // a local optimum of every neighborhood, reached by improving moves
+  for(int short_circuit = 0; short_circuit != 2; ++short_circuit)
+    {
+      generator rng(1);
+      lap working(n), best(n);
+      mets::random_shuffle(working, rng);
+      mets::gol_type start = working.cost_function();
+      best.copy_from(working);
+      mets::best_ever_solution recorder(best);
+      mets::swap_full_neighborhood swaps(n);
+      mets::invert_full_neighborhood inversions(n);
+      vnd_type vnd(working, recorder, swaps, 1e-7, short_circuit != 0);
+      vnd.add(inversions);
+      move_recorder moves;
+      vnd.attach(moves);
+      vnd.search();
+
+      bool ok = vnd.neighborhoods() == 2
+	&& vnd.current_neighborhood() == 2
+	&& !moves.costs.empty() && moves.costs[0] < start
+	&& local_optimum(swaps, working)
+	&& local_optimum(inversions, working)
+	&& working.cost_function() == working.compute_cost()
+	&& best.cost_function() == working.cost_function();
+      for(size_t k = 1; k < moves.costs.size(); ++k)
+	ok = ok && moves.costs[k] < moves.costs[k-1];
+      if(!ok)
+	{
+	  cerr << "Failed descent test " << short_circuit << endl;
+	  return 1;
+	}
+    }
+
+  // with one neighborhood it is a best improvement local search
+  {
+    generator rng(2);
+    lap start(n);
+    mets::random_shuffle(start, rng);
+
+    lap working1(n), best1(n);
+    working1.copy_from(start);
+    best1.copy_from(start);
+    mets::best_ever_solution recorder1(best1);
+    mets::swap_full_neighborhood swaps1(n);
+    mets::local_search<mets::swap_full_neighborhood>
+      ls(working1, recorder1, swaps1);
+    ls.search();
+
+    lap working2(n), best2(n);
+    working2.copy_from(start);
+    best2.copy_from(start);
+    mets::best_ever_solution recorder2(best2);
+    mets::swap_full_neighborhood swaps2(n);
+    vnd_type vnd(working2, recorder2, swaps2);
+    vnd.search();
+
+    if(working1.permutation() != working2.permutation()
+       || best1.cost_function() != best2.cost_function())
+      {
+	cerr << "Failed single neighborhood test." << endl;
+	return 1;
+      }
+  }
+
+  // an empty neighborhood hands over to the next one, and each move
+  // sends the search back to the first
+  {
+    generator rng(3);
+    lap working(n), best(n);
+    mets::random_shuffle(working, rng);
+    best.copy_from(working);
+    mets::best_ever_solution recorder(best);
+    no_moves none;
+    mets::swap_full_neighborhood swaps(n);
+    vnd_type vnd(working, recorder, none);
+    vnd.add(swaps);
+    move_recorder moves;
+    vnd.attach(moves);
+    vnd.search();
+
+    bool ok = !moves.neighborhoods.empty() && local_optimum(swaps, working);
+    for(size_t k = 0; k != moves.neighborhoods.size(); ++k)
+      ok = ok && moves.neighborhoods[k] == 1;
+    if(!ok)
+      {
+	cerr << "Failed empty neighborhood test." << endl;
+	return 1;
+      }
+  }
+
+  return 0;
+}